@@ -0,0 +1,97 @@
+/// @file binary_cache.cpp Source file for the binary image of the loaded database.
+#include "binary_cache.h"
+#include <stdexcept>
+
+// =====================================================================
+// Hash
+// =====================================================================
+
+uint64_t cache::hash(const char* data, size_t size){
+    // FNV-1a applied to whole words instead of single bytes, so it keeps up with reading the file.
+    constexpr uint64_t prime = 0x100000001b3;
+    uint64_t hash = 0xcbf29ce484222325 ^ size;
+    size_t i = 0;
+    for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)){
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(uint64_t));
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    for(; i < size; ++i)
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    return hash;
+}
+
+// =====================================================================
+// BinaryReader
+// =====================================================================
+
+BinaryReader::BinaryReader(const char* begin, const char* end) : end_(end), pos_(begin){}
+
+bool BinaryReader::atEnd() const{
+    return pos_ == end_;
+}
+
+void BinaryReader::read(std::string& value){
+    size_t size = read<size_t>();
+    value.assign(take(size), size);
+}
+
+void BinaryReader::read(Symbol& value){
+    size_t size = read<size_t>();
+    value = Symbol(std::string(take(size), size));
+}
+
+void BinaryReader::read(std::vector<size_t>& values){
+    size_t size = read<size_t>();
+    const char* data = take(size * sizeof(size_t));
+    values.resize(size);
+    std::memcpy(values.data(), data, size * sizeof(size_t));
+}
+
+BinaryReader BinaryReader::section(){
+    size_t size = read<size_t>();
+    const char* begin = take(size);
+    return BinaryReader(begin, begin + size);
+}
+
+const char* BinaryReader::take(size_t size){
+    if(size > static_cast<size_t>(end_ - pos_))
+        throw std::runtime_error("Binary image is truncated.");
+    const char* begin = pos_;
+    pos_ += size;
+    return begin;
+}
+
+// =====================================================================
+// BinaryWriter
+// =====================================================================
+
+size_t BinaryWriter::beginSection(){
+    size_t position = data_.size();
+    write<size_t>(0);
+    return position;
+}
+
+const std::string& BinaryWriter::data() const{
+    return data_;
+}
+
+void BinaryWriter::endSection(size_t position){
+    size_t size = data_.size() - position - sizeof(size_t);
+    std::memcpy(data_.data() + position, &size, sizeof(size_t));
+}
+
+void BinaryWriter::write(const std::string& value){
+    write(value.size());
+    data_.append(value);
+}
+
+void BinaryWriter::write(const Symbol& value){
+    write(value.str());
+}
+
+void BinaryWriter::write(const std::vector<size_t>& values){
+    write(values.size());
+    data_.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(size_t));
+}
@@ -0,0 +1,95 @@
+/// @file binary_cache.h Header file for the binary image of the loaded database.
+#ifndef binary_cache_h_
+#define binary_cache_h_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "symbol.h"
+
+/// Namespace for constants of the binary image.
+namespace cache{
+    /// Version of the image format. Images of other versions are ignored.
+    constexpr uint32_t VERSION = 1;
+    /// Hash of the content used to detect changed files. It is fast, but not cryptographic.
+    /// @param data Pointer to the content.
+    /// @param size Size of the content in bytes.
+    /// @return 64-bit hash of the content.
+    uint64_t hash(const char* data, size_t size);
+}
+
+/// Reader of values written by BinaryWriter. Reading past the end throws std::runtime_error.
+class BinaryReader{
+    public:
+        /// Constructor.
+        /// @param begin Pointer to the first byte of the data. The data must outlive the reader.
+        /// @param end Pointer past the last byte of the data.
+        BinaryReader(const char* begin, const char* end);
+        /// If all the data were read.
+        /// @return True if there is nothing more to read.
+        bool atEnd() const;
+        /// Read a value of trivially copyable type.
+        /// @return Read value.
+        template<typename T>
+        T read(){
+            T value;
+            std::memcpy(&value, take(sizeof(T)), sizeof(T));
+            return value;
+        }
+        /// Read a string.
+        /// @param value Where the string is stored.
+        void read(std::string& value);
+        /// Read a string and intern it.
+        /// @param value Where the symbol is stored.
+        void read(Symbol& value);
+        /// Read a vector of ids.
+        /// @param values Where the ids are stored.
+        void read(std::vector<size_t>& values);
+        /// Read a section written between BinaryWriter::beginSection and BinaryWriter::endSection.
+        /// @return Reader of the section only.
+        BinaryReader section();
+    private:
+        /// Pointer past the last byte of the data.
+        const char* end_;
+        /// Pointer to the next unread byte.
+        const char* pos_;
+        /// Skip given number of bytes.
+        /// @param size Number of bytes.
+        /// @return Pointer to the first skipped byte.
+        const char* take(size_t size);
+};
+
+/// Writer of values to a binary buffer in the native byte order. Image is only read on the same machine, so it does not need to be portable.
+class BinaryWriter{
+    public:
+        /// Start a section, which can be read independently of the rest of the data.
+        /// @return Position of the section, which has to be passed to endSection.
+        size_t beginSection();
+        /// Get the written data.
+        /// @return Constant reference to the buffer.
+        const std::string& data() const;
+        /// Finish the section by writing its size to its beginning.
+        /// @param position Position returned by beginSection.
+        void endSection(size_t position);
+        /// Write a value of trivially copyable type.
+        /// @param value Written value.
+        template<typename T>
+        void write(T value){
+            data_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+        /// Write a string.
+        /// @param value Written string.
+        void write(const std::string& value);
+        /// Write the text of a symbol.
+        /// @param value Written symbol.
+        void write(const Symbol& value);
+        /// Write a vector of ids.
+        /// @param values Written ids.
+        void write(const std::vector<size_t>& values);
+    private:
+        /// Written data.
+        std::string data_;
+};
+
+#endif
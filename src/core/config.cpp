@@ -93,9 +93,9 @@ std::string EventTemplate::str() const{
 // =====================================================================
 
 std::ostream& operator <<(std::ostream& os, const EventTemplate& et){
-	os << "{\"" << jsonlabel::TITLE << "\":\"" << et.getTitle() << "\"";
+	os << "{\"" << jsonlabel::TITLE << "\":" << JsonString(et.getTitle());
 	os << ",\"" << jsonlabel::ID << "\":" << et.getId();
-	os << ",\""<< jsonlabel::DESCRIPTION << "\":\"" << et.getDescription() << "\"";
+	os << ",\""<< jsonlabel::DESCRIPTION << "\":" << JsonString(et.getDescription());
 	os << ", \"" << jsonlabel::CONTAINS_DATE << "\":" << et.containsDate();
 	os << ", \"" << jsonlabel::CONTAINS_PLACE << "\":" << et.containsPlace();
 	os << ", \"" << jsonlabel::MORE_PEOPLE << "\":" << et.hasMorePeopleInvolved();
@@ -106,7 +106,7 @@ std::ostream& operator <<(std::ostream& os, const EventTemplate& et){
 			if(!first){
 				os << ",";
 			}
-			os << "{\"" << jsonlabel::NAME << "\":\"" << str << "\"}";
+			os << "{\"" << jsonlabel::NAME << "\":" << JsonString(str) << "}";
 			first = false;
 		}
 		os << "]";
@@ -218,11 +218,11 @@ std::string RelationTemplate::str() const{
 // =====================================================================
 
 std::ostream& operator <<(std::ostream& os, const RelationTemplate& rt){
-	os << "{\"" << jsonlabel::TITLE << "\":\"" << rt.getTitle() << "\"";
+	os << "{\"" << jsonlabel::TITLE << "\":" << JsonString(rt.getTitle());
 	os << ",\"" << jsonlabel::ID << "\":" << rt.getId();
-	os << ",\"" << jsonlabel::DESCRIPTION << "\":\"" << rt.getDescription() << "\"";
-	os << ", \"" << jsonlabel::FIRST_NAME << "\":\"" << rt.getFirstName() << "\"";
-	os << ", \"" << jsonlabel::SECOND_NAME << "\":\"" << rt.getSecondName() << "\"";
+	os << ",\"" << jsonlabel::DESCRIPTION << "\":" << JsonString(rt.getDescription());
+	os << ", \"" << jsonlabel::FIRST_NAME << "\":" << JsonString(rt.getFirstName());
+	os << ", \"" << jsonlabel::SECOND_NAME << "\":" << JsonString(rt.getSecondName());
 	os << ", \"" << jsonlabel::GEN_DIFF << "\":" << rt.getGenerationDifference();
 	os << ", \"" << jsonlabel::TRAIT << "\":" << rt.getTrait();
 	os << "}";
@@ -282,6 +282,7 @@ void AppSettings::readJson(const Json::Value& value){
     lineColor.readJson(value[jsonlabel::LINE_COLOR]);
     lineWidth = value[jsonlabel::LINE_WIDTH].asInt();
     radius = value[jsonlabel::BORDER_RADIUS].asInt();
+    deduplicateFiles = value[jsonlabel::DEDUPLICATE_FILES].asBool();
 }
 
 void AppSettings::setDefault(){
@@ -308,6 +309,7 @@ void AppSettings::setDefault(){
     lineColor = Color(0, 0, 0);
     lineWidth = 3;
     radius = 5;
+    deduplicateFiles = false;
 }
 
 std::ostream& operator<<(std::ostream& os, const AppSettings& as){
@@ -323,7 +325,7 @@ std::ostream& operator<<(std::ostream& os, const AppSettings& as){
     os << ",\"" << jsonlabel::STANDARD_COLOR << "\":" << as.standard;
     os << ",\"" << jsonlabel::HIGHLIGHTED_COLOR << "\":" << as.highlightedColor;
     os << ",\"" << jsonlabel::PROBANT_COLOR << "\":" << as.probandColor;
-    os << ",\"" << jsonlabel::FONT_FAMILY << "\":\"" << as.fontFamily << "\"";
+    os << ",\"" << jsonlabel::FONT_FAMILY << "\":" << JsonString(as.fontFamily);
     os << ",\"" << jsonlabel::FONT_SIZE << "\":" << as.fontSize;
     os << ",\"" << jsonlabel::X_SIZE << "\":" << as.sizeX;
     os << ",\"" << jsonlabel::Y_SIZE << "\":" << as.sizeY;
@@ -335,6 +337,7 @@ std::ostream& operator<<(std::ostream& os, const AppSettings& as){
     os << ",\"" << jsonlabel::LINE_COLOR << "\":" << as.lineColor;
     os << ",\"" << jsonlabel::LINE_WIDTH << "\":" << as.lineWidth;
     os << ",\"" << jsonlabel::BORDER_RADIUS << "\":" << as.radius;
+    os << ",\"" << jsonlabel::DEDUPLICATE_FILES << "\":" << as.deduplicateFiles;
     os << "}";
     return os;
 }
@@ -345,6 +348,14 @@ std::ostream& operator<<(std::ostream& os, const AppSettings& as){
 
 Settings::Settings() : appSettings_(AppSettings()), eventTemplateIndex_(1), globalMainPerson_(0), relationTemplateIndex_(1){}
 
+Settings::Settings(const Settings& other) : appSettings_(other.appSettings_), eventTemplateIndex_(other.eventTemplateIndex_), globalMainPerson_(other.globalMainPerson_),
+    relationTemplateIndex_(other.relationTemplateIndex_), tags_(other.tags_), tagSet_(other.tagSet_){
+    for(auto&& [id, templ] : other.eventTemplates_)
+        eventTemplates_[id] = std::make_unique<EventTemplate>(*templ);
+    for(auto&& [id, templ] : other.relationsTemplates_)
+        relationsTemplates_[id] = std::make_unique<RelationTemplate>(*templ);
+}
+
 void Settings::addDefaultEvent(const std::string& title, const std::string& description, bool date, bool place, bool morePeople, std::vector<std::string> roles){
     EventTemplate templ;
     templ.setTitle() = title;
@@ -416,7 +427,7 @@ size_t Settings::addRelationTemplate(RelationTemplate& rt){
 }
 
 void Settings::addTag(const std::string& tag){
-    if(std::any_of(tags_.begin(), tags_.end(), [tag](const std::string& t1){return tag == t1;})) return;
+    if(!tagSet_.insert(tag).second) return;
 	tags_.push_back(tag);
 }
 
@@ -427,6 +438,7 @@ void Settings::clear(){
 	relationsTemplates_.clear();
 	eventTemplates_.clear();
 	tags_.clear();
+	tagSet_.clear();
 }
 
 void Settings::exportTemplates(std::ostream& os, const std::vector<size_t>& relIds, const std::vector<size_t>& eventIds){
@@ -543,8 +555,19 @@ void Settings::removeRelationTemplate(size_t index){
 }
 
 void Settings::removeTag(const std::string& tag){
-    auto it = std::find_if(tags_.begin(), tags_.end(), [tag](const std::string& t1){return t1 == tag;});
-    if (it != tags_.end()) tags_.erase(it);
+    if(tagSet_.erase(tag) == 0) return;
+    tags_.erase(std::find(tags_.begin(), tags_.end(), tag));
+}
+
+void Settings::renameTag(const std::string& tag, const std::string& newTag){
+    if(tag == newTag || !tagSet_.contains(tag)) return;
+    if(tagSet_.contains(newTag)){
+        removeTag(tag);
+        return;
+    }
+    tagSet_.erase(tag);
+    tagSet_.insert(newTag);
+    *std::find(tags_.begin(), tags_.end(), tag) = newTag;
 }
 
 AppSettings& Settings::setAppSettings(){
@@ -585,7 +608,7 @@ std::ostream& operator <<(std::ostream& os, const Settings& settings){
 			os << ",";
 		}
 		first = false;
-		os << "{\"" << jsonlabel::TAG << "\":\"" << tag << "\"}";
+		os << "{\"" << jsonlabel::TAG << "\":" << JsonString(tag) << "}";
 	}
 	os << "]";
 	os << ",\"" << jsonlabel::APP_SETTINGS << "\":" << settings.getAppSettings();
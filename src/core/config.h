@@ -6,11 +6,13 @@
 #include <string>
 #include <ostream>
 #include <map>
+#include <set>
 #include <optional>
 #include <json/json.h>
 #include <climits>
 #include <algorithm>
 #include "strings.h"
+#include "json_string.h"
 
 /// Template for events. It specifies whether the event includes a date, a place or if more persons are involved and if they have some special roles.
 class EventTemplate{
@@ -208,6 +210,8 @@ std::ostream& operator<<(std::ostream& os, const Color& color);
 
 /// Struct for app settings.
 struct AppSettings{
+    /// If files and media with the same content are stored only once.
+    bool deduplicateFiles;
     /// Used font in the graphic boxes.
     std::string fontFamily;
     /// Size of the font used in the graphic boxes.
@@ -272,6 +276,9 @@ class Settings{
 	public:
 		/// Default constructor.
 		Settings();
+		/// Copy constructor, which copies all the templates.
+		/// @param other Copied settings.
+		Settings(const Settings& other);
 		/// Add default event templates.
 		void addDefaultEvents();
 		/// Add default relation templates.
@@ -340,6 +347,10 @@ class Settings{
 		/// Remove tag from the container.
 		/// @param tag Delete same tag if it exists.
 		void removeTag(const std::string& tag);
+		/// Rename tag in the container. If the new name is already present, the old tag is only removed.
+		/// @param tag Renamed tag.
+		/// @param newTag New name of the tag.
+		void renameTag(const std::string& tag, const std::string& newTag);
 		/// Get the reference to the app settings to edit it.
 		/// @return Reference to the app settings.
 		AppSettings& setAppSettings();
@@ -375,8 +386,10 @@ class Settings{
 		size_t relationTemplateIndex_;
 		/// All relationsTemplates.
 		std::map<size_t, std::unique_ptr<RelationTemplate>> relationsTemplates_;
-		/// All tags.
+		/// All tags in the order they were added.
 		std::vector<std::string> tags_;
+		/// All tags for fast lookup.
+		std::set<std::string> tagSet_;
 };
 
 /// Output all the settings to stream in JSON format.
@@ -0,0 +1,212 @@
+/// @file database_validator.cpp Source file for the validation of references between records of the database.
+#include "database_validator.h"
+#include <algorithm>
+#include <future>
+#include <iterator>
+#include <sstream>
+#include <tuple>
+#include "strings.h"
+
+namespace{
+    /// If the id is in the list.
+    /// @param ids List of ids.
+    /// @param id Searched id.
+    /// @return True if the list contains the id.
+    bool listed(const std::vector<size_t>& ids, size_t id){
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    }
+
+    /// Check that relations of the persons include them and that fathers, mothers and partners are fitting relations.
+    /// @param persons Container of all persons.
+    /// @param relations Container of all relations.
+    /// @param events Container of all events.
+    /// @param kinship Graph of relatives of all persons.
+    /// @return Found inconsistencies.
+    std::vector<ValidationIssue> checkPersons(const RecordMap<Person>& persons, const RecordMap<Relation>& relations, const RecordMap<Event>& events,
+                                              const KinshipGraph& kinship){
+        std::vector<ValidationIssue> issues;
+        for(auto&& [id, person] : persons){
+            for(size_t relId : person->getRelations()){
+                auto it = relations.find(relId);
+                if(it == relations.end() || (it->second->getFirstPerson() != id && it->second->getSecondPerson() != id))
+                    issues.push_back(ValidationIssue{DANGLING_RELATION, id, relId, false});
+            }
+            std::pair<size_t, Trait> special[] = {{person->getFather(), Fatherhood}, {person->getMother(), Motherhood}, {person->getPartner(), Partnership}};
+            for(auto&& [relId, trait] : special){
+                if(relId == 0) continue;
+                // The relation has to be listed and the person has to be the child in it, which the graph tells by the kind of the relative.
+                auto optRelative = kinship.getRelative(id, relId);
+                bool fitting = listed(person->getRelations(), relId) && optRelative && (*optRelative)->trait == trait;
+                if(fitting && trait != Partnership) fitting = kin::kind((*optRelative)->trait, (*optRelative)->generations) == KIN_PARENT;
+                if(!fitting) issues.push_back(ValidationIssue{INVALID_SPECIAL_RELATION, id, relId, false});
+            }
+            for(size_t eventId : person->getEvents()){
+                auto it = events.find(eventId);
+                bool included = it != events.end() && std::any_of(it->second->getPersons().begin(), it->second->getPersons().end(),
+                                                                  [id](auto&& role){ return role.second == id; });
+                if(!included) issues.push_back(ValidationIssue{DANGLING_EVENT, id, eventId, false});
+            }
+        }
+        return issues;
+    }
+
+    /// Check that persons and templates of the relations exist and that the persons list the relations.
+    /// @param persons Container of all persons.
+    /// @param relations Container of all relations.
+    /// @param settings Settings with the templates.
+    /// @return Found inconsistencies.
+    std::vector<ValidationIssue> checkRelations(const RecordMap<Person>& persons, const RecordMap<Relation>& relations, const Settings& settings){
+        std::vector<ValidationIssue> issues;
+        for(auto&& [id, rel] : relations){
+            if(!settings.getRelationTemplate(rel->getTemplate()))
+                issues.push_back(ValidationIssue{INVALID_RELATION_TEMPLATE, id, rel->getTemplate(), false});
+            for(size_t personId : {rel->getFirstPerson(), rel->getSecondPerson()}){
+                auto it = persons.find(personId);
+                if(it == persons.end())
+                    issues.push_back(ValidationIssue{INVALID_RELATION_PERSON, id, personId, false});
+                else if(!listed(it->second->getRelations(), id))
+                    issues.push_back(ValidationIssue{UNLISTED_RELATION, id, personId, false});
+            }
+        }
+        return issues;
+    }
+
+    /// Check that persons and templates of the events exist and that the persons list the events.
+    /// @param persons Container of all persons.
+    /// @param events Container of all events.
+    /// @param settings Settings with the templates.
+    /// @return Found inconsistencies.
+    std::vector<ValidationIssue> checkEvents(const RecordMap<Person>& persons, const RecordMap<Event>& events, const Settings& settings){
+        std::vector<ValidationIssue> issues;
+        for(auto&& [id, event] : events){
+            if(!settings.getEventTemplate(event->getTemplate()))
+                issues.push_back(ValidationIssue{INVALID_EVENT_TEMPLATE, id, event->getTemplate(), false});
+            for(auto&& [role, personId] : event->getPersons()){
+                auto it = persons.find(personId);
+                if(it == persons.end())
+                    issues.push_back(ValidationIssue{INVALID_EVENT_PERSON, id, personId, false});
+                else if(!listed(it->second->getEvents(), id))
+                    issues.push_back(ValidationIssue{UNLISTED_EVENT, id, personId, false});
+            }
+        }
+        return issues;
+    }
+
+    /// Find the strongly connected components of the graph of parents by Tarjan's algorithm without recursion.
+    /// @param persons Container of all persons.
+    /// @param kinship Graph of relatives of all persons.
+    /// @return Components with more persons or a person which is its own parent.
+    std::vector<std::vector<size_t>> findCycles(const RecordMap<Person>& persons, const KinshipGraph& kinship){
+        RecordPositions positions (persons);
+        // Order of the visit of each person by its position, 0 for not visited yet.
+        std::vector<size_t> order (positions.size(), 0);
+        std::vector<size_t> lowest (positions.size(), 0);
+        std::vector<bool> stacked (positions.size(), false);
+        std::vector<size_t> stack;
+        // Persons being visited with the index of their next parent.
+        std::vector<std::pair<size_t, size_t>> visits;
+        std::vector<std::vector<size_t>> cycles;
+        size_t counter = 0;
+        auto visit = [&](size_t person){
+            size_t position = positions.find(person);
+            order[position] = lowest[position] = ++counter;
+            stack.push_back(person);
+            stacked[position] = true;
+            visits.push_back({person, 0});
+        };
+        for(auto&& [root, rootPerson] : persons){
+            if(order[positions.find(root)] != 0) continue;
+            visit(root);
+            while(!visits.empty()){
+                size_t person = visits.back().first;
+                size_t position = positions.find(person);
+                auto parents = kinship.getRelatives(person, KIN_PARENT);
+                if(visits.back().second < parents.size()){
+                    size_t parent = parents[visits.back().second++].person;
+                    if(!persons.contains(parent)) continue;
+                    size_t parentPosition = positions.find(parent);
+                    if(order[parentPosition] == 0) visit(parent);
+                    else if(stacked[parentPosition]) lowest[position] = std::min(lowest[position], order[parentPosition]);
+                    continue;
+                }
+                visits.pop_back();
+                if(!visits.empty()){
+                    size_t childPosition = positions.find(visits.back().first);
+                    lowest[childPosition] = std::min(lowest[childPosition], lowest[position]);
+                }
+                if(lowest[position] != order[position]) continue;
+                // The person is the root of a component, which is on the stack above it.
+                auto first = std::find(stack.rbegin(), stack.rend(), person).base() - 1;
+                std::vector<size_t> component (first, stack.end());
+                stack.erase(first, stack.end());
+                for(size_t member : component)
+                    stacked[positions.find(member)] = false;
+                bool ownParent = std::any_of(parents.begin(), parents.end(), [person](const Kinship& parent){ return parent.person == person; });
+                if(component.size() > 1 || ownParent){
+                    std::sort(component.begin(), component.end());
+                    cycles.push_back(std::move(component));
+                }
+            }
+        }
+        std::sort(cycles.begin(), cycles.end());
+        return cycles;
+    }
+}
+
+// =====================================================================
+// Validation
+// =====================================================================
+
+std::string validation::describe(const ValidationReport& report){
+    if(report.issues.empty() && report.cycles.empty()) return CONSISTENT;
+    std::stringstream ss;
+    for(const ValidationIssue& issue : report.issues){
+        const std::string& text = ISSUES[issue.kind];
+        size_t ids[] = {issue.record, issue.reference};
+        size_t next = 0;
+        for(char c : text){
+            if(c == '#' && next < 2) ss << ids[next++];
+            else ss << c;
+        }
+        if(issue.repaired) ss << REPAIRED;
+        ss << std::endl;
+    }
+    for(auto&& cycle : report.cycles){
+        ss << CYCLE;
+        for(size_t i = 0; i < cycle.size(); ++i)
+            ss << (i == 0 ? "" : ", ") << cycle[i];
+        ss << std::endl;
+    }
+    return ss.str();
+}
+
+std::string validation::summarize(const ValidationReport& report){
+    if(report.issues.empty() && report.cycles.empty()) return CONSISTENT;
+    std::vector<size_t> counts (std::size(ISSUES), 0);
+    for(const ValidationIssue& issue : report.issues)
+        ++counts[issue.kind];
+    std::stringstream ss;
+    ss << SUMMARY << std::endl;
+    for(size_t kind = 0; kind < counts.size(); ++kind)
+        if(counts[kind] > 0) ss << KINDS[kind] << counts[kind] << std::endl;
+    if(!report.cycles.empty()) ss << CYCLES << report.cycles.size() << std::endl;
+    return ss.str();
+}
+
+ValidationReport validation::validate(const RecordMap<Person>& persons, const RecordMap<Relation>& relations, const RecordMap<Event>& events,
+                                      const Settings& settings, const KinshipGraph& kinship){
+    // Collections are only read, so they are checked at the same time.
+    auto personIssues = std::async(std::launch::async, checkPersons, std::cref(persons), std::cref(relations), std::cref(events), std::cref(kinship));
+    auto relationIssues = std::async(std::launch::async, checkRelations, std::cref(persons), std::cref(relations), std::cref(settings));
+    auto eventIssues = std::async(std::launch::async, checkEvents, std::cref(persons), std::cref(events), std::cref(settings));
+    ValidationReport report;
+    report.cycles = findCycles(persons, kinship);
+    for(auto* future : {&personIssues, &relationIssues, &eventIssues}){
+        auto issues = future->get();
+        report.issues.insert(report.issues.end(), issues.begin(), issues.end());
+    }
+    std::sort(report.issues.begin(), report.issues.end(), [](const ValidationIssue& a, const ValidationIssue& b){
+        return std::make_tuple(a.kind, a.record, a.reference) < std::make_tuple(b.kind, b.record, b.reference);
+    });
+    return report;
+}
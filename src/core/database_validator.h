@@ -0,0 +1,59 @@
+/// @file database_validator.h Header file for the validation of references between records of the database.
+#ifndef database_validator_h_
+#define database_validator_h_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "family_tree_items.h"
+#include "kinship_graph.h"
+#include "person.h"
+#include "record_map.h"
+
+/// Kind of an inconsistency between records.
+enum Inconsistency {INVALID_RELATION_PERSON, INVALID_RELATION_TEMPLATE, UNLISTED_RELATION, DANGLING_RELATION, INVALID_SPECIAL_RELATION,
+                    INVALID_EVENT_PERSON, INVALID_EVENT_TEMPLATE, UNLISTED_EVENT, DANGLING_EVENT};
+
+/// One broken reference between records.
+struct ValidationIssue{
+    /// Kind of the inconsistency.
+    Inconsistency kind;
+    /// Id of the record holding the broken reference.
+    size_t record;
+    /// Id of the referenced record.
+    size_t reference;
+    /// If the inconsistency was repaired.
+    bool repaired;
+};
+
+/// Report of all inconsistencies of the database.
+struct ValidationReport{
+    /// Broken references ordered by their kinds and records.
+    std::vector<ValidationIssue> issues;
+    /// Groups of persons which are ancestors of each other, each ordered by ids.
+    std::vector<std::vector<size_t>> cycles;
+};
+
+/// Namespace for everything with validation of the database.
+namespace validation{
+    /// Describe the report, one line for each inconsistency.
+    /// @param report Report of the validation.
+    /// @return Text of the report.
+    std::string describe(const ValidationReport& report);
+    /// Summarize the report, one line for each kind of the found inconsistencies and one for the cycles.
+    /// @param report Report of the validation.
+    /// @return Text with the numbers of the inconsistencies.
+    std::string summarize(const ValidationReport& report);
+    /// Check references of all persons, relations and events and find cycles of ancestry. Each collection is checked on its own thread.
+    /// @param persons Container of all persons.
+    /// @param relations Container of all relations.
+    /// @param events Container of all events.
+    /// @param settings Settings with the templates.
+    /// @param kinship Graph of relatives of all persons, it has to be built.
+    /// @return Report of all found inconsistencies, none of them repaired.
+    ValidationReport validate(const RecordMap<Person>& persons, const RecordMap<Relation>& relations, const RecordMap<Event>& events,
+                              const Settings& settings, const KinshipGraph& kinship);
+}
+
+#endif
@@ -1,5 +1,6 @@
 /// @file date.cpp Source file for date formats.
 #include "date.h"
+#include <algorithm>
 
 // =====================================================================
 // Date
@@ -27,6 +28,13 @@ bool Date::isExact() const{
 	return day != 0 && month != 0 && year != 0;
 }
 
+uint32_t Date::key() const{
+	uint32_t y = std::clamp(year, 0, 0x3FFFFF);
+	uint32_t m = std::clamp(month, 0, 0xF);
+	uint32_t d = std::clamp(day, 0, 0x1F);
+	return (y << 9) | (m << 5) | d;
+}
+
 void Date::read(const std::string& date){
 	year = month = day = 0;
 	int number = 0;
@@ -90,6 +98,10 @@ std::string Date::str() const{
     return iss.str();
 }
 
+bool Date::operator<(const Date& other) const{
+	return key() < other.key();
+}
+
 // =====================================================================
 // functions for Date
 // =====================================================================
@@ -109,10 +121,16 @@ std::ostream& operator<<(std::ostream& os, const Date& d){
 
 WrappedDate::WrappedDate(){
 	std::time_t t = std::time(0);
-    std::tm* now = std::localtime(&t);
-    date1_.setYear(now->tm_year + 1900);
-    date1_.setMonth(now->tm_mon + 1);
-    date1_.setDay(now->tm_mday);
+    std::tm now;
+    // Reentrant variants are safe on the loading threads and they do not check the time zone again for each date.
+    #ifdef _WIN32
+        localtime_s(&now, &t);
+    #else
+        localtime_r(&t, &now);
+    #endif
+    date1_.setYear(now.tm_year + 1900);
+    date1_.setMonth(now.tm_mon + 1);
+    date1_.setDay(now.tm_mday);
 }
 
 void WrappedDate::clear(){
@@ -142,6 +160,20 @@ bool WrappedDate::isUnknown() const{
     return date1_.isEmpty() && date2_.isEmpty() && text_ == EMPTY_STRING;
 }
 
+uint32_t WrappedDate::key() const{
+    return (date1_.key() << 1) | (date2_.isEmpty() ? 0 : 1);
+}
+
+void WrappedDate::readBinary(BinaryReader& reader){
+    for(Date* date : {&date1_, &date2_}){
+        int year = reader.read<int>();
+        int month = reader.read<int>();
+        int day = reader.read<int>();
+        *date = Date(year, month, day);
+    }
+    reader.read(text_);
+}
+
 void WrappedDate::readJson(const Json::Value& value){
 	date1_.read(value[jsonlabel::DATE].asString());
     date2_.read(value[jsonlabel::LAST_DATE].asString());
@@ -180,6 +212,19 @@ void WrappedDate::updateDate(){
 	}
 }
 
+void WrappedDate::writeBinary(BinaryWriter& writer) const{
+    for(const Date* date : {&date1_, &date2_}){
+        writer.write(date->getYear());
+        writer.write(date->getMonth());
+        writer.write(date->getDay());
+    }
+    writer.write(text_);
+}
+
+bool WrappedDate::operator<(const WrappedDate& other) const{
+    return key() < other.key();
+}
+
 // =====================================================================
 // functions for WrappedDate
 // =====================================================================
@@ -188,7 +233,7 @@ std::ostream& operator<<(std::ostream& os, const WrappedDate& wd){
 	os << "\"" << jsonlabel::DATE << "\":{";
     os << "\"" << jsonlabel::DATE << "\":\"" << wd.getFirstDate() << "\"";
     os << ", \"" << jsonlabel::LAST_DATE << "\":\"" << wd.getSecondDate() << "\"";
-    os << ", \"" << jsonlabel::TEXT << "\":\"" << wd.getText() << "\"";
+    os << ", \"" << jsonlabel::TEXT << "\":" << JsonString(wd.getText());
 	os << "}";
 	return os;
 }
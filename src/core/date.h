@@ -2,12 +2,15 @@
 #ifndef date_h_
 #define date_h_
 
+#include <cstdint>
 #include <string>
 #include <ostream>
 #include <sstream>
 #include <json/json.h>
 #include <ctime>
+#include "binary_cache.h"
 #include "strings.h"
+#include "json_string.h"
 
 /// Basic date format. Holding three numbers for year, month and day. If some of the numbers are not defined 0 is present.
 class Date{
@@ -34,6 +37,10 @@ class Date{
 		/// Date is exact when all values are defined (non-zero).
 		/// @return True if the date is exact.
 		bool isExact() const;
+		/// Get the key ordering dates chronologically. Unknown month or day is 0, so it sorts before the known ones.
+		/// The year takes 22 bits, the month 4 bits and the day 5 bits, the highest bit is left free.
+		/// @return Year, month and day packed to one number.
+		uint32_t key() const;
 		/// Load date from string in specified flexible format:
 		/// yyyy-mm-dd (if there would be for example 05 it can only be 5).
 		/// If it does not follow the format there will be corrupted data and won't raise an exception.
@@ -52,6 +59,10 @@ class Date{
 		/// If one of the values are set to 0, then it is replaced by the same number of ?
 		/// @return String in the format.
 		std::string str() const;
+		/// Compare the dates chronologically.
+		/// @param other Compared date.
+		/// @return True if the key of this date is lower.
+		bool operator<(const Date& other) const;
 	private:
 		/// Day number.
 		int day;
@@ -91,6 +102,13 @@ class WrappedDate{
 		/// Check if the date is unknown. To be unknown all values are 0 and text is empty.
 		/// @return If the date is unknown.
 		bool isUnknown() const;
+		/// Get the key ordering wrapped dates chronologically by their first date.
+		/// Intervals sort after the single dates with the same first date and the dates given only by the text have key 0.
+		/// @return Key of the first date shifted left by one bit, the lowest bit is set for intervals.
+		uint32_t key() const;
+		/// Read the data from the binary image.
+		/// @param reader Reader of the image.
+		void readBinary(BinaryReader& reader);
 		/// Read the data from JSON formatting.
 		/// @param value Given JSON value.
 		void readJson(const Json::Value& value);
@@ -112,6 +130,13 @@ class WrappedDate{
 		std::string str() const;
 		/// Switch the dates if the first one is empty.
 		void updateDate();
+		/// Write the data to the binary image.
+		/// @param writer Writer of the image.
+		void writeBinary(BinaryWriter& writer) const;
+		/// Compare the wrapped dates chronologically.
+		/// @param other Compared wrapped date.
+		/// @return True if the key of this date is lower.
+		bool operator<(const WrappedDate& other) const;
 	private:
 		/// Main date, if interval is set it is the first day.
 		Date date1_;
@@ -0,0 +1,106 @@
+/// @file date_index.cpp Source file for the index of birth, death and event dates.
+#include "date_index.h"
+#include <algorithm>
+
+namespace{
+    /// Order of the records by the keys and then by the ids.
+    /// @param a First record.
+    /// @param b Second record.
+    /// @return True if the first record goes before the second one.
+    bool earlier(const DatedRecord& a, const DatedRecord& b){
+        return a.key != b.key ? a.key < b.key : a.id < b.id;
+    }
+}
+
+// =====================================================================
+// DateIndex
+// =====================================================================
+
+DateIndex::DateIndex() : valid_(false){}
+
+void DateIndex::add(const Event& event, const Settings& settings){
+    auto optTempl = settings.getEventTemplate(event.getTemplate());
+    if(!optTempl || !(*optTempl)->containsDate()) return;
+    if(!event.getDate().getFirstDate().isEmpty())
+        records_[DATE_EVENT].push_back(DatedRecord{event.getDate().key(), event.getId()});
+}
+
+void DateIndex::add(const Person& person){
+    if(!person.getBirthDate().getFirstDate().isEmpty())
+        records_[DATE_BIRTH].push_back(DatedRecord{person.getBirthDate().key(), person.getId()});
+    if(!person.isAlive() && !person.getDeathDate().getFirstDate().isEmpty())
+        records_[DATE_DEATH].push_back(DatedRecord{person.getDeathDate().key(), person.getId()});
+}
+
+std::span<const DatedRecord> DateIndex::find(DateKind kind, const Date& from, const Date& to) const{
+    const std::vector<DatedRecord>& records = records_[kind];
+    // Keys of wrapped dates are the keys of their first dates shifted by one bit.
+    uint64_t lower = from.isEmpty() ? 0 : static_cast<uint64_t>(from.key()) << 1;
+    uint64_t upper = UINT64_MAX;
+    if(!to.isEmpty()){
+        // The first key after the last day of the range.
+        uint64_t end = to.key();
+        if(to.getDay() != 0) end += 1;
+        else if(to.getMonth() != 0) end += 1 << 5;
+        else end += 1 << 9;
+        upper = end << 1;
+    }
+    if(lower >= upper) return {};
+    auto first = std::partition_point(records.begin(), records.end(), [lower](const DatedRecord& r){ return r.key < lower; });
+    auto last = std::partition_point(first, records.end(), [upper](const DatedRecord& r){ return r.key < upper; });
+    return {first, last};
+}
+
+std::span<const DatedRecord> DateIndex::getRecords(DateKind kind) const{
+    return records_[kind];
+}
+
+void DateIndex::invalidate(){
+    if(!valid_) return;
+    for(auto&& records : records_)
+        records = {};
+    staleEvents_.clear();
+    stalePersons_.clear();
+    valid_ = false;
+}
+
+void DateIndex::invalidateEvent(size_t event){
+    if(valid_) staleEvents_.insert(event);
+}
+
+void DateIndex::invalidatePerson(size_t person){
+    if(valid_) stalePersons_.insert(person);
+}
+
+void DateIndex::refresh(const RecordMap<Person>& persons, const RecordMap<Event>& events, const Settings& settings){
+    if(!valid_){
+        for(auto&& [id, person] : persons)
+            add(*person);
+        for(auto&& [id, event] : events)
+            add(*event, settings);
+        for(auto&& records : records_)
+            std::sort(records.begin(), records.end(), earlier);
+        valid_ = true;
+        return;
+    }
+    if(stalePersons_.empty() && staleEvents_.empty()) return;
+    // Stale records are removed, the current ones are appended, sorted and merged with the rest in linear time.
+    size_t sorted[dates::COUNT];
+    for(size_t kind = 0; kind < dates::COUNT; ++kind){
+        const std::set<size_t>& stale = kind == DATE_EVENT ? staleEvents_ : stalePersons_;
+        if(!stale.empty())
+            std::erase_if(records_[kind], [&stale](const DatedRecord& r){ return stale.contains(r.id); });
+        sorted[kind] = records_[kind].size();
+    }
+    for(size_t id : stalePersons_)
+        if(persons.contains(id)) add(*persons.at(id));
+    for(size_t id : staleEvents_)
+        if(events.contains(id)) add(*events.at(id), settings);
+    for(size_t kind = 0; kind < dates::COUNT; ++kind){
+        std::vector<DatedRecord>& records = records_[kind];
+        std::sort(records.begin() + sorted[kind], records.end(), earlier);
+        std::inplace_merge(records.begin(), records.begin() + sorted[kind], records.end(), earlier);
+    }
+    stalePersons_.clear();
+    staleEvents_.clear();
+}
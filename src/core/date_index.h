@@ -0,0 +1,81 @@
+/// @file date_index.h Header file for the index of birth, death and event dates.
+#ifndef date_index_h_
+#define date_index_h_
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <span>
+#include <vector>
+#include "config.h"
+#include "date.h"
+#include "family_tree_items.h"
+#include "person.h"
+#include "record_map.h"
+
+/// What the indexed date belongs to.
+enum DateKind {DATE_BIRTH, DATE_DEATH, DATE_EVENT};
+
+/// Namespace for everything with kinds of indexed dates.
+namespace dates{
+    /// Number of kinds of indexed dates.
+    constexpr size_t COUNT = 3;
+}
+
+/// Record with a known date.
+struct DatedRecord{
+    /// Key of the wrapped date.
+    uint32_t key;
+    /// Id of the person or the event.
+    size_t id;
+};
+
+/// Known dates of births and deaths of persons and of events with dates, each kind sorted by the keys of the dates.
+/// Intervals are indexed by their first date and dates given only by a text are left out.
+/// Changed records are only marked stale and they are sorted in again at the next refresh.
+class DateIndex{
+    public:
+        /// Default constructor of an invalid index.
+        DateIndex();
+        /// Find records with the date in the range. Unknown month or day of the bounds extends the range to the whole year or month.
+        /// @param kind Kind of the dates.
+        /// @param from First date of the range, empty for no lower bound.
+        /// @param to Last date of the range, empty for no upper bound.
+        /// @return Records ordered by their dates.
+        std::span<const DatedRecord> find(DateKind kind, const Date& from, const Date& to) const;
+        /// Get all records with the date of given kind.
+        /// @param kind Kind of the dates.
+        /// @return Records ordered by their dates.
+        std::span<const DatedRecord> getRecords(DateKind kind) const;
+        /// Drop the whole index, it is built again at the next refresh.
+        void invalidate();
+        /// Mark the event to be indexed again at the next refresh.
+        /// @param event Id of the changed, added or removed event.
+        void invalidateEvent(size_t event);
+        /// Mark the person to be indexed again at the next refresh.
+        /// @param person Id of the changed, added or removed person.
+        void invalidatePerson(size_t person);
+        /// Bring the index up to date with the persons and events.
+        /// @param persons Container of all persons.
+        /// @param events Container of all events.
+        /// @param settings Settings with the event templates.
+        void refresh(const RecordMap<Person>& persons, const RecordMap<Event>& events, const Settings& settings);
+    private:
+        /// Records of each kind sorted by the keys.
+        std::vector<DatedRecord> records_[dates::COUNT];
+        /// Events which have to be indexed again.
+        std::set<size_t> staleEvents_;
+        /// Persons which have to be indexed again.
+        std::set<size_t> stalePersons_;
+        /// If the index was built.
+        bool valid_;
+        /// Add the dates of the event.
+        /// @param event Indexed event.
+        /// @param settings Settings with the event templates.
+        void add(const Event& event, const Settings& settings);
+        /// Add the dates of the person.
+        /// @param person Indexed person.
+        void add(const Person& person);
+};
+
+#endif
@@ -0,0 +1,338 @@
+/// @file duplicate_detector.cpp Source file for the detection of persons recorded more times.
+#include "duplicate_detector.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include "person_index.h"
+#include "strings.h"
+
+namespace{
+    /// Maximum size of a block whose persons are all compared with each other.
+    constexpr size_t MAX_BLOCK = 200;
+    /// Number of following persons each person is compared with in bigger blocks.
+    constexpr size_t WINDOW = 20;
+    /// Number of persons taken by a thread at once when the profiles are made.
+    constexpr size_t CHUNK = 1024;
+    /// Score of the birth or death dates by the difference of the years.
+    constexpr double CLOSE_YEARS[] = {1, 0.6, 0.4, 0.2, 0.2, 0.2};
+
+    /// Fields of a person prepared for the comparison.
+    struct Profile{
+        /// Id of the person.
+        size_t id;
+        /// Normalized name, empty if it is unknown.
+        std::string name;
+        /// Phonetic key of the name.
+        std::string nameKey;
+        /// Normalized surname and maiden name, empty if they are unknown.
+        std::string surnames[2];
+        /// Phonetic keys of the surname and of the maiden name.
+        std::string surnameKeys[2];
+        /// Gender of the person.
+        Gender gender;
+        /// First date of the birth.
+        Date birth;
+        /// First date of the death, empty for living persons.
+        Date death;
+        /// Normalized place of the birth.
+        std::string birthPlace;
+        /// Normalized place of the death.
+        std::string deathPlace;
+        /// Hashes of the kinds and phonetic names of the relatives in ascending order.
+        std::vector<size_t> relatives;
+    };
+
+    /// Call the task for each index on several threads. Each thread takes the next index when it is done.
+    /// @param count Number of indices.
+    /// @param threads Number of threads.
+    /// @param task Function called with the index and the number of the thread.
+    template<typename Task>
+    void parallel(size_t count, size_t threads, Task task){
+        std::atomic<size_t> next = 0;
+        std::vector<std::future<void>> workers;
+        for(size_t thread = 0; thread < threads; ++thread){
+            workers.push_back(std::async(std::launch::async, [&next, &task, count, thread](){
+                for(size_t index = next++; index < count; index = next++)
+                    task(index, thread);
+            }));
+        }
+        for(auto&& worker : workers)
+            worker.get();
+    }
+
+    /// Normalize the text with words separated by single spaces.
+    /// @param text Text in UTF-8.
+    /// @param placeholder Default text standing for an unknown value.
+    /// @return Normalized text, empty if it is the placeholder.
+    std::string field(const std::string& text, const std::string& placeholder = EMPTY_STRING){
+        std::string result;
+        for(char c : search::normalize(text)){
+            if(c != ' ' || (!result.empty() && result.back() != ' ')) result.push_back(c);
+        }
+        if(!result.empty() && result.back() == ' ') result.pop_back();
+        return text == placeholder ? EMPTY_STRING : result;
+    }
+
+    /// Mix values to one key of a block, collisions only join blocks.
+    /// @param hash Hash of the phonetic key of a surname.
+    /// @param kind Kind of the block.
+    /// @param value Decade or hash of the phonetic key of the name.
+    /// @return Key of the block.
+    uint64_t blockKey(size_t hash, uint64_t kind, uint64_t value){
+        return hash ^ (kind * 0x9E3779B97F4A7C15ull) ^ (value * 0xC2B2AE3D27D4EB4Full);
+    }
+
+    /// Similarity of two dates by the difference of their years. Known months and days which differ lower it.
+    /// @param first First date with a known year.
+    /// @param second Second date with a known year.
+    /// @return Similarity from 0 to 1.
+    double dateSimilarity(const Date& first, const Date& second){
+        size_t difference = std::abs(first.getYear() - second.getYear());
+        if(difference > 0) return difference < std::size(CLOSE_YEARS) ? CLOSE_YEARS[difference] : 0;
+        if(first.getMonth() != 0 && second.getMonth() != 0 && first.getMonth() != second.getMonth()) return 0.6;
+        if(first.getDay() != 0 && second.getDay() != 0 && first.getDay() != second.getDay()) return 0.8;
+        return 1;
+    }
+
+    /// If the persons are directly related, a parent and a child may have the same name.
+    /// @param kinship Graph of relatives of all persons.
+    /// @param first Id of the first person.
+    /// @param second Id of the second person.
+    /// @return True if one person is a relative of the other one.
+    bool related(const KinshipGraph& kinship, size_t first, size_t second){
+        auto relatives = kinship.getRelatives(first);
+        auto others = kinship.getRelatives(second);
+        if(others.size() < relatives.size()){
+            std::swap(relatives, others);
+            std::swap(first, second);
+        }
+        return std::any_of(relatives.begin(), relatives.end(), [second](const Kinship& relative){ return relative.person == second; });
+    }
+
+    /// Score how likely the profiles belong to the same person. Only fields known for both persons count, differing genders exclude the pair.
+    /// Names alone are not enough, so the score of a pair known only by names is lowered.
+    /// @param first First profile.
+    /// @param second Second profile.
+    /// @return Score from 0 to 1.
+    double score(const Profile& first, const Profile& second){
+        if(first.gender != Other && second.gender != Other && first.gender != second.gender) return 0;
+        double total = 0;
+        double weights = 0;
+        bool evidence = false;
+        auto add = [&total, &weights](double weight, double value){
+            total += weight * value;
+            weights += weight;
+        };
+        double surname = 0;
+        for(const std::string& a : first.surnames)
+            for(const std::string& b : second.surnames)
+                if(!a.empty() && !b.empty()) surname = std::max(surname, duplicates::similarity(a, b));
+        add(2, surname);
+        if(!first.name.empty() && !second.name.empty()) add(2, duplicates::similarity(first.name, second.name));
+        if(first.birth.getYear() != 0 && second.birth.getYear() != 0){
+            add(2, dateSimilarity(first.birth, second.birth));
+            evidence = true;
+        }
+        if(first.death.getYear() != 0 && second.death.getYear() != 0){
+            add(1, dateSimilarity(first.death, second.death));
+            evidence = true;
+        }
+        if(!first.birthPlace.empty() && !second.birthPlace.empty()){
+            add(1, duplicates::similarity(first.birthPlace, second.birthPlace));
+            evidence = true;
+        }
+        if(!first.deathPlace.empty() && !second.deathPlace.empty()){
+            add(0.5, duplicates::similarity(first.deathPlace, second.deathPlace));
+            evidence = true;
+        }
+        if(!first.relatives.empty() && !second.relatives.empty()){
+            size_t shared = 0;
+            auto a = first.relatives.begin();
+            auto b = second.relatives.begin();
+            while(a != first.relatives.end() && b != second.relatives.end()){
+                if(*a < *b) ++a;
+                else if(*b < *a) ++b;
+                else{
+                    ++shared;
+                    ++a;
+                    ++b;
+                }
+            }
+            add(2, static_cast<double>(shared) / std::min(first.relatives.size(), second.relatives.size()));
+            evidence = true;
+        }
+        return evidence ? total / weights : 0.75 * total / weights;
+    }
+}
+
+// =====================================================================
+// Duplicates
+// =====================================================================
+
+std::vector<DuplicateCandidate> duplicates::find(const RecordMap<Person>& persons, const KinshipGraph& kinship, double threshold){
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<const Person*> records;
+    for(auto&& [id, person] : persons)
+        records.push_back(person.get());
+    RecordPositions positions (persons);
+    std::vector<size_t> indices (positions.size(), records.size());
+    for(size_t i = 0; i < records.size(); ++i)
+        indices[positions.find(records[i]->getId())] = i;
+    // Fields of the persons are prepared first, relatives are described by their phonetic keys, so they need all fields done.
+    std::vector<Profile> profiles (records.size());
+    size_t chunks = (records.size() + CHUNK - 1) / CHUNK;
+    parallel(chunks, threads, [&](size_t chunk, size_t){
+        for(size_t i = chunk * CHUNK; i < std::min(records.size(), (chunk + 1) * CHUNK); ++i){
+            const Person* person = records[i];
+            Profile& profile = profiles[i];
+            profile.id = person->getId();
+            profile.name = field(person->getName(), person::NAME_STR);
+            profile.nameKey = duplicates::phonetic(profile.name);
+            profile.surnames[0] = field(person->getSurname(), person::SURNAME_STR);
+            profile.surnames[1] = field(person->getMaidenName());
+            for(size_t j = 0; j < 2; ++j)
+                profile.surnameKeys[j] = duplicates::phonetic(profile.surnames[j]);
+            if(profile.surnameKeys[1] == profile.surnameKeys[0]) profile.surnameKeys[1].clear();
+            profile.gender = person->getGender();
+            profile.birth = person->getBirthDate().getFirstDate();
+            // Living persons have a date of death too, which is ignored.
+            if(!person->isAlive()) profile.death = person->getDeathDate().getFirstDate();
+            profile.birthPlace = field(person->getBirthPlace());
+            profile.deathPlace = field(person->getDeathPlace());
+        }
+    });
+    parallel(chunks, threads, [&](size_t chunk, size_t){
+        std::hash<std::string> hash;
+        for(size_t i = chunk * CHUNK; i < std::min(records.size(), (chunk + 1) * CHUNK); ++i){
+            Profile& profile = profiles[i];
+            for(const Kinship& relative : kinship.getRelatives(profile.id)){
+                size_t position = positions.find(relative.person);
+                if(position == positions.size() || indices[position] == records.size()) continue;
+                const Profile& other = profiles[indices[position]];
+                if(other.nameKey.empty() && other.surnameKeys[0].empty()) continue;
+                Kin kind = kin::kind(relative.trait, relative.generations);
+                profile.relatives.push_back(hash(other.nameKey + ' ' + other.surnameKeys[0]) ^ (kind * 0x9E3779B97F4A7C15ull));
+            }
+            std::sort(profile.relatives.begin(), profile.relatives.end());
+        }
+    });
+    // Each person is in the blocks of both decades around its birth and in the block of its name for each of its surnames.
+    std::vector<std::pair<uint64_t, size_t>> entries;
+    std::hash<std::string> hash;
+    for(size_t i = 0; i < profiles.size(); ++i){
+        const Profile& profile = profiles[i];
+        for(const std::string& surnameKey : profile.surnameKeys){
+            if(surnameKey.empty()) continue;
+            size_t surnameHash = hash(surnameKey);
+            int year = profile.birth.getYear();
+            if(year != 0){
+                int decade = year >= 0 ? year / 10 : (year - 9) / 10;
+                entries.push_back({blockKey(surnameHash, 1, decade), i});
+                entries.push_back({blockKey(surnameHash, 1, decade - 1), i});
+            }
+            if(!profile.nameKey.empty()) entries.push_back({blockKey(surnameHash, 2, hash(profile.nameKey)), i});
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    std::vector<std::pair<size_t, size_t>> blocks;
+    for(size_t begin = 0, end = 0; begin < entries.size(); begin = end){
+        while(end < entries.size() && entries[end].first == entries[begin].first)
+            ++end;
+        if(end - begin > 1) blocks.push_back({begin, end});
+    }
+    // Big blocks take the longest, so they are taken first.
+    std::stable_sort(blocks.begin(), blocks.end(), [](auto&& a, auto&& b){ return a.second - a.first > b.second - b.first; });
+    std::vector<std::vector<DuplicateCandidate>> found (threads);
+    parallel(blocks.size(), threads, [&](size_t index, size_t thread){
+        std::vector<size_t> members;
+        for(size_t i = blocks[index].first; i < blocks[index].second; ++i)
+            members.push_back(entries[i].second);
+        size_t window = members.size();
+        if(members.size() > MAX_BLOCK){
+            window = WINDOW;
+            std::sort(members.begin(), members.end(), [&profiles](size_t a, size_t b){
+                return std::make_tuple(std::cref(profiles[a].name), profiles[a].birth.key()) < std::make_tuple(std::cref(profiles[b].name), profiles[b].birth.key());
+            });
+        }
+        for(size_t i = 0; i < members.size(); ++i){
+            for(size_t j = i + 1; j < std::min(members.size(), i + 1 + window); ++j){
+                const Profile& first = profiles[members[i]];
+                const Profile& second = profiles[members[j]];
+                double value = score(first, second);
+                if(value < threshold || related(kinship, first.id, second.id)) continue;
+                found[thread].push_back(DuplicateCandidate{std::min(first.id, second.id), std::max(first.id, second.id), value});
+            }
+        }
+    });
+    std::vector<DuplicateCandidate> candidates;
+    for(auto&& part : found)
+        candidates.insert(candidates.end(), part.begin(), part.end());
+    // Pairs sharing more blocks are found more times.
+    std::sort(candidates.begin(), candidates.end(), [](const DuplicateCandidate& a, const DuplicateCandidate& b){
+        return std::make_pair(a.first, a.second) < std::make_pair(b.first, b.second);
+    });
+    candidates.erase(std::unique(candidates.begin(), candidates.end(), [](const DuplicateCandidate& a, const DuplicateCandidate& b){
+        return a.first == b.first && a.second == b.second;
+    }), candidates.end());
+    std::stable_sort(candidates.begin(), candidates.end(), [](const DuplicateCandidate& a, const DuplicateCandidate& b){ return a.score > b.score; });
+    return candidates;
+}
+
+std::string duplicates::phonetic(const std::string& name){
+    // Codes of the letters from a to z, vowels are 0 and h is skipped.
+    static const std::string CODES = "0123012 022455012623011202";
+    std::string key;
+    char last = 0;
+    for(char c : search::normalize(name)){
+        if(c < 'a' || c > 'z' || CODES[c - 'a'] == ' ') continue;
+        char code = CODES[c - 'a'];
+        if(key.empty() || (code != last && code != '0')) key.push_back(code);
+        last = code;
+        if(key.size() == 5) break;
+    }
+    return key;
+}
+
+double duplicates::similarity(const std::string& first, const std::string& second){
+    if(first == second) return 1;
+    // Matched characters are marked in bit masks, so only the first 64 characters are compared.
+    size_t firstSize = std::min<size_t>(first.size(), 64);
+    size_t secondSize = std::min<size_t>(second.size(), 64);
+    if(firstSize == 0 || secondSize == 0) return 0;
+    size_t range = std::max(firstSize, secondSize) / 2;
+    range = range > 0 ? range - 1 : 0;
+    uint64_t firstMatched = 0;
+    uint64_t secondMatched = 0;
+    size_t matches = 0;
+    for(size_t i = 0; i < firstSize; ++i){
+        size_t end = std::min(secondSize, i + range + 1);
+        for(size_t j = i > range ? i - range : 0; j < end; ++j){
+            if((secondMatched >> j & 1) || first[i] != second[j]) continue;
+            firstMatched |= uint64_t(1) << i;
+            secondMatched |= uint64_t(1) << j;
+            ++matches;
+            break;
+        }
+    }
+    if(matches == 0) return 0;
+    size_t transpositions = 0;
+    for(size_t i = 0, j = 0; i < firstSize; ++i){
+        if(!(firstMatched >> i & 1)) continue;
+        while(!(secondMatched >> j & 1))
+            ++j;
+        if(first[i] != second[j++]) ++transpositions;
+    }
+    double m = matches;
+    double jaro = (m / firstSize + m / secondSize + (m - transpositions / 2.0) / m) / 3;
+    size_t prefix = 0;
+    while(prefix < 4 && prefix < firstSize && prefix < secondSize && first[prefix] == second[prefix])
+        ++prefix;
+    return jaro + prefix * 0.1 * (1 - jaro);
+}
@@ -0,0 +1,46 @@
+/// @file duplicate_detector.h Header file for the detection of persons recorded more times.
+#ifndef duplicate_detector_h_
+#define duplicate_detector_h_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "kinship_graph.h"
+#include "person.h"
+#include "record_map.h"
+
+/// Pair of persons which are probably the same person.
+struct DuplicateCandidate{
+    /// Id of the first person, which is the lower one.
+    size_t first;
+    /// Id of the second person.
+    size_t second;
+    /// Similarity of the persons from 0 to 1.
+    double score;
+};
+
+/// Namespace for everything with detection of duplicate persons.
+/// Only persons sharing a block are compared, blocks are made of persons with the same phonetic key of a surname born in the same two decades
+/// and of persons with the same phonetic keys of the name and of a surname. Big blocks are ordered and each person is compared only with its neighbours.
+namespace duplicates{
+    /// Minimum score of a reported pair by default.
+    constexpr double THRESHOLD = 0.8;
+    /// Find pairs of persons which are probably the same one. Blocks are compared on several threads.
+    /// @param persons Container of all persons.
+    /// @param kinship Graph of relatives of all persons, it has to be built.
+    /// @param threshold Minimum score of a reported pair.
+    /// @return Candidates for merging, the most similar first.
+    std::vector<DuplicateCandidate> find(const RecordMap<Person>& persons, const KinshipGraph& kinship, double threshold = THRESHOLD);
+    /// Phonetic key of the name, so names sounding alike get the same key. Letters sounding alike are replaced by the same digit,
+    /// vowels only separate them and the repeated ones are dropped, the first letter is coded too.
+    /// @param name Name in UTF-8.
+    /// @return Up to five digits, empty if the name has no Latin letter.
+    std::string phonetic(const std::string& name);
+    /// Similarity of two texts by Jaro-Winkler, which favours texts with a common beginning.
+    /// @param first First normalized text.
+    /// @param second Second normalized text.
+    /// @return Similarity from 0 to 1.
+    double similarity(const std::string& first, const std::string& second);
+}
+
+#endif
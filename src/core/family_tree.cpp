@@ -1,106 +1,398 @@
 /// @file family_tree.cpp Source file for Family tree.
 #include "family_tree.h"
 
+// =====================================================================
+// Parallel loading
+// =====================================================================
+
+namespace{
+    /// Records of one database file and if the file was read successfully.
+    template<typename T>
+    using LoadedRecords = std::pair<bool, std::vector<std::unique_ptr<T>>>;
+
+    /// Read and parse records of one database file on a worker thread.
+    /// @param parser Parser of the database.
+    /// @param file Which file in database is being loaded.
+    /// @param label Label of the array with records.
+    /// @param create Function creating one record from its JSON value.
+    /// @return Future with the loaded records.
+    template<typename T, typename Create>
+    std::future<LoadedRecords<T>> loadRecords(Parser& parser, const std::string& file, const std::string& label, Create create){
+        return std::async(std::launch::async, [&parser, file, label, create](){
+            LoadedRecords<T> loaded;
+            loaded.first = parser.readJSONRecords(file, label, [&loaded, &create](const Json::Value& value){
+                loaded.second.push_back(create(value));
+            });
+            return loaded;
+        });
+    }
+
+    /// Move loaded records to their container in the order they were read.
+    /// @param records Loaded records.
+    /// @param container Container of the family tree.
+    /// @param index Indexing of given container.
+    template<typename T>
+    void insertRecords(std::vector<std::unique_ptr<T>>& records, RecordMap<T>& container, size_t& index){
+        for(auto&& record : records){
+            size_t id = record->getId();
+            container.insert({id, std::move(record)});
+            index = index <= id ? id + 1 : index;
+        }
+    }
+
+    /// Decode records of one section of the binary image on a worker thread.
+    /// @param section Reader of the section.
+    /// @param create Function creating one empty record.
+    /// @return Future with the decoded records.
+    template<typename T, typename Create>
+    std::future<std::vector<std::unique_ptr<T>>> decodeRecords(BinaryReader section, Create create){
+        return std::async(std::launch::async, [section, create]() mutable{
+            std::vector<std::unique_ptr<T>> records (section.read<size_t>());
+            for(auto&& record : records){
+                record = create();
+                record->readBinary(section);
+            }
+            if(!section.atEnd()) throw std::runtime_error("Binary image does not match its format.");
+            return records;
+        });
+    }
+
+    /// Write all records of one container as a section of the binary image.
+    /// @param writer Writer of the image.
+    /// @param container Container of the family tree.
+    template<typename T>
+    void encodeRecords(BinaryWriter& writer, const RecordMap<T>& container){
+        size_t section = writer.beginSection();
+        writer.write(container.size());
+        for(auto&& [id, record] : container)
+            record->writeBinary(writer);
+        writer.endSection(section);
+    }
+
+    /// Copy records of the family tree, so they can be printed on another thread.
+    /// @param source Container of the family tree.
+    /// @param target Container of the snapshot.
+    /// @param ids Which records are copied, or all of them if it is empty.
+    /// @param copy Function copying one record.
+    template<typename T, typename Copy>
+    void copyRecords(const RecordMap<T>& source, RecordMap<T>& target, const std::set<size_t>* ids, Copy copy){
+        if(ids == nullptr){
+            for(auto&& [id, record] : source)
+                target.insert({id, copy(*record)});
+            return;
+        }
+        for(auto&& id : *ids){
+            auto it = source.find(id);
+            if(it != source.end()) target.insert({id, copy(*it->second)});
+        }
+    }
+
+    /// Add the record to the index of its template.
+    /// @param index Ids of records using each template.
+    /// @param record Indexed event or relation.
+    template<typename T>
+    void indexTemplate(std::map<size_t, std::set<size_t>>& index, const T& record){
+        index[record.getTemplate()].insert(record.getId());
+    }
+
+    /// Remove the record from the index of its template.
+    /// @param index Ids of records using each template.
+    /// @param record Event or relation, which is still in the index.
+    template<typename T>
+    void unindexTemplate(std::map<size_t, std::set<size_t>>& index, const T& record){
+        auto it = index.find(record.getTemplate());
+        if(it == index.end()) return;
+        it->second.erase(record.getId());
+        if(it->second.empty()) index.erase(it);
+    }
+
+    /// Remove the record from its container and from the index of templates.
+    /// @param container Container of the family tree.
+    /// @param index Ids of records using each template.
+    /// @param id Id of the removed record.
+    template<typename T>
+    void eraseIndexed(RecordMap<T>& container, std::map<size_t, std::set<size_t>>& index, size_t id){
+        auto it = container.find(id);
+        if(it == container.end()) return;
+        unindexTemplate(index, *it->second);
+        container.erase(it);
+    }
+
+    /// Create file meta-data from its JSON value.
+    /// @param value Loaded record of the file.
+    /// @return New file.
+    std::unique_ptr<File> createFile(const Json::Value& value){
+        auto f = std::make_unique<File>();
+        f->readJson(value);
+        return f;
+    }
+
+    /// Print all records of one container in the format of the database file.
+    /// @param os Given output stream.
+    /// @param container Printed container.
+    /// @param label What is the label in JSON file.
+    template<typename T>
+    void printRecords(std::ostream& os, const RecordMap<T>& container, const std::string& label){
+        os << "{\"" << label << "\":[";
+        bool first = true;
+        for(auto&& [id, record] : container){
+            if(!first) os << ",";
+            first = false;
+            os << (*record);
+        }
+        os << "]}";
+    }
+
+    /// Print one record of the container.
+    /// @param os Given output stream.
+    /// @param container Container holding the record.
+    /// @param id Id of the record.
+    /// @return False if there is no such record.
+    template<typename T>
+    bool printRecord(std::ostream& os, const RecordMap<T>& container, size_t id){
+        auto it = container.find(id);
+        if(it == container.end()) return false;
+        os << (*it->second);
+        return true;
+    }
+}
+
+// =====================================================================
+// Database snapshot
+// =====================================================================
+
+bool DatabaseSnapshot::foldJournal(Parser& parser) const{
+    // Last text of each record in the journal by the labels of the files, removed records have empty text.
+    std::map<std::string, std::map<size_t, std::string>> changes;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader (builder.newCharReader());
+    bool read = parser.readJournalLines([&changes, &reader](std::string_view line){
+        Json::Value value;
+        if(!reader->parse(line.data(), line.data() + line.size(), &value, nullptr)) return;
+        std::string& text = changes[value[jsonlabel::JOURNAL_FILE].asString()][value[jsonlabel::ID].asUInt64()];
+        std::string_view record;
+        JsonRecordReader recordReader (line.data(), line.data() + line.size());
+        if(!value[jsonlabel::REMOVED].asBool() && recordReader.readMember(jsonlabel::RECORD, record)) text = record;
+        else text.clear();
+    });
+    if(!read) return false;
+    std::set<std::string> kept;
+    for(auto&& [label, records] : changes){
+        auto file = std::find_if(std::begin(database::AllFiles), std::end(database::AllFiles), [&label](DatabaseFile file){return database::label(file) == label;});
+        // Files rewritten from the snapshot already contain the records.
+        if(file != std::end(database::AllFiles) && unsavedFiles.count(*file)) continue;
+        if(file == std::end(database::AllFiles) || damagedFiles.count(*file) || !parser.rewriteRecords(database::path(*file), label, records))
+            kept.insert(label);
+    }
+    if(kept.empty()){
+        parser.clearJournal();
+        return true;
+    }
+    return parser.filterJournal([&kept](const Json::Value& record){return kept.count(record[jsonlabel::JOURNAL_FILE].asString()) > 0;});
+}
+
+void DatabaseSnapshot::printFile(std::ostream& os, DatabaseFile file) const{
+    switch(file){
+        case DB_PERSONS:
+            printRecords(os, persons, jsonlabel::PERSONS);
+            break;
+        case DB_FILES:
+            printRecords(os, files, jsonlabel::FILES);
+            break;
+        case DB_MEDIA:
+            printRecords(os, media, jsonlabel::MEDIA);
+            break;
+        case DB_NOTES:
+            printRecords(os, notes, jsonlabel::NOTES);
+            break;
+        case DB_CONFIG:
+            os << settings;
+            break;
+        case DB_RELATIONS:
+            printRecords(os, relations, jsonlabel::RELATIONS);
+            break;
+        case DB_EVENTS:
+            printRecords(os, events, jsonlabel::EVENTS);
+            break;
+    }
+}
+
+bool DatabaseSnapshot::printRecord(std::ostream& os, DatabaseFile file, size_t id) const{
+    switch(file){
+        case DB_PERSONS:
+            return ::printRecord(os, persons, id);
+        case DB_FILES:
+            return ::printRecord(os, files, id);
+        case DB_MEDIA:
+            return ::printRecord(os, media, id);
+        case DB_NOTES:
+            return ::printRecord(os, notes, id);
+        case DB_RELATIONS:
+            return ::printRecord(os, relations, id);
+        case DB_EVENTS:
+            return ::printRecord(os, events, id);
+        case DB_CONFIG:
+        default:
+            return false;
+    }
+}
+
+bool DatabaseSnapshot::write(Parser& parser) const{
+    if(!unsavedRecords.empty()){
+        std::stringstream journal;
+        for(auto&& [file, ids] : unsavedRecords){
+            if(file == DB_CONFIG) continue; // Config is always written as a whole.
+            for(auto&& id : ids){
+                // Records are printed on a single line, because the journal is read line by line.
+                journal << "{\"" << jsonlabel::JOURNAL_FILE << "\":" << JsonString(database::label(file));
+                journal << ",\"" << jsonlabel::ID << "\":" << id << ",\"";
+                std::stringstream record;
+                if(printRecord(record, file, id))
+                    journal << jsonlabel::RECORD << "\":" << record.rdbuf();
+                else journal << jsonlabel::REMOVED << "\":true";
+                journal << "}\n";
+            }
+        }
+        // Journal has to match the data before the files are rewritten, so replaying it after an interruption is harmless.
+        // The folded files are also built from it.
+        if(!parser.appendJournal(journal.str())) return false;
+    }
+    bool success = parser.writeJSON(database::path(DB_CONFIG), [this](std::ostream& os){printFile(os, DB_CONFIG);});
+    if(!compact) return success;
+    for(auto&& file : unsavedFiles){
+        if(file == DB_CONFIG) continue;
+        success = parser.writeJSON(database::path(file), [this, file](std::ostream& os){printFile(os, file);}) && success;
+    }
+    // Until all the files are written, the journal is the only record of the changes.
+    return success && foldJournal(parser);
+}
+
 // =====================================================================
 // Family tree
 // =====================================================================
 
-FamilyTree::FamilyTree() : event_index_(1), file_index_(1), mainPerson_(nullptr), media_index_(1), note_index_(1), person_index_(1), relation_index_(1), savedChanges_(true){
+FamilyTree::FamilyTree() : event_index_(1), file_index_(1), mainPerson_(nullptr), media_index_(1), note_index_(1), person_index_(1), relation_index_(1){
     auto [help, paths] = parser_.readConfig();
     openHelp = help;
     projectPaths = std::move(paths);
 }
 
+FamilyTree::~FamilyTree(){
+    finishSave();
+}
+
 Event* FamilyTree::addEvent(){
     allEvents_.insert({event_index_, std::make_unique<Event>(&settings_)});
     allEvents_.at(event_index_)->setId(event_index_);
-    savedChanges_ = false;
+    indexTemplate(eventsByTemplate_, *allEvents_.at(event_index_));
+    setUnsaved(DB_EVENTS, event_index_);
     return allEvents_.at(event_index_++).get();
 }
 
 Event* FamilyTree::addEvent(size_t index){
     allEvents_.insert({index, std::make_unique<Event>(&settings_)});
     allEvents_.at(index)->setId(index);
-    savedChanges_ = false;
+    indexTemplate(eventsByTemplate_, *allEvents_.at(index));
+    setUnsaved(DB_EVENTS, index);
     return allEvents_.at(index).get();
 }
 
 File* FamilyTree::addFile(const std::string& name, FileType type){
-    savedChanges_ = false;
+    loadFiles();
     switch (type){
         case MEDIA:
             allMedia_.insert({media_index_, std::make_unique<File>()});
             allMedia_.at(media_index_)->setId(media_index_);
             allMedia_.at(media_index_)->setFilename(name);
+            fileReferences_[MEDIA].addFile(media_index_);
+            setUnsaved(DB_MEDIA, media_index_);
             return allMedia_.at(media_index_++).get();
         case NOTE:
             allNotes_.insert({note_index_, std::make_unique<File>()});
             allNotes_.at(note_index_)->setId(note_index_);
             allNotes_.at(note_index_)->setFilename(name);
+            fileReferences_[NOTE].addFile(note_index_);
+            setUnsaved(DB_NOTES, note_index_);
             return allNotes_.at(note_index_++).get();
         case GENERAL_FILE:
         default:
             allFiles_.insert({file_index_, std::make_unique<File>()});
             allFiles_.at(file_index_)->setId(file_index_);
             allFiles_.at(file_index_)->setFilename(name);
+            fileReferences_[GENERAL_FILE].addFile(file_index_);
+            setUnsaved(DB_FILES, file_index_);
             return allFiles_.at(file_index_++).get();
     }
 }
 
 File* FamilyTree::addFile(const std::string& name, size_t index, FileType type){
-    savedChanges_ = false;
+    loadFiles();
     switch (type){
         case MEDIA:
             allMedia_.insert({index, std::make_unique<File>()});
             allMedia_.at(index)->setId(index);
             allMedia_.at(index)->setFilename(name);
+            fileReferences_[MEDIA].addFile(index);
+            setUnsaved(DB_MEDIA, index);
             return allMedia_.at(index).get();
         case NOTE:
             allNotes_.insert({index, std::make_unique<File>()});
             allNotes_.at(index)->setId(index);
             allNotes_.at(index)->setFilename(name);
+            fileReferences_[NOTE].addFile(index);
+            setUnsaved(DB_NOTES, index);
             return allNotes_.at(index).get();
         case GENERAL_FILE:
         default:
             allFiles_.insert({index, std::make_unique<File>()});
             allFiles_.at(index)->setId(index);
             allFiles_.at(index)->setFilename(name);
+            fileReferences_[GENERAL_FILE].addFile(index);
+            setUnsaved(DB_FILES, index);
             return allFiles_.at(index).get();
     }
 }
 
 Person* FamilyTree::addPerson(){
-    savedChanges_ = false;
+    setUnsaved(DB_PERSONS, person_index_);
+    kinship_.invalidate();
 	allPersons_.insert({person_index_, std::make_unique<Person>()});
 	allPersons_.at(person_index_)->setId(person_index_);
+	referenceFiles(*allPersons_.at(person_index_), true);
 	mainPerson_ = allPersons_.at(person_index_).get();
 	return allPersons_.at(person_index_++).get();
 }
 
 Person* FamilyTree::addPerson(size_t index){
-    savedChanges_ = false;
+    setUnsaved(DB_PERSONS, index);
+    kinship_.invalidate();
 	allPersons_.insert({index, std::make_unique<Person>()});
 	allPersons_.at(index)->setId(index);
+	referenceFiles(*allPersons_.at(index), true);
 	mainPerson_ = allPersons_.at(index).get();
 	return allPersons_.at(index).get();
 }
 
 Relation* FamilyTree::addRelation(){
-    savedChanges_ = false;
+    setUnsaved(DB_RELATIONS, relation_index_);
     allRelations_.insert({relation_index_, std::make_unique<Relation>(&settings_)});
     allRelations_.at(relation_index_)->setId(relation_index_);
+    indexTemplate(relationsByTemplate_, *allRelations_.at(relation_index_));
     return allRelations_.at(relation_index_++).get();
 }
 
 Relation* FamilyTree::addRelation(size_t index){
-    savedChanges_ = false;
+    setUnsaved(DB_RELATIONS, index);
     allRelations_.insert({index, std::make_unique<Relation>(&settings_)});
     allRelations_.at(index)->setId(index);
+    indexTemplate(relationsByTemplate_, *allRelations_.at(index));
     return allRelations_.at(index).get();
 }
 
 void FamilyTree::append(FamilyTree& other){
-    savedChanges_ = false;
+    loadFiles();
+    // Appended records mark themselves as unsaved, so the next save copies only them.
+    setUnsaved(DB_CONFIG);
     auto [eventPlus, relPlus] = settings_.indexes();
     --eventPlus;
     --relPlus;
@@ -122,31 +414,27 @@ void FamilyTree::append(FamilyTree& other){
         relTemplates.insert({id + relPlus, realId});
     }
     std::string absolutePath;
-    std::string filename;
     for(auto&& [id, file] : other.getFiles(GENERAL_FILE)){
         other.getFileAbsolutePath(absolutePath, id, GENERAL_FILE);
-        bool success = parser_.copyFile(absolutePath, parser::FILES_DIR, filename, id + plusFile);
-        if(success){
-            File* f = addFile(filename, id + plusFile, GENERAL_FILE);
-            f->setId(id + plusFile);
+        auto optFile = storeFile(absolutePath, id + plusFile, GENERAL_FILE);
+        if(optFile){
+            File* f = *optFile;
             file_index_ = file_index_ < f->getId() ? f->getId() + 1 : file_index_;
         }
     }
     for(auto&& [id, media] : other.getFiles(MEDIA)){
         other.getFileAbsolutePath(absolutePath, id, MEDIA);
-        bool success = parser_.copyFile(absolutePath, parser::MEDIA_DIR, filename, id + plusMedia);
-        if(success){
-            File* f = addFile(filename, id + plusMedia, MEDIA);
-            f->setId(id + plusMedia);
+        auto optFile = storeFile(absolutePath, id + plusMedia, MEDIA);
+        if(optFile){
+            File* f = *optFile;
             media_index_ = media_index_ < f->getId() ? f->getId() + 1 : media_index_;
         }
     }
     for(auto&& [id, note] : other.getFiles(NOTE)){
         other.getFileAbsolutePath(absolutePath, id, NOTE);
-        bool success = parser_.copyFile(absolutePath, parser::NOTES_DIR, filename, id + plusNote);
-        if(success){
-            File* f = addFile(filename, id + plusNote, NOTE);
-            f->setId(id + plusNote);
+        auto optFile = storeFile(absolutePath, id + plusNote, NOTE);
+        if(optFile){
+            File* f = *optFile;
             note_index_ = note_index_ < f->getId() ? f->getId() + 1 : note_index_;
         }
     }
@@ -156,7 +444,7 @@ void FamilyTree::append(FamilyTree& other){
         newEvent->setDate() = event->getDate();
         newEvent->setText(event->getText());
         newEvent->setPlace(event->getPlace());
-        newEvent->setTemplate(eventTemplates.at(event->getTemplate() + eventPlus));
+        setEventTemplate(newEvent->getId(), eventTemplates.at(event->getTemplate() + eventPlus));
         for(auto&& [role, person] : event->getPersons())
             newEvent->addPerson(person + plusPerson, role);
         event_index_ = event_index_ < newEvent->getId() ? newEvent->getId() + 1 : event_index_;
@@ -164,7 +452,7 @@ void FamilyTree::append(FamilyTree& other){
     for(auto&& [id, rel] : other.getRelations()){
         Relation* newRel = addRelation(id + plusRel);
         newRel->setId(id + plusRel);
-        newRel->setTemplate(relTemplates.at(rel->getTemplate() + relPlus));
+        setRelationTemplate(newRel->getId(), relTemplates.at(rel->getTemplate() + relPlus));
         newRel->setPersons(rel->getFirstPerson() + plusPerson, rel->getSecondPerson() + plusPerson);
         relation_index_ = relation_index_ < newRel->getId() ? newRel->getId() + 1 : relation_index_;
     }
@@ -178,14 +466,14 @@ void FamilyTree::append(FamilyTree& other){
         p->birthDate()->setSecondDate(date.getYear(), date.getMonth(), date.getDay());
         p->birthDate()->setText() = person->getBirthDate().getText();
         p->birthDate()->updateDate();
-        p->setBirthPlace() = person->getBirthPlace();
+        p->setBirthPlace(person->getBirthPlace());
         date = person->getDeathDate().getFirstDate();
         p->deathDate()->setFirstDate(date.getYear(), date.getMonth(), date.getDay());
         date = person->getDeathDate().getSecondDate();
         p->deathDate()->setSecondDate(date.getYear(), date.getMonth(), date.getDay());
         p->deathDate()->setText() = person->getDeathDate(). getText();
         p->deathDate()->updateDate();
-        p->setDeathPlace() = person->getDeathPlace();
+        p->setDeathPlace(person->getDeathPlace());
         p->setFather(person->getFather() == 0 ? 0 : person->getFather() + plusRel);
         p->setFrontTitle(person->getFrontTitle());
         p->setGender(person->getGender());
@@ -204,6 +492,7 @@ void FamilyTree::append(FamilyTree& other){
             p->addTag(tag, value);
             settings_.addTag(tag);
         }
+        tagIndex_.update(*p);
         p->setFilesRoot(person->getFilesRoot(GENERAL_FILE), GENERAL_FILE, plusFile);
         p->setFilesRoot(person->getFilesRoot(MEDIA), MEDIA, plusMedia);
         p->setFilesRoot(person->getFilesRoot(NOTE), NOTE, plusNote);
@@ -211,6 +500,21 @@ void FamilyTree::append(FamilyTree& other){
     }
 }
 
+std::string FamilyTree::cacheKey(){
+    BinaryWriter key;
+    key.write(cache::VERSION);
+    for(auto&& file : {parser::JSON_PERSONS, parser::JSON_EVENTS, parser::JSON_RELATIONS}){
+        if(!parser_.fingerprint(file, key)) return EMPTY_STRING;
+    }
+    // Events are read according to their templates, so the image is valid only for the same templates.
+    std::stringstream templates;
+    for(auto&& [id, templ] : settings_.getEventTemplates())
+        templates << id << (*templ);
+    std::string printed = templates.str();
+    key.write(cache::hash(printed.data(), printed.size()));
+    return key.data();
+}
+
 std::pair<bool, std::string> FamilyTree::checkFileConsistence(){
     std::stringstream ss;
     bool problem = false;
@@ -221,6 +525,7 @@ std::pair<bool, std::string> FamilyTree::checkFileConsistence(){
 }
 
 bool FamilyTree::checkFileTypeConsistence(std::ostream& os, FileType type){
+    loadFiles();
     std::string directory;
     std::set<std::string> database;
     std::vector<std::string> found;
@@ -259,12 +564,24 @@ bool FamilyTree::checkFileTypeConsistence(std::ostream& os, FileType type){
 }
 
 void FamilyTree::clear(){
+    finishSave();
     allRelations_.clear();
     allEvents_.clear();
     allFiles_.clear();
     allMedia_.clear();
     allNotes_.clear();
     allPersons_.clear();
+    pendingFiles_.clear();
+    eventsByTemplate_.clear();
+    relationsByTemplate_.clear();
+    fileReferences_.clear();
+    dates_.invalidate();
+    kinship_.invalidate();
+    relationships_.invalidate();
+    inbreeding_.invalidate();
+    personIndex_.invalidate();
+    tagIndex_.clear();
+    pendingFileRecords_.clear();
     event_index_ = 1;
     relation_index_ = 1;
     file_index_ = 1;
@@ -274,7 +591,9 @@ void FamilyTree::clear(){
     mainPerson_ = nullptr;
     settings_.clear();
     parser_.clear();
-    savedChanges_ = true;
+    unsavedFiles_.clear();
+    unsavedRecords_.clear();
+    damagedFiles_.clear();
 }
 
 void FamilyTree::clearProjectPaths(){
@@ -282,24 +601,29 @@ void FamilyTree::clearProjectPaths(){
     parser_.writeConfig(openHelp);
 }
 
+bool FamilyTree::compactDatabase(){
+    finishSave();
+    return startSave(true, nullptr) && finishSave();
+}
+
 size_t FamilyTree::copyFile(const std::string& filePath, FileType type){
-    std::string fileName;
-    bool success;
+    loadFiles();
+    size_t index;
     switch (type){
         case MEDIA:
-            success = parser_.copyFile(filePath, parser::MEDIA_DIR, fileName, media_index_);
+            index = media_index_++;
             break;
         case NOTE:
-            success = parser_.copyFile(filePath, parser::NOTES_DIR, fileName, note_index_);
+            index = note_index_++;
             break;
         case GENERAL_FILE:
         default:
-            success = parser_.copyFile(filePath, parser::FILES_DIR, fileName, file_index_);
+            index = file_index_++;
             break;
     }
-    if(success){
-        const auto file = addFile(fileName, type);
-        return file->getId();
+    auto optFile = storeFile(filePath, index, type);
+    if(optFile){
+        return (*optFile)->getId();
     }
     return 0;
 }
@@ -321,7 +645,9 @@ size_t FamilyTree::createEmptyFile(const std::string& name, FileType type){
 }
 
 void FamilyTree::createDatabase(const std::string& dirPath){
+	finishSave();
 	parser_.makeNewDatabase(dirPath);
+	setUnsaved();
 	storeDatabase();
 }
 
@@ -334,55 +660,100 @@ void FamilyTree::enableHelpOnStartup(bool help){
     parser_.writeConfig(projectPaths, help);
 }
 
+bool FamilyTree::eraseFile(RecordMap<File>& container, FileType type, size_t id){
+    auto it = container.find(id);
+    if(it == container.end()) return false;
+    FileReferences& references = fileReferences_[type];
+    bool unused = references.removeBlob(it->second->getBlob());
+    references.removeFile(id);
+    container.erase(it);
+    return unused;
+}
+
 void FamilyTree::exportTemplates(const std::vector<size_t>& eventTemplates, const std::vector<size_t>& relTemplates, const std::string& filename){
-    std::stringstream ss;
-    settings_.exportTemplates(ss, relTemplates, eventTemplates);
-    parser_.writeJSON(ss.str(), filename, false);
+    parser_.writeJSON(filename, [&](std::ostream& os){settings_.exportTemplates(os, relTemplates, eventTemplates);}, false);
 }
 
 void FamilyTree::exportProject(const std::string& filePath, bool includingEvents, bool includingRelations){
-    std::stringstream ss;
-    ss << "{\"" << jsonlabel::EXPORT << "\":";
-    ss << "{\"" << jsonlabel::PERSONS << "\":[";
-    bool first = true;
-    for(auto&& [id, pPerson] : allPersons_){
-		if(!first) ss << ",";
-		first = false;
-		pPerson->exportJson(ss, includingEvents, includingRelations);
-	}
-	ss << "]";
-	std::set<size_t> eventTemplates;
-	if(includingEvents){
-        ss << ",\"" << jsonlabel::EVENTS << "\":[";
-        first = true;
-        for(auto&& [id, event] : allEvents_){
-            if(!first) ss << ",";
-            first = false;
-            ss << (*event);
-            eventTemplates.insert(event->getTemplate());
-        }
-        ss << "]";
-	}
-	std::set<size_t> relTemplates;
-	if(includingRelations){
-        ss << ",\"" << jsonlabel::RELATIONS << "\":[";
-        first = true;
-        for(auto&& [id, rel] : allRelations_){
-            if(!first) ss << ",";
-            first = false;
-            ss << (*rel);
-            relTemplates.insert(rel->getTemplate());
-        }
-        ss << "]";
-	}
-    std::vector<size_t> events(eventTemplates.begin(), eventTemplates.end());
-    std::vector<size_t> rels(relTemplates.begin(), relTemplates.end());
-    if(events.size() > 0 || rels.size() > 0){
-        ss << ",\"" << jsonlabel::TEMPLATES << "\":";
-        settings_.exportTemplates(ss, rels, events);
+    parser_.writeJSON(filePath, [&](std::ostream& os){printExport(os, includingEvents, includingRelations);}, false);
+}
+
+std::optional<std::vector<Kinship>> FamilyTree::findConnection(size_t first, size_t second){
+    return getKinship().findPath(first, second);
+}
+
+std::span<const DatedRecord> FamilyTree::findDates(DateKind kind, const Date& from, const Date& to){
+    dates_.refresh(allPersons_, allEvents_, settings_);
+    return dates_.find(kind, from, to);
+}
+
+std::vector<DuplicateCandidate> FamilyTree::findDuplicates(double threshold){
+    return duplicates::find(allPersons_, getKinship(), threshold);
+}
+
+double FamilyTree::findInbreeding(size_t person){
+    return getInbreeding().findInbreeding(person);
+}
+
+std::vector<double> FamilyTree::findInbreedings(const std::vector<size_t>& persons){
+    return getInbreeding().findInbreedings(persons);
+}
+
+double FamilyTree::findKinship(size_t first, size_t second){
+    return getInbreeding().findKinship(first, second);
+}
+
+std::vector<std::vector<double>> FamilyTree::findKinships(const std::vector<size_t>& persons){
+    return getInbreeding().findKinships(persons);
+}
+
+std::vector<CollapsedGeneration> FamilyTree::findPedigreeCollapse(size_t person, int generations){
+    return getInbreeding().findCollapse(person, generations);
+}
+
+std::vector<size_t> FamilyTree::findPersons(const std::string& query, size_t limit){
+    personIndex_.refresh(allPersons_);
+    return personIndex_.find(query, limit);
+}
+
+std::vector<size_t> FamilyTree::findPersonsWithTag(const std::string& tag){
+    return tagIndex_.find(tag);
+}
+
+std::vector<size_t> FamilyTree::findPersonsWithTag(const std::string& tag, const std::string& value){
+    return tagIndex_.find(tag, value);
+}
+
+Relationship FamilyTree::findRelationship(size_t first, size_t second){
+    if(!relationships_.isValid())
+        relationships_.build(allPersons_, getKinship());
+    return relationships_.find(first, second);
+}
+
+std::map<size_t, Relationship> FamilyTree::findRelationships(size_t proband){
+    if(!relationships_.isValid())
+        relationships_.build(allPersons_, getKinship());
+    return relationships_.findAll(proband);
+}
+
+bool FamilyTree::finishSave(){
+    if(cacheTask_.valid()) cacheTask_.get();
+    if(!saveTask_.valid()) return true;
+    bool success = saveTask_.get();
+    if(!success){
+        // Changes from the snapshot are returned back, so they are stored by the next save. Records written to the journal again replace themselves.
+        unsavedFiles_.insert(saveSnapshot_->unsavedFiles.begin(), saveSnapshot_->unsavedFiles.end());
+        for(auto&& [file, ids] : saveSnapshot_->unsavedRecords)
+            unsavedRecords_[file].insert(ids.begin(), ids.end());
+        log("Database could not be stored.");
     }
-    ss << "}}";
-    parser_.writeJSON(ss.str(), filePath, false);
+    saveSnapshot_.reset();
+    return success;
+}
+
+std::span<const DatedRecord> FamilyTree::getDates(DateKind kind){
+    dates_.refresh(allPersons_, allEvents_, settings_);
+    return dates_.getRecords(kind);
 }
 
 std::optional<Event*> FamilyTree::getEvent(size_t id){
@@ -390,15 +761,16 @@ std::optional<Event*> FamilyTree::getEvent(size_t id){
         return allEvents_.at(id).get();
     std::stringstream ss;
     ss << "Given event with id " << id << " is not present in databse.";
-    parser_.log(ss.str());
+    parser_.log(ss.str(), LOG_WARNING);
     return {};
 }
 
-const std::map<size_t, std::unique_ptr<Event>>& FamilyTree::getEvents() const{
+const RecordMap<Event>& FamilyTree::getEvents() const{
     return allEvents_;
 }
 
 std::optional<File*> FamilyTree::getFile(size_t id, FileType type){
+    loadFiles();
     switch(type){
         case MEDIA:
             if(allMedia_.contains(id))
@@ -406,7 +778,7 @@ std::optional<File*> FamilyTree::getFile(size_t id, FileType type){
             else{
                 std::stringstream ss;
                 ss << "Given media with id " << id << " is not present in databse.";
-                parser_.log(ss.str());
+                parser_.log(ss.str(), LOG_WARNING);
                return {};
             }
         case NOTE:
@@ -415,7 +787,7 @@ std::optional<File*> FamilyTree::getFile(size_t id, FileType type){
             else{
                 std::stringstream ss;
                 ss << "Given note with id " << id << " is not present in databse.";
-                parser_.log(ss.str());
+                parser_.log(ss.str(), LOG_WARNING);
                return {};
             }
         case GENERAL_FILE:
@@ -425,7 +797,7 @@ std::optional<File*> FamilyTree::getFile(size_t id, FileType type){
             else{
                 std::stringstream ss;
                 ss << "Given file with id " << id << " is not present in databse.";
-                parser_.log(ss.str());
+                parser_.log(ss.str(), LOG_WARNING);
                return {};
             }
     }
@@ -450,7 +822,8 @@ void FamilyTree::getFileAbsolutePath(std::string& absolutePath, size_t id, FileT
         absolutePath = parser_.getAbsoluteFilePath(*dir, (*optFile)->getRealName());
 }
 
-const std::map<size_t, std::unique_ptr<File>>& FamilyTree::getFiles(FileType type){
+const RecordMap<File>& FamilyTree::getFiles(FileType type){
+    loadFiles();
     switch(type){
         case MEDIA:
             return allMedia_;
@@ -462,24 +835,25 @@ const std::map<size_t, std::unique_ptr<File>>& FamilyTree::getFiles(FileType typ
     }
 }
 
-void FamilyTree::getGeneralOrphaFiles(std::vector<std::string>& files, const std::map<size_t, std::unique_ptr<File>>& container, FileType type){
-    std::map<size_t, bool> usedFiles;
-    for(auto&& [id, file] : container)
-        usedFiles.insert({id, false});
-    for(auto&& [id, person] : allPersons_){
-        std::vector<size_t> used;
-        person->getFilesRoot(type).usedFiles(used);
-        for(auto&& fileId : used){
-            usedFiles[fileId] = true;
-        }
-    }
-    for(auto&& [id, used] : usedFiles){
-        if(!used){
-            auto optFile = getFile(id, type);
-            if(optFile){
-                files.push_back((*optFile)->getRealName());
-            }
-        }
+const KinshipGraph& FamilyTree::getKinship(){
+    if(!kinship_.isValid())
+        kinship_.build(allPersons_, allRelations_, settings_);
+    return kinship_;
+}
+
+InbreedingCalculator& FamilyTree::getInbreeding(){
+    if(inbreeding_.isValid()) return inbreeding_;
+    if(!relationships_.isValid())
+        relationships_.build(allPersons_, getKinship());
+    inbreeding_.build(allPersons_, relationships_);
+    return inbreeding_;
+}
+
+void FamilyTree::getGeneralOrphaFiles(std::vector<std::string>& files, const RecordMap<File>& container, FileType type){
+    for(auto&& id : fileReferences_[type].getOrphans()){
+        auto it = container.find(id);
+        if(it != container.end())
+            files.push_back(it->second->getRealName());
     }
 }
 
@@ -493,12 +867,12 @@ std::optional<Person*> FamilyTree::getPerson(size_t id){
     else{
         std::stringstream ss;
         ss << "Given person with id " << id << " is not present in database.";
-        parser_.log(ss.str());
+        parser_.log(ss.str(), LOG_WARNING);
         return {};
     }
 }
 
-const std::map<size_t, std::unique_ptr  <Person>>& FamilyTree::getPersons(){
+const RecordMap<Person>& FamilyTree::getPersons(){
 	return allPersons_;
 }
 
@@ -512,127 +886,19 @@ std::optional<Relation*> FamilyTree::getRelation(size_t id){
     else{
         std::stringstream ss;
         ss << "Given relation with id " << id << " is not present in databse.";
-        parser_.log(ss.str());
+        parser_.log(ss.str(), LOG_WARNING);
         return {};
     }
 }
 
-const std::map<size_t, std::unique_ptr<Relation>>& FamilyTree::getRelations(){
+const RecordMap<Relation>& FamilyTree::getRelations(){
     return allRelations_;
 }
 
-void FamilyTree::getParentSuggestions(std::vector<RelationSuggestion>& suggestions, const Person* parent, const Person* child, size_t id, Trait trait,
-                                      const std::set<size_t>& forbiddenPersonParent, const std::set<size_t>& forbiddenPersonChild){
-    for(auto&& relId : parent->getRelations()){
-        auto optRel = getRelation(relId);
-        if(!optRel || relId == id) continue;
-        Trait t = (*optRel)->getTrait();
-        if(forbiddenPersonChild.contains((*optRel)->getTheOtherPerson(parent->getId()))) continue;
-        switch(t){
-            case Partnership: // second parent
-                suggestions.push_back(RelationSuggestion(child->getId(), (*optRel)->getTheOtherPerson(parent->getId()), false, false, trait == Motherhood ? Fatherhood : Motherhood));
-                break;
-            case Motherhood:
-            case Fatherhood:
-                if((*optRel)->isParent(parent->getId())) // Sibling
-                    suggestions.push_back(RelationSuggestion(child->getId(), (*optRel)->getTheOtherPerson(parent->getId()), false, true, Sibling));
-                break;
-            default:
-                continue;
-        }
-    }
-    for(auto&& relId : child->getRelations()){
-        auto optRel = getRelation(relId);
-        if(!optRel || relId == id) continue;
-        Trait t = (*optRel)->getTrait();
-        if(forbiddenPersonParent.contains((*optRel)->getTheOtherPerson(child->getId()))) continue;
-        switch(t){
-            case Sibling: // add childs
-                suggestions.push_back(RelationSuggestion(parent->getId(), (*optRel)->getTheOtherPerson(child->getId()), true, false, trait));
-                break;
-            case Motherhood:
-            case Fatherhood:
-                if(!(*optRel)->isParent(child->getId())) // add partners
-                    suggestions.push_back(RelationSuggestion(parent->getId(), (*optRel)->getTheOtherPerson(child->getId()), false, true, Partnership));
-                break;
-            default:
-                continue;
-        }
-    }
-}
-
-void FamilyTree::getPartnersSuggestions(std::vector<RelationSuggestion>& suggestions, const Person* person, const Person* second, size_t id, const std::set<size_t>& forbiddenPersons){
-    for(auto&& relId : person->getRelations()){
-        auto optRel = getRelation(relId);
-        if(optRel && relId != id){
-            if(forbiddenPersons.contains((*optRel)->getTheOtherPerson(person->getId()))) continue;
-            Trait t = (*optRel)->getTrait();
-            if((t == Motherhood || t == Fatherhood) && (*optRel)->isParent(person->getId()))
-                suggestions.push_back(RelationSuggestion(second->getId(), (*optRel)->getTheOtherPerson(person->getId()), true, false, t));
-        }
-    }
-}
-
-void FamilyTree::getSiblingsSuggestions(std::vector<RelationSuggestion>& suggestions, const Person* person, const Person* second, size_t id, const std::set<size_t>& forbiddenPersons){
-    for(auto&& relId : person->getRelations()){
-        auto optRel = getRelation(relId);
-        if(optRel && relId != id){
-            if(forbiddenPersons.contains((*optRel)->getTheOtherPerson(person->getId()))) continue;
-            Trait t = (*optRel)->getTrait();
-            if((t == Motherhood || t == Fatherhood) && !(*optRel)->isParent(mainPerson_->getId()))
-                suggestions.push_back(RelationSuggestion(second->getId(), (*optRel)->getTheOtherPerson(person->getId()), false, false, t));
-        }
-    }
-}
-
-
 std::vector<RelationSuggestion> FamilyTree::getRelationSuggestions(size_t relId){
-    std::vector<RelationSuggestion> suggestions;
     auto optRel = getRelation(relId);
-    if(!optRel || mainPerson_ == nullptr) return suggestions;
-    Relation* rel = *optRel;
-    auto optSecPers = getPerson(rel->getTheOtherPerson(mainPerson_->getId()));
-    if(!optSecPers) return suggestions;
-    Person* secondPerson = *optSecPers;
-    Trait trait = rel->getTrait();
-    std::set<size_t> forbiddenFirstPersons;
-    std::set<size_t> forbiddenSecondPersons;
-    for(auto&& relIds : mainPerson_->getRelations()){
-        auto optRel_t = getRelation(relIds);
-        if(optRel_t) forbiddenFirstPersons.insert((*optRel_t)->getTheOtherPerson(mainPerson_->getId()));
-    }
-    forbiddenFirstPersons.insert(mainPerson_->getId());
-    for(auto&& relIds : secondPerson->getRelations()){
-        auto optRel_t = getRelation(relIds);
-        if(optRel_t) forbiddenSecondPersons.insert((*optRel_t)->getTheOtherPerson(secondPerson->getId()));
-    }
-    forbiddenSecondPersons.insert(secondPerson->getId());
-    switch(trait){
-        case Motherhood:
-            if(rel->isParent(mainPerson_->getId()))
-                getParentSuggestions(suggestions, mainPerson_, secondPerson, relId, Motherhood, forbiddenFirstPersons, forbiddenSecondPersons);
-            else
-                getParentSuggestions(suggestions, secondPerson, mainPerson_, relId, Motherhood, forbiddenSecondPersons, forbiddenFirstPersons);
-            break;
-        case Fatherhood:
-            if(rel->isParent(mainPerson_->getId()))
-                getParentSuggestions(suggestions, mainPerson_, secondPerson, relId, Fatherhood, forbiddenFirstPersons, forbiddenSecondPersons);
-            else
-                getParentSuggestions(suggestions, secondPerson, mainPerson_, relId, Fatherhood, forbiddenSecondPersons, forbiddenFirstPersons);
-            break;
-        case Partnership: // Share children
-            getPartnersSuggestions(suggestions, mainPerson_, secondPerson, relId, forbiddenFirstPersons);
-            getPartnersSuggestions(suggestions, secondPerson, mainPerson_, relId, forbiddenSecondPersons);
-            break;
-        case Sibling: // Share parents.
-            getSiblingsSuggestions(suggestions, mainPerson_, secondPerson, relId, forbiddenFirstPersons);
-            getSiblingsSuggestions(suggestions, secondPerson, mainPerson_, relId, forbiddenSecondPersons);
-            break;
-        case None:
-        default:
-            return suggestions;
-    }
-    return suggestions;
+    if(!optRel || mainPerson_ == nullptr || !getPerson((*optRel)->getTheOtherPerson(mainPerson_->getId()))) return {};
+    return inference::suggest(getKinship(), mainPerson_->getId(), relId);
 }
 
 Settings* FamilyTree::getSettings(){
@@ -656,23 +922,105 @@ bool FamilyTree::importRootDir(const std::string& dirPath){
 }
 
 std::pair<bool, size_t> FamilyTree::importTemplates(const std::string& filePath){
-    savedChanges_ = false;
+    setUnsaved(DB_CONFIG);
     Json::Value value;
     bool success = parser_.readJSONFile(filePath, value, false);
     size_t imported = settings_.importTemplates(value);
     return {success, imported};
 }
 
+void FamilyTree::indexRecords(){
+    eventsByTemplate_.clear();
+    relationsByTemplate_.clear();
+    for(auto&& [id, event] : allEvents_)
+        indexTemplate(eventsByTemplate_, *event);
+    for(auto&& [id, rel] : allRelations_)
+        indexTemplate(relationsByTemplate_, *rel);
+    for(auto&& [id, person] : allPersons_)
+        referenceFiles(*person, true);
+    tagIndex_.build(allPersons_);
+    dates_.invalidate();
+    kinship_.invalidate();
+    relationships_.invalidate();
+    inbreeding_.invalidate();
+    personIndex_.invalidate();
+}
+
+std::vector<std::vector<RelationSuggestion>> FamilyTree::inferRelations(size_t pageSize){
+    return inference::paginate(inference::suggestAll(allPersons_, getKinship()), pageSize);
+}
+
 bool FamilyTree::isDirectorySet(){
 	return parser_.isRootDirectorySet();
 }
 
 bool FamilyTree::isSaved() const{
-    return savedChanges_;
+    return !saveTask_.valid() && unsavedFiles_.empty() && unsavedRecords_.empty();
+}
+
+bool FamilyTree::isSaving() const{
+    return saveTask_.valid();
 }
 
-void FamilyTree::log(const std::string& error){
-    parser_.log(error);
+void FamilyTree::loadFiles(){
+    if(pendingFiles_.empty()) return;
+    for(auto&& [type, future] : pendingFiles_){
+        bool success = false;
+        try{
+            auto loaded = future.get();
+            for(auto&& file : loaded.second){
+                fileReferences_[type].addFile(file->getId());
+                fileReferences_[type].addBlob(file->getBlob());
+            }
+            switch(type){
+                case MEDIA:
+                    insertRecords(loaded.second, allMedia_, media_index_);
+                    break;
+                case NOTE:
+                    insertRecords(loaded.second, allNotes_, note_index_);
+                    break;
+                case GENERAL_FILE:
+                default:
+                    insertRecords(loaded.second, allFiles_, file_index_);
+                    break;
+            }
+            success = loaded.first;
+        } catch(const std::bad_alloc&){
+            success = false;
+        }
+        if(!success){
+            // Missing records of the file would be lost if the file was rewritten from the loaded ones.
+            damagedFiles_.insert(database::file(type));
+            log("File " + database::path(database::file(type)) + " is corrupted, it will not be rewritten.");
+        }
+    }
+    pendingFiles_.clear();
+    for(auto&& record : pendingFileRecords_)
+        readJournalRecord(record);
+    pendingFileRecords_.clear();
+}
+
+void FamilyTree::log(const std::string& error, LogLevel level){
+    parser_.log(error, level);
+}
+
+bool FamilyTree::loadCache(const std::string& key){
+    return parser_.readCache([this, &key](BinaryReader& reader){
+        std::string storedKey;
+        reader.read(storedKey);
+        if(storedKey != key) return false;
+        auto persons = decodeRecords<Person>(reader.section(), [](){return std::make_unique<Person>();});
+        auto events = decodeRecords<Event>(reader.section(), [this](){return std::make_unique<Event>(&settings_);});
+        auto relations = decodeRecords<Relation>(reader.section(), [this](){return std::make_unique<Relation>(&settings_);});
+        // Records are inserted only when all sections were decoded, so a broken image leaves the tree empty.
+        auto decodedPersons = persons.get();
+        auto decodedEvents = events.get();
+        auto decodedRelations = relations.get();
+        insertRecords(decodedPersons, allPersons_, person_index_);
+        insertRecords(decodedEvents, allEvents_, event_index_);
+        insertRecords(decodedRelations, allRelations_, relation_index_);
+        return true;
+    });
 }
 
 bool FamilyTree::loadDatabaseFile(const std::string& file, std::function<void(const Json::Value&)> reader, std::string& errorMessage){
@@ -683,10 +1031,115 @@ bool FamilyTree::loadDatabaseFile(const std::string& file, std::function<void(co
     return success;
 }
 
+bool FamilyTree::mergePersons(size_t kept, size_t merged){
+    auto keptIt = allPersons_.find(kept);
+    auto mergedIt = allPersons_.find(merged);
+    if(kept == merged || keptIt == allPersons_.end() || mergedIt == allPersons_.end()) return false;
+    Person* target = keptIt->second.get();
+    Person* source = mergedIt->second.get();
+    setUnsaved(DB_PERSONS, kept);
+    setUnsaved(DB_PERSONS, merged);
+    // Father, mother and partner are taken before the relations are moved, they are used if the kept person has none.
+    std::pair<size_t, Trait> special[] = {{source->getFather(), Fatherhood}, {source->getMother(), Motherhood}, {source->getPartner(), Partnership}};
+    // Relations of the merged person by the relations of the kept person replacing them.
+    std::map<size_t, size_t> moved;
+    std::vector<size_t> relations = source->getRelations();
+    for(size_t relId : relations){
+        auto optRel = getRelation(relId);
+        if(!optRel) continue;
+        Relation* rel = *optRel;
+        size_t other = rel->getTheOtherPerson(merged);
+        bool first = rel->getFirstPerson() == merged;
+        if(other == kept || other == merged){
+            removeRelation(relId);
+            continue;
+        }
+        auto same = std::find_if(target->getRelations().begin(), target->getRelations().end(), [&](size_t keptRelId){
+            auto optKeptRel = getRelation(keptRelId);
+            return optKeptRel && (*optKeptRel)->getTemplate() == rel->getTemplate() && (*optKeptRel)->getTheOtherPerson(kept) == other
+                && ((*optKeptRel)->getFirstPerson() == kept) == first;
+        });
+        if(same != target->getRelations().end()){
+            // The relative keeps its father, mother or partner through the same relation with the kept person.
+            size_t keptRelId = *same;
+            auto optOther = getPerson(other);
+            Person* relative = optOther ? *optOther : nullptr;
+            bool father = relative && relative->getFather() == relId;
+            bool mother = relative && relative->getMother() == relId;
+            bool partner = relative && relative->getPartner() == relId;
+            removeRelation(relId);
+            if(father) relative->setFather(keptRelId);
+            if(mother) relative->setMother(keptRelId);
+            if(partner) relative->setPartner(keptRelId);
+            moved[relId] = keptRelId;
+            continue;
+        }
+        setUnsaved(DB_RELATIONS, relId);
+        rel->setPersons(first ? kept : rel->getFirstPerson(), first ? rel->getSecondPerson() : kept);
+        source->removeRelation(relId);
+        target->addRelation(relId);
+        moved[relId] = relId;
+    }
+    size_t current[] = {target->getFather(), target->getMother(), target->getPartner()};
+    for(size_t i = 0; i < std::size(special); ++i){
+        auto it = moved.find(special[i].first);
+        if(current[i] == 0 && it != moved.end()) target->promoteRelation(it->second, special[i].second);
+    }
+    std::vector<size_t> events = source->getEvents();
+    for(size_t eventId : events){
+        auto optEvent = getEvent(eventId);
+        if(!optEvent) continue;
+        Event* event = *optEvent;
+        std::vector<std::string> roles;
+        for(auto&& [role, person] : event->getPersons())
+            if(person == merged) roles.push_back(role.str());
+        for(size_t i = 0; i < roles.size(); ++i)
+            event->removePerson(merged);
+        for(auto&& role : roles)
+            event->addPerson(kept, role);
+        target->addEvent(eventId);
+        setUnsaved(DB_EVENTS, eventId);
+    }
+    if(target->getName().empty() || target->getName() == person::NAME_STR) target->setName() = source->getName();
+    if(target->getSurname().empty() || target->getSurname() == person::SURNAME_STR) target->setSurname() = source->getSurname();
+    if(target->getMaidenName().empty()) target->setMaidenName() = source->getMaidenName();
+    if(target->getFrontTitle().empty()) target->setFrontTitle(source->getFrontTitle());
+    if(target->getAfterTitle().empty()) target->setAfterTitle(source->getAfterTitle());
+    if(target->getBirthDate().isUnknown()) *target->birthDate() = source->getBirthDate();
+    if(target->getBirthPlace().empty()) target->setBirthPlace(source->getBirthPlace());
+    // Date of death of a living person means nothing, so it is replaced by the known one.
+    if(!source->isAlive()){
+        if(target->isAlive() || target->getDeathDate().isUnknown()) *target->deathDate() = source->getDeathDate();
+        if(target->getDeathPlace().empty()) target->setDeathPlace(source->getDeathPlace());
+        target->setLives(false);
+    }
+    if(target->getGender() == Other) target->setGender(source->getGender());
+    for(auto&& [tag, value] : source->getTags())
+        if(!target->existsTag(tag).first) target->addTag(tag, value);
+    for(FileType type : {GENERAL_FILE, MEDIA, NOTE}){
+        const VirtualDrive& drive = source->getFilesRoot(type);
+        if(drive.getFiles().empty() && drive.getSubdrives().empty()) continue;
+        // The folder counts the copied files, so they stay referenced when the merged person is removed.
+        VirtualDrive* folder = target->getFilesRootPointer(type)->addSubdrive();
+        folder->copyDrive(drive);
+        folder->rename(source->str());
+    }
+    referenceFiles(*source, false);
+    if(mainPerson_ == source) mainPerson_ = target;
+    allPersons_.erase(merged);
+    tagIndex_.update(*target);
+    tagIndex_.remove(merged);
+    kinship_.invalidate();
+    return true;
+}
+
 std::pair<bool, bool> FamilyTree::openDatabase(const std::string& dirPath, std::string& errorMessage, std::string& backupFile){
+    finishSave();
     bool succes = parser_.setDatabase(dirPath);
     bool backup = parser_.containsBackupFile(backupFile);
-    savedChanges_ = true;
+    unsavedFiles_.clear();
+    unsavedRecords_.clear();
+    damagedFiles_.clear();
 	if(!succes){
 		errorMessage = "Directory does not exists or does not contain all files or directories.";
 		return {succes, backup};
@@ -697,18 +1150,58 @@ std::pair<bool, bool> FamilyTree::openDatabase(const std::string& dirPath, std::
 bool FamilyTree::openDatabase(std::string& errorMessage){
     bool success = loadDatabaseFile(parser::JSON_CONFIG, [this](const Json::Value& root){this->settings_.readJson(root);}, errorMessage);
     if(!success) return success; // It is not worth to look trough others.
-    success = loadDatabaseFile(parser::JSON_PERSONS, [this](const Json::Value& root){this->readJsonPeople(root);}, errorMessage);
-    if(!success) return success;
-    success = loadDatabaseFile(parser::JSON_MEDIA, [this](const Json::Value& root){this->readJsonFiles(root, this->allMedia_, jsonlabel::MEDIA, media_index_);}, errorMessage);
-    if(!success) return success;
-    success = loadDatabaseFile(parser::JSON_FILES, [this](const Json::Value& root){this->readJsonFiles(root, this->allFiles_, jsonlabel::FILES, file_index_);}, errorMessage);
-    if(!success) return success;
-    success = loadDatabaseFile(parser::JSON_NOTES, [this](const Json::Value& root){this->readJsonFiles(root, this->allNotes_, jsonlabel::NOTES, note_index_);}, errorMessage);
-    if(!success) return success;
-    success = loadDatabaseFile(parser::JSON_EVENTS, [this](const Json::Value& root){this->readJsonEvents(root);}, errorMessage);
-    if(!success) return success;
-    success = loadDatabaseFile(parser::JSON_RELATIONS, [this](const Json::Value& root){this->readJsonRelations(root);}, errorMessage);
-    if(!success) return success;
+    // Templates are loaded, so all other files can be read and parsed at once. Settings are only read from now on.
+    // Meta-data of files are needed only by the file tabs, so they are merged when they are used for the first time.
+    pendingFiles_.emplace(MEDIA, loadRecords<File>(parser_, parser::JSON_MEDIA, jsonlabel::MEDIA, createFile));
+    pendingFiles_.emplace(GENERAL_FILE, loadRecords<File>(parser_, parser::JSON_FILES, jsonlabel::FILES, createFile));
+    pendingFiles_.emplace(NOTE, loadRecords<File>(parser_, parser::JSON_NOTES, jsonlabel::NOTES, createFile));
+    // Unchanged files were already parsed, so their binary image is used instead. The journal is applied in both cases.
+    std::string key = cacheKey();
+    if(key.empty() || !loadCache(key)){
+        auto persons = loadRecords<Person>(parser_, parser::JSON_PERSONS, jsonlabel::PERSONS, [](const Json::Value& value){
+            auto p = std::make_unique<Person>();
+            p->readJson(value);
+            return p;
+        });
+        auto events = loadRecords<Event>(parser_, parser::JSON_EVENTS, jsonlabel::EVENTS, [this](const Json::Value& value){
+            auto e = std::make_unique<Event>(&settings_);
+            e->readJson(value);
+            return e;
+        });
+        auto relations = loadRecords<Relation>(parser_, parser::JSON_RELATIONS, jsonlabel::RELATIONS, [this](const Json::Value& value){
+            auto r = std::make_unique<Relation>(&settings_);
+            r->readJson(value);
+            return r;
+        });
+        auto insert = [&errorMessage](auto& future, auto& container, size_t& index, const std::string& file){
+            bool loaded = false;
+            try{
+                auto records = future.get();
+                insertRecords(records.second, container, index);
+                loaded = records.first;
+            } catch(const std::bad_alloc&){
+                // Values of a damaged file may ask for more memory than there is.
+                loaded = false;
+            }
+            if(!loaded) errorMessage = "File " + file + " is corrupted.";
+            return loaded;
+        };
+        success = insert(persons, allPersons_, person_index_, parser::JSON_PERSONS)
+            && insert(events, allEvents_, event_index_, parser::JSON_EVENTS)
+            && insert(relations, allRelations_, relation_index_, parser::JSON_RELATIONS);
+        if(!success) return success;
+        if(!key.empty()) storeCache(key);
+    }
+    indexRecords();
+    try{
+        success = parser_.readJournal([this](const Json::Value& record){this->readJournalRecord(record);});
+    } catch(const std::bad_alloc&){
+        success = false;
+    }
+    if(!success){
+        errorMessage = "File " + parser::JOURNAL + " is corrupted.";
+        return success;
+    }
 	auto optPerson = getPerson(settings_.getGlobalMainPerson());
 	if(optPerson) mainPerson_ = (*optPerson);
 	return success;
@@ -728,13 +1221,19 @@ bool FamilyTree::openSingleFileDatabase(const std::string& filePath){
     for(Json::ArrayIndex i = 0; i < root[jsonlabel::EXPORT][jsonlabel::PERSONS].size(); ++i){
         Person p;
 		p.importJson(root[jsonlabel::EXPORT][jsonlabel::PERSONS][i]);
-		allPersons_.insert({p.getId(), std::make_unique<Person>(std::move(p))});
+		auto [it, inserted] = allPersons_.insert({p.getId(), std::make_unique<Person>(std::move(p))});
+		if(inserted){
+			referenceFiles(*it->second, true);
+			tagIndex_.update(*it->second);
+		}
 		person_index_ = person_index_ <= p.getId() ? p.getId() + 1 : person_index_;
     }
+    kinship_.invalidate();
     return true;
 }
 
 std::vector<std::string> FamilyTree::getOrphanFiles(){
+    loadFiles();
     std::vector<std::string> files;
     getGeneralOrphaFiles(files, allFiles_, GENERAL_FILE);
     getGeneralOrphaFiles(files, allMedia_, MEDIA);
@@ -782,26 +1281,47 @@ void FamilyTree::printCss(const std::string& dirPath){
     parser_.writeHtml(ss.str(), dirPath, html::CUSTOM_CSS);
 }
 
-void FamilyTree::printEvents(std::ostream& os){
-	os << "{\"" << jsonlabel::EVENTS << "\":[";
-	bool first = true;
-	for(auto&& [id, event] : allEvents_){
+void FamilyTree::printExport(std::ostream& os, bool includingEvents, bool includingRelations){
+    os << "{\"" << jsonlabel::EXPORT << "\":";
+    os << "{\"" << jsonlabel::PERSONS << "\":[";
+    bool first = true;
+    for(auto&& [id, pPerson] : allPersons_){
 		if(!first) os << ",";
 		first = false;
-		os << (*event);
+		pPerson->exportJson(os, includingEvents, includingRelations);
 	}
-	os << "]}";
-}
-
-void FamilyTree::printFiles(std::ostream& os, const std::map<size_t, std::unique_ptr<File>>& container, const std::string& label){
-	os << "{ \"" << label << "\":[";
-	bool first = true;
-	for(auto&& [id, file] : container){
-		if(!first) os << ",";
-		first = false;
-		os << (*file);
+	os << "]";
+	std::set<size_t> eventTemplates;
+	if(includingEvents){
+        os << ",\"" << jsonlabel::EVENTS << "\":[";
+        first = true;
+        for(auto&& [id, event] : allEvents_){
+            if(!first) os << ",";
+            first = false;
+            os << (*event);
+            eventTemplates.insert(event->getTemplate());
+        }
+        os << "]";
+	}
+	std::set<size_t> relTemplates;
+	if(includingRelations){
+        os << ",\"" << jsonlabel::RELATIONS << "\":[";
+        first = true;
+        for(auto&& [id, rel] : allRelations_){
+            if(!first) os << ",";
+            first = false;
+            os << (*rel);
+            relTemplates.insert(rel->getTemplate());
+        }
+        os << "]";
 	}
-	os << "]}";
+    std::vector<size_t> events(eventTemplates.begin(), eventTemplates.end());
+    std::vector<size_t> rels(relTemplates.begin(), relTemplates.end());
+    if(events.size() > 0 || rels.size() > 0){
+        os << ",\"" << jsonlabel::TEMPLATES << "\":";
+        settings_.exportTemplates(os, rels, events);
+    }
+    os << "}}";
 }
 
 void FamilyTree::printHtml(const std::string& dirPath){
@@ -815,13 +1335,19 @@ void FamilyTree::printHtml(const std::string& dirPath){
     index << "\t<body>" << std::endl;
     index << "\t\t<h1 align=\"center\">" << html::ALL_PERSONS << "</h1>" << std::endl;
     index << "\t\t<ul>" << std::endl;
+    // Persons in the index are described by their relationship to the main person.
+    std::map<size_t, Relationship> relationships;
+    if(mainPerson_ != nullptr) relationships = findRelationships(mainPerson_->getId());
     for(auto&& [id, person] : allPersons_){
         std::stringstream ss;
         printHtmlPerson(ss, true, person.get());
         std::stringstream name;
         name << id << ".html";
         parser_.writeHtml(ss.str(), dirPath, name.str());
-        index << "\t\t\t<li><a href=\"" << id << ".html\">" << person->str() << "</a></li>" << std::endl;
+        index << "\t\t\t<li><a href=\"" << id << ".html\">" << person->str() << "</a>";
+        auto found = relationships.find(id);
+        if(found != relationships.end()) index << ", " << relationship::name(found->second, person->getGender());
+        index << "</li>" << std::endl;
     }
     index << "\t\t</ul>" << std::endl;
     index << "\t</body>" << std::endl;
@@ -902,28 +1428,6 @@ void FamilyTree::printMainPersonHtml(const std::string& outputDir){
     parser_.writeHtml(ss.str(), outputDir, name.str());
 }
 
-void FamilyTree::printPeople(std::ostream& os){
-	os << "{ \"" << jsonlabel::PERSONS << "\":[";
-	bool first = true;
-	for(auto&& [id, person] : allPersons_){
-		if(!first) os << ",";
-		first = false;
-		os << (*person);
-	}
-	os << "]}";
-}
-
-void FamilyTree::printRelations(std::ostream& os){
-	os << "{\"" << jsonlabel::RELATIONS << "\":[";
-	bool first = true;
-	for(auto&& [id, rel] : allRelations_){
-		if(!first) os << ",";
-		first = false;
-		os << (*rel);
-	}
-	os << "]}";
-}
-
 void FamilyTree::promoteRelation(size_t id){
     auto optRel = getRelation(id);
     if(!optRel){
@@ -942,6 +1446,8 @@ void FamilyTree::promoteRelation(size_t id){
         removeRelation(id);
         return;
     }
+    setUnsaved(DB_PERSONS, rel->getFirstPerson());
+    setUnsaved(DB_PERSONS, rel->getSecondPerson());
     Trait t;
     auto optTempl = settings_.getRelationTemplate(rel->getTemplate());
     if(!optTempl) return;
@@ -954,101 +1460,194 @@ void FamilyTree::promoteRelation(size_t id){
     }
 }
 
-void FamilyTree::readJsonEvents(const Json::Value& value){
-	for(Json::ArrayIndex i = 0; i < value[jsonlabel::EVENTS].size(); ++i){
-        Event e (&settings_);
-		e.readJson(value[jsonlabel::EVENTS][i]);
-		allEvents_.insert({e.getId(), std::make_unique<Event>(std::move(e))});
-		event_index_ = event_index_ <= e.getId() ? e.getId() + 1 : event_index_;
-	}
+void FamilyTree::readJournalRecord(const Json::Value& value){
+    const std::string label = value[jsonlabel::JOURNAL_FILE].asString();
+    size_t id = value[jsonlabel::ID].asUInt64();
+    bool removed = value[jsonlabel::REMOVED].asBool();
+    const Json::Value& record = value[jsonlabel::RECORD];
+    if(label == jsonlabel::PERSONS){
+        if(allPersons_.contains(id)) referenceFiles(*allPersons_.at(id), false);
+        allPersons_.erase(id);
+        tagIndex_.remove(id);
+        dates_.invalidatePerson(id);
+        personIndex_.invalidate(id);
+        kinship_.invalidate();
+        relationships_.invalidate();
+        inbreeding_.invalidate();
+        if(!removed) readJsonPerson(record);
+    }
+    else if(label == jsonlabel::EVENTS){
+        eraseIndexed(allEvents_, eventsByTemplate_, id);
+        dates_.invalidateEvent(id);
+        if(!removed) readJsonEvent(record);
+    }
+    else if(label == jsonlabel::RELATIONS){
+        eraseIndexed(allRelations_, relationsByTemplate_, id);
+        kinship_.invalidate();
+        relationships_.invalidate();
+        inbreeding_.invalidate();
+        if(!removed) readJsonRelation(record);
+    }
+    else if(!pendingFiles_.empty() && (label == jsonlabel::FILES || label == jsonlabel::MEDIA || label == jsonlabel::NOTES)){
+        // Applied after the files are loaded.
+        pendingFileRecords_.push_back(value);
+    }
+    else if(label == jsonlabel::FILES){
+        eraseFile(allFiles_, GENERAL_FILE, id);
+        if(!removed) readJsonFile(record, allFiles_, file_index_, GENERAL_FILE);
+    }
+    else if(label == jsonlabel::MEDIA){
+        eraseFile(allMedia_, MEDIA, id);
+        if(!removed) readJsonFile(record, allMedia_, media_index_, MEDIA);
+    }
+    else if(label == jsonlabel::NOTES){
+        eraseFile(allNotes_, NOTE, id);
+        if(!removed) readJsonFile(record, allNotes_, note_index_, NOTE);
+    }
+    else log("Unknown record in the journal: " + label + ".");
 }
 
-void FamilyTree::readJsonFiles(const Json::Value& value, std::map<size_t, std::unique_ptr<File>>& container, const std::string& label, size_t& index){
-	for(Json::ArrayIndex i = 0; i < value[label].size(); ++i){
-        File f;
-		f.readJson(value[label][i]);
-		container.insert({f.getId(), std::make_unique<File>(std::move(f))});
-		index = index <= f.getId() ? f.getId() + 1 : index;
-	}
+void FamilyTree::readJsonEvent(const Json::Value& value){
+    auto e = std::make_unique<Event>(&settings_);
+    e->readJson(value);
+    size_t id = e->getId();
+    auto [it, inserted] = allEvents_.insert({id, std::move(e)});
+    if(inserted) indexTemplate(eventsByTemplate_, *it->second);
+    dates_.invalidateEvent(id);
+    event_index_ = event_index_ <= id ? id + 1 : event_index_;
 }
 
-void FamilyTree::readJsonPeople(const Json::Value& value){
-	for(Json::ArrayIndex i = 0; i < value[jsonlabel::PERSONS].size(); ++i){
-        Person p;
-		p.readJson(value[jsonlabel::PERSONS][i]);
-		allPersons_.insert({p.getId(), std::make_unique<Person>(std::move(p))});
-		person_index_ = person_index_ <= p.getId() ? p.getId() + 1 : person_index_;
-	}
+void FamilyTree::readJsonEvents(const Json::Value& value){
+	for(Json::ArrayIndex i = 0; i < value[jsonlabel::EVENTS].size(); ++i)
+		readJsonEvent(value[jsonlabel::EVENTS][i]);
+}
+
+void FamilyTree::readJsonFile(const Json::Value& value, RecordMap<File>& container, size_t& index, FileType type){
+    auto f = std::make_unique<File>();
+    f->readJson(value);
+    size_t id = f->getId();
+    auto [it, inserted] = container.insert({id, std::move(f)});
+    fileReferences_[type].addFile(id);
+    if(inserted) fileReferences_[type].addBlob(it->second->getBlob());
+    index = index <= id ? id + 1 : index;
+}
+
+void FamilyTree::readJsonPerson(const Json::Value& value){
+    auto p = std::make_unique<Person>();
+    p->readJson(value);
+    size_t id = p->getId();
+    auto [it, inserted] = allPersons_.insert({id, std::move(p)});
+    if(inserted) referenceFiles(*it->second, true);
+    tagIndex_.update(*it->second);
+    dates_.invalidatePerson(id);
+    personIndex_.invalidate(id);
+    kinship_.invalidate();
+    relationships_.invalidate();
+    inbreeding_.invalidate();
+    person_index_ = person_index_ <= id ? id + 1 : person_index_;
+}
+
+void FamilyTree::readJsonRelation(const Json::Value& value){
+    auto r = std::make_unique<Relation>(&settings_);
+    r->readJson(value);
+    size_t id = r->getId();
+    auto [it, inserted] = allRelations_.insert({id, std::move(r)});
+    if(inserted) indexTemplate(relationsByTemplate_, *it->second);
+    kinship_.invalidate();
+    relationships_.invalidate();
+    inbreeding_.invalidate();
+    relation_index_ = relation_index_ <= id ? id + 1 : relation_index_;
 }
 
 void FamilyTree::readJsonRelations(const Json::Value& value){
-	for(Json::ArrayIndex i = 0; i < value[jsonlabel::RELATIONS].size(); ++i){
-        Relation r (&settings_);
-		r.readJson(value[jsonlabel::RELATIONS][i]);
-		allRelations_.insert({r.getId(), std::make_unique<Relation>(std::move(r))});
-		relation_index_ = relation_index_ <= r.getId() ? r.getId() + 1 : relation_index_;
-	}
+	for(Json::ArrayIndex i = 0; i < value[jsonlabel::RELATIONS].size(); ++i)
+		readJsonRelation(value[jsonlabel::RELATIONS][i]);
+}
+
+void FamilyTree::referenceFiles(Person& person, bool referenced){
+    for(FileType type : {GENERAL_FILE, MEDIA, NOTE})
+        person.getFilesRootPointer(type)->setReferences(referenced ? &fileReferences_[type] : nullptr);
 }
 
 void FamilyTree::removeBackup(){
     parser_.removeBackup();
 }
 
-size_t FamilyTree::removeGeneralOrphanFile(std::map<size_t, std::unique_ptr<File>>& container, FileType type, const std::string& dir){
-    std::map<size_t, bool> usedFiles;
-    size_t counter = 0;
-    for(auto&& [id, file] : container)
-        usedFiles.insert({id, false});
-    for(auto&& [id, person] : allPersons_){
-        std::vector<size_t> used;
-        person->getFilesRoot(type).usedFiles(used);
-        for(auto&& fileId : used){
-            usedFiles[fileId] = true;
+size_t FamilyTree::removeGeneralOrphanFile(RecordMap<File>& container, FileType type, const std::string& dir){
+    FileReferences& references = fileReferences_[type];
+    // Removed files leave the orphans, so their copy is iterated.
+    std::set<size_t> orphans = references.getOrphans();
+    for(auto&& id : orphans){
+        auto optFile = getFile(id, type);
+        if(optFile){
+            std::string realName = (*optFile)->getRealName();
+            // Stored file with the same content may be still used by another record.
+            if(eraseFile(container, type, id))
+                parser_.removeFile(realName, dir);
+            setUnsaved(database::file(type), id);
         }
+        else references.removeFile(id);
     }
-    for(auto&& [id, used] : usedFiles){
-        if(!used){
-            ++counter;
-            auto optFile = getFile(id, type);
-            if(optFile){
-                parser_.removeFile((*optFile)->getRealName(), dir);
-                container.erase(id);
-            }
-        }
+    return orphans.size();
+}
+
+void FamilyTree::removeOrphanFiles(FileType type){
+    DatabaseFile file = database::file(type);
+    if(!unsavedRecords_.count(file) && !unsavedRecords_.count(DB_PERSONS) && !unsavedFiles_.count(file) && !unsavedFiles_.count(DB_PERSONS))
+        return;
+    loadFiles();
+    switch(type){
+        case NOTE:
+            removeGeneralOrphanFile(allNotes_, type, parser::NOTES_DIR);
+            break;
+        case MEDIA:
+            removeGeneralOrphanFile(allMedia_, type, parser::MEDIA_DIR);
+            break;
+        case GENERAL_FILE:
+        default:
+            removeGeneralOrphanFile(allFiles_, type, parser::FILES_DIR);
+            break;
     }
-    return counter;
 }
 
 void FamilyTree::removeEvent(size_t id){
-    savedChanges_ = false;
+    setUnsaved(DB_EVENTS, id);
     auto event = getEvent(id);
     if(event){
         for(auto&& [role, personId] : (*event)->getPersons()){
             auto optPerson = getPerson(personId);
             if(optPerson) (*optPerson)->removeEvent(id);
+            setUnsaved(DB_PERSONS, personId);
         }
-        allEvents_.erase(id);
+        eraseIndexed(allEvents_, eventsByTemplate_, id);
     }
 }
 
 void FamilyTree::removeEventTemplate(size_t id){
-    savedChanges_ = false;
+    setUnsaved(DB_CONFIG);
     settings_.removeEventTemplate(id);
-    for(auto it = allEvents_.begin(); it != allEvents_.end(); ++it){
-        if(it->second->getTemplate() == id){
-            for(auto&& person : it->second->getPersons()){
-                auto optPerson = getPerson(person.second);
-                if(optPerson) (*optPerson)->removeEvent(it->first);
-            }
-            allEvents_.erase(it);
+    auto indexed = eventsByTemplate_.find(id);
+    if(indexed == eventsByTemplate_.end()) return;
+    // The index entry is taken out first, so removing the events does not touch the set being iterated.
+    std::set<size_t> events = std::move(indexed->second);
+    eventsByTemplate_.erase(indexed);
+    for(auto&& eventId : events){
+        auto optEvent = getEvent(eventId);
+        if(!optEvent) continue;
+        for(auto&& person : (*optEvent)->getPersons()){
+            auto optPerson = getPerson(person.second);
+            if(optPerson) (*optPerson)->removeEvent(eventId);
+            setUnsaved(DB_PERSONS, person.second);
         }
+        setUnsaved(DB_EVENTS, eventId);
+        allEvents_.erase(eventId);
     }
 }
 
 void FamilyTree::removePerson(){
-    savedChanges_ = false;
     if(mainPerson_ == nullptr) return;
     size_t index = mainPerson_->getId();
+    setUnsaved(DB_PERSONS, index);
     for(auto&& relId : mainPerson_->getRelations())
         removeRelation(relId);
     for(auto&& eventId : mainPerson_->getEvents()){
@@ -1058,14 +1657,18 @@ void FamilyTree::removePerson(){
             if(removeEv){
                 removeEvent(eventId);
             }
+            else setUnsaved(DB_EVENTS, eventId);
         }
     }
+    referenceFiles(*mainPerson_, false);
     allPersons_.erase(index);
+    tagIndex_.remove(index);
+    kinship_.invalidate();
     mainPerson_ = nullptr;
 }
 
 void FamilyTree::removeRelation(size_t id){
-    savedChanges_ = false;
+    setUnsaved(DB_RELATIONS, id);
     auto optRel = getRelation(id);
     if(!optRel){
         return;
@@ -1073,6 +1676,8 @@ void FamilyTree::removeRelation(size_t id){
     const Relation* rel = (*optRel);
     size_t firstPerson = rel->getFirstPerson();
     size_t secondPerson = rel->getSecondPerson();
+    setUnsaved(DB_PERSONS, firstPerson);
+    setUnsaved(DB_PERSONS, secondPerson);
     auto optPerson1 = getPerson(firstPerson);
     auto optPerson2 = getPerson(secondPerson);
     if(optPerson1){
@@ -1083,33 +1688,52 @@ void FamilyTree::removeRelation(size_t id){
         (*optPerson2)->removeRelation(rel->getId());
         (*optPerson2)->updateSpecialRelation(rel->getId(), None);
     }
-    allRelations_.erase(rel->getId());
+    eraseIndexed(allRelations_, relationsByTemplate_, rel->getId());
 }
 
 void FamilyTree::removeRelationTemplate(size_t id){
-    savedChanges_ = false;
+    setUnsaved(DB_CONFIG);
     settings_.removeRelationTemplate(id);
-    for(auto it = allRelations_.begin(); it != allRelations_.end(); ++it){
-        if(it->second->getTemplate() == id){
-            size_t firstPerson = it->second->getFirstPerson();
-            size_t secondPerson = it->second->getSecondPerson();
-            auto optPerson1 = getPerson(firstPerson);
-            auto optPerson2 = getPerson(secondPerson);
-            if(optPerson1){
-                (*optPerson1)->removeRelation(it->first);
-                (*optPerson1)->updateSpecialRelation(it->first, None);
-            }
-            if(optPerson2){
-                (*optPerson2)->removeRelation(it->first);
-                (*optPerson2)->updateSpecialRelation(it->first, None);
-            }
-            allRelations_.erase(it);
+    auto indexed = relationsByTemplate_.find(id);
+    if(indexed == relationsByTemplate_.end()) return;
+    // The index entry is taken out first, so removing the relations does not touch the set being iterated.
+    std::set<size_t> relations = std::move(indexed->second);
+    relationsByTemplate_.erase(indexed);
+    for(auto&& relId : relations){
+        auto optRel = getRelation(relId);
+        if(!optRel) continue;
+        size_t firstPerson = (*optRel)->getFirstPerson();
+        size_t secondPerson = (*optRel)->getSecondPerson();
+        setUnsaved(DB_RELATIONS, relId);
+        setUnsaved(DB_PERSONS, firstPerson);
+        setUnsaved(DB_PERSONS, secondPerson);
+        auto optPerson1 = getPerson(firstPerson);
+        auto optPerson2 = getPerson(secondPerson);
+        if(optPerson1){
+            (*optPerson1)->removeRelation(relId);
+            (*optPerson1)->updateSpecialRelation(relId, None);
         }
+        if(optPerson2){
+            (*optPerson2)->removeRelation(relId);
+            (*optPerson2)->updateSpecialRelation(relId, None);
+        }
+        allRelations_.erase(relId);
     }
 }
 
+size_t FamilyTree::removeTag(const std::string& tag){
+    std::vector<size_t> persons = findPersonsWithTag(tag);
+    for(size_t id : persons){
+        allPersons_.at(id)->removeTag(tag);
+        setUnsaved(DB_PERSONS, id);
+    }
+    settings_.removeTag(tag);
+    setUnsaved(DB_CONFIG);
+    return persons.size();
+}
+
 void FamilyTree::renameFile(size_t id, const std::string& newFilename, FileType type){
-    savedChanges_ = false;
+    setUnsaved(database::file(type), id);
     auto optFile = getFile(id, type);
     if(!optFile){
         return;
@@ -1117,6 +1741,10 @@ void FamilyTree::renameFile(size_t id, const std::string& newFilename, FileType
     std::string originalName = (*optFile)->getRealName();
     (*optFile)->setFilename(newFilename);
     std::string newName = (*optFile)->getRealName();
+    // Shared stored file keeps its name, only the record is renamed.
+    if(originalName == newName){
+        return;
+    }
     switch(type){
         case MEDIA:
             parser_.renameFile(originalName, newName, parser::MEDIA_DIR);
@@ -1132,7 +1760,73 @@ void FamilyTree::renameFile(size_t id, const std::string& newFilename, FileType
 
 }
 
+size_t FamilyTree::renameTag(const std::string& tag, const std::string& newTag){
+    if(tag == newTag) return 0;
+    std::vector<size_t> persons = findPersonsWithTag(tag);
+    for(size_t id : persons){
+        Person* person = allPersons_.at(id).get();
+        std::string value = person->existsTag(tag).second;
+        person->removeTag(tag);
+        person->addTag(newTag, value);
+        setUnsaved(DB_PERSONS, id);
+    }
+    settings_.renameTag(tag, newTag);
+    setUnsaved(DB_CONFIG);
+    return persons.size();
+}
+
+bool FamilyTree::repairIssue(const ValidationIssue& issue){
+    switch(issue.kind){
+        case INVALID_RELATION_PERSON:
+            if(allRelations_.contains(issue.record)) removeRelation(issue.record);
+            return true;
+        case UNLISTED_RELATION:{
+            auto person = allPersons_.find(issue.reference);
+            if(!allRelations_.contains(issue.record) || person == allPersons_.end()) return false;
+            person->second->addRelation(issue.record);
+            setUnsaved(DB_PERSONS, issue.reference);
+            return true;
+        }
+        case DANGLING_RELATION:
+        case INVALID_SPECIAL_RELATION:{
+            auto person = allPersons_.find(issue.record);
+            if(person == allPersons_.end()) return false;
+            if(issue.kind == DANGLING_RELATION) person->second->removeRelation(issue.reference);
+            // Father, mother or partner is reset by updating it with no trait.
+            person->second->updateSpecialRelation(issue.reference, None);
+            setUnsaved(DB_PERSONS, issue.record);
+            return true;
+        }
+        case INVALID_EVENT_PERSON:{
+            auto event = allEvents_.find(issue.record);
+            if(event == allEvents_.end()) return true;
+            if(event->second->removePerson(issue.reference)) removeEvent(issue.record);
+            else setUnsaved(DB_EVENTS, issue.record);
+            return true;
+        }
+        case UNLISTED_EVENT:{
+            auto person = allPersons_.find(issue.reference);
+            if(!allEvents_.contains(issue.record) || person == allPersons_.end()) return false;
+            person->second->addEvent(issue.record);
+            setUnsaved(DB_PERSONS, issue.reference);
+            return true;
+        }
+        case DANGLING_EVENT:{
+            auto person = allPersons_.find(issue.record);
+            if(person == allPersons_.end()) return false;
+            person->second->removeEvent(issue.reference);
+            setUnsaved(DB_PERSONS, issue.record);
+            return true;
+        }
+        case INVALID_RELATION_TEMPLATE:
+        case INVALID_EVENT_TEMPLATE:
+        default:
+            return false;
+    }
+}
+
 bool FamilyTree::restoreBackup(const std::string& backupFile, std::string& errorMessage){
+    finishSave();
     parser_.restoreBackup(backupFile);
     allRelations_.clear();
     allEvents_.clear();
@@ -1140,6 +1834,17 @@ bool FamilyTree::restoreBackup(const std::string& backupFile, std::string& error
     allMedia_.clear();
     allNotes_.clear();
     allPersons_.clear();
+    pendingFiles_.clear();
+    eventsByTemplate_.clear();
+    relationsByTemplate_.clear();
+    fileReferences_.clear();
+    dates_.invalidate();
+    kinship_.invalidate();
+    relationships_.invalidate();
+    inbreeding_.invalidate();
+    personIndex_.invalidate();
+    tagIndex_.clear();
+    pendingFileRecords_.clear();
     event_index_ = 1;
     relation_index_ = 1;
     file_index_ = 1;
@@ -1148,9 +1853,21 @@ bool FamilyTree::restoreBackup(const std::string& backupFile, std::string& error
     person_index_ = 1;
     mainPerson_ = nullptr;
     settings_.clear();
+    unsavedFiles_.clear();
+    unsavedRecords_.clear();
+    damagedFiles_.clear();
     return openDatabase(errorMessage);
 }
 
+void FamilyTree::setEventTemplate(size_t eventId, size_t templId){
+    auto optEvent = getEvent(eventId);
+    if(!optEvent) return;
+    setUnsaved(DB_EVENTS, eventId);
+    unindexTemplate(eventsByTemplate_, **optEvent);
+    (*optEvent)->setTemplate(templId);
+    indexTemplate(eventsByTemplate_, **optEvent);
+}
+
 void FamilyTree::setMainPerson(Person* p){
 	mainPerson_ = p;
 }
@@ -1164,7 +1881,6 @@ void FamilyTree::setMainPerson(size_t id){
 }
 
 void FamilyTree::setRelation(size_t relId, size_t pers1Id, size_t pers2Id, size_t templId){
-    savedChanges_ = false;
     auto optRel = getRelation(relId);
     Relation* rel;
     if(!optRel){
@@ -1175,13 +1891,18 @@ void FamilyTree::setRelation(size_t relId, size_t pers1Id, size_t pers2Id, size_
     }
     else
         rel = (*optRel);
+    setUnsaved(DB_RELATIONS, rel->getId());
+    setUnsaved(DB_PERSONS, rel->getFirstPerson());
+    setUnsaved(DB_PERSONS, rel->getSecondPerson());
+    setUnsaved(DB_PERSONS, pers1Id);
+    setUnsaved(DB_PERSONS, pers2Id);
     auto optOriginPerson1 = getPerson(rel->getFirstPerson());
     auto optOriginPerson2 = getPerson(rel->getSecondPerson());
     if(optOriginPerson1)
         (*optOriginPerson1)->removeRelation(relId);
     if(optOriginPerson2)
         (*optOriginPerson2)->removeRelation(relId);
-    rel->setTemplate(templId);
+    setRelationTemplate(rel->getId(), templId);
     rel->setPersons(pers1Id, pers2Id);
     auto optPerson1 = getPerson(pers1Id);
     auto optPerson2 = getPerson(pers2Id);
@@ -1201,46 +1922,167 @@ void FamilyTree::setRelation(size_t relId, size_t pers1Id, size_t pers2Id, size_
         (*optOriginPerson2)->updateSpecialRelation(relId, rel->getTrait());
 }
 
+void FamilyTree::setRelationTemplate(size_t relId, size_t templId){
+    auto optRel = getRelation(relId);
+    if(!optRel) return;
+    setUnsaved(DB_RELATIONS, relId);
+    unindexTemplate(relationsByTemplate_, **optRel);
+    (*optRel)->setTemplate(templId);
+    indexTemplate(relationsByTemplate_, **optRel);
+}
+
 void FamilyTree::setUnsaved(){
-    savedChanges_ = false;
+    unsavedFiles_.insert(std::begin(database::AllFiles), std::end(database::AllFiles));
+    dates_.invalidate();
+    kinship_.invalidate();
+    relationships_.invalidate();
+    inbreeding_.invalidate();
+    personIndex_.invalidate();
+}
+
+void FamilyTree::setUnsaved(DatabaseFile file){
+    unsavedFiles_.insert(file);
+    // Templates are edited in place, so any change of the configuration can change the resolved relatives.
+    if(file == DB_CONFIG || file == DB_RELATIONS) kinship_.invalidate();
+    if(file == DB_CONFIG || file == DB_RELATIONS || file == DB_PERSONS){
+        relationships_.invalidate();
+        inbreeding_.invalidate();
+    }
+    if(file == DB_CONFIG || file == DB_PERSONS || file == DB_EVENTS) dates_.invalidate();
+    if(file == DB_PERSONS) personIndex_.invalidate();
+}
+
+void FamilyTree::setUnsaved(DatabaseFile file, size_t id){
+    if(file == DB_RELATIONS) kinship_.invalidate();
+    if(file == DB_RELATIONS || file == DB_PERSONS){
+        relationships_.invalidate();
+        inbreeding_.invalidate();
+    }
+    if(file == DB_PERSONS){
+        dates_.invalidatePerson(id);
+        personIndex_.invalidate(id);
+        // Tags are edited before the person is marked, so they are indexed at once.
+        auto person = allPersons_.find(id);
+        if(person != allPersons_.end()) tagIndex_.update(*person->second);
+        else tagIndex_.remove(id);
+    }
+    if(file == DB_EVENTS) dates_.invalidateEvent(id);
+    if(id == 0) return;
+    unsavedRecords_[file].insert(id);
 }
 
 bool FamilyTree::showHelpOnStartup(){
     return openHelp;
 }
 
+bool FamilyTree::startSave(bool compact, std::function<void()> finished){
+    if(saveTask_.valid()) return false;
+    if(!parser_.isRootDirectorySet()){
+        log("Directory was not set");
+        return false;
+    }
+    saveSnapshot_ = takeSnapshot(compact);
+    const DatabaseSnapshot* snapshot = saveSnapshot_.get();
+    Parser* parser = &parser_;
+    saveTask_ = std::async(std::launch::async, [snapshot, parser, finished](){
+        bool success = snapshot->write(*parser);
+        if(finished) finished();
+        return success;
+    });
+    return true;
+}
+
+void FamilyTree::storeCache(const std::string& key){
+    // Records are encoded now, before the journal or the user change them. Only writing the image is left for the background.
+    BinaryWriter writer;
+    writer.write(key);
+    encodeRecords(writer, allPersons_);
+    encodeRecords(writer, allEvents_);
+    encodeRecords(writer, allRelations_);
+    Parser* parser = &parser_;
+    cacheTask_ = std::async(std::launch::async, [parser, writer = std::move(writer)](){
+        parser->writeCache(writer.data());
+    });
+}
+
 bool FamilyTree::storeDatabase(){
-	if(parser_.isRootDirectorySet()){
-		{
-			std::stringstream ss;
-			printPeople(ss);
-			parser_.writeJSON(ss.str(), parser::JSON_PERSONS);
-		}
-		storeFileDatabase(GENERAL_FILE);
-		storeFileDatabase(MEDIA);
-		storeFileDatabase(NOTE);
-		{
-			std::stringstream ss;
-			ss << settings_;
-			parser_.writeJSON(ss.str(), parser::JSON_CONFIG);
-		}
-		{
-			std::stringstream ss;
-			printRelations(ss);
-			parser_.writeJSON(ss.str(), parser::JSON_RELATIONS);
-		}
-		{
-			std::stringstream ss;
-			printEvents(ss);
-			parser_.writeJSON(ss.str(), parser::JSON_EVENTS);
-		}
-		savedChanges_ = true;
-		return true;
-	}
-	else{
-		log("Directory was not set");
-		return false;
-	}
+    finishSave();
+    return storeDatabaseAsync() && finishSave();
+}
+
+bool FamilyTree::storeDatabaseAsync(std::function<void()> finished){
+    if(saveTask_.valid()) return false;
+    if(parser_.isRootDirectorySet()){
+        removeOrphanFiles(GENERAL_FILE);
+        removeOrphanFiles(MEDIA);
+        removeOrphanFiles(NOTE);
+    }
+    bool compact = std::any_of(unsavedFiles_.begin(), unsavedFiles_.end(), [](auto&& file){return file != DB_CONFIG;});
+    return startSave(compact || parser_.journalSize() > parser::JOURNAL_LIMIT, finished);
+}
+
+std::unique_ptr<DatabaseSnapshot> FamilyTree::takeSnapshot(bool compact){
+    auto snapshot = std::make_unique<DatabaseSnapshot>(settings_);
+    snapshot->compact = compact;
+    snapshot->unsavedRecords = std::move(unsavedRecords_);
+    unsavedRecords_.clear();
+    if(compact){
+        // Only the files changed as a whole are copied, the journal is folded into the others from the disk.
+        snapshot->unsavedFiles = unsavedFiles_;
+        // Damaged files are known only after the files are loaded.
+        if(snapshot->unsavedFiles.count(DB_FILES) || snapshot->unsavedFiles.count(DB_MEDIA) || snapshot->unsavedFiles.count(DB_NOTES))
+            loadFiles();
+        for(auto&& file : damagedFiles_){
+            if(!snapshot->unsavedFiles.erase(file)) continue;
+            // Damaged file cannot be rewritten as a whole, so all its records are journaled instead.
+            auto& ids = snapshot->unsavedRecords[file];
+            const RecordMap<File>& records = file == DB_FILES ? allFiles_ : file == DB_MEDIA ? allMedia_ : allNotes_;
+            for(auto&& [id, record] : records)
+                ids.insert(id);
+        }
+        snapshot->damagedFiles = damagedFiles_;
+    }
+    unsavedFiles_.clear();
+    // Events and relations print their templates, so they use the copied settings.
+    Settings* settings = &snapshot->settings;
+    auto copyRecord = [](const auto& record){return std::make_unique<std::remove_cvref_t<decltype(record)>>(record);};
+    auto copyEvent = [settings](const Event& event){return std::make_unique<Event>(event, settings);};
+    auto copyRelation = [settings](const Relation& rel){return std::make_unique<Relation>(rel, settings);};
+    auto copy = [&](DatabaseFile file, const std::set<size_t>* ids){
+        switch(file){
+            case DB_PERSONS:
+                copyRecords(allPersons_, snapshot->persons, ids, copyRecord);
+                break;
+            case DB_FILES:
+                loadFiles();
+                copyRecords(allFiles_, snapshot->files, ids, copyRecord);
+                break;
+            case DB_MEDIA:
+                loadFiles();
+                copyRecords(allMedia_, snapshot->media, ids, copyRecord);
+                break;
+            case DB_NOTES:
+                loadFiles();
+                copyRecords(allNotes_, snapshot->notes, ids, copyRecord);
+                break;
+            case DB_RELATIONS:
+                copyRecords(allRelations_, snapshot->relations, ids, copyRelation);
+                break;
+            case DB_EVENTS:
+                copyRecords(allEvents_, snapshot->events, ids, copyEvent);
+                break;
+            case DB_CONFIG:
+                break;
+        }
+    };
+    // Whole files are copied only when they are changed as a whole, otherwise only the changed records are needed.
+    for(auto&& file : snapshot->unsavedFiles)
+        copy(file, nullptr);
+    for(auto&& [file, ids] : snapshot->unsavedRecords){
+        if(!snapshot->unsavedFiles.count(file))
+            copy(file, &ids);
+    }
+    return snapshot;
 }
 
 void FamilyTree::getUrlFile(size_t id, std::string& fileUrl, FileType type){
@@ -1264,59 +2106,134 @@ void FamilyTree::getUrlFile(size_t id, std::string& fileUrl, FileType type){
     }
 }
 
-void FamilyTree::storeFileDatabase(FileType type){
-    std::stringstream ss;
-    switch(type){
-        case NOTE:
-            removeGeneralOrphanFile(allNotes_, type, parser::NOTES_DIR);
-			printFiles(ss, allNotes_, jsonlabel::NOTES);
-			parser_.writeJSON(ss.str(), parser::JSON_NOTES);
-			break;
+std::optional<File*> FamilyTree::storeFile(const std::string& filePath, size_t id, FileType type){
+    std::string fileName;
+    std::string blobName;
+    bool success;
+    // Notes are edited in place, so each of them needs its own copy.
+    bool deduplicate = settings_.getAppSettings().deduplicateFiles && type != NOTE;
+    switch (type){
         case MEDIA:
-            removeGeneralOrphanFile(allMedia_, type, parser::MEDIA_DIR);
-			printFiles(ss, allMedia_, jsonlabel::MEDIA);
-			parser_.writeJSON(ss.str(), parser::JSON_MEDIA);
-			break;
+            success = deduplicate ? parser_.storeBlob(filePath, parser::MEDIA_DIR, fileName, blobName)
+                                  : parser_.copyFile(filePath, parser::MEDIA_DIR, fileName, id);
+            break;
+        case NOTE:
+            success = parser_.copyFile(filePath, parser::NOTES_DIR, fileName, id);
+            break;
         case GENERAL_FILE:
         default:
-            removeGeneralOrphanFile(allFiles_, type, parser::FILES_DIR);
-			printFiles(ss, allFiles_, jsonlabel::FILES);
-			parser_.writeJSON(ss.str(), parser::JSON_FILES);
-			break;
+            success = deduplicate ? parser_.storeBlob(filePath, parser::FILES_DIR, fileName, blobName)
+                                  : parser_.copyFile(filePath, parser::FILES_DIR, fileName, id);
+            break;
     }
+    if(!success){
+        return {};
+    }
+    File* file = addFile(fileName, id, type);
+    file->setBlob(blobName);
+    fileReferences_[type].addBlob(blobName);
+    return file;
 }
 
 size_t FamilyTree::templatesBasedOnEventTemplate(size_t templateId){
-    size_t counter = std::count_if(allEvents_.begin(), allEvents_.end(),
-                                   [templateId](auto&& ev){return ev.second->getTemplate() == templateId;});
-    return counter;
+    auto it = eventsByTemplate_.find(templateId);
+    return it == eventsByTemplate_.end() ? 0 : it->second.size();
 }
 
 size_t FamilyTree::templatesBasedOnRelationTemplate(size_t templateId){
-    size_t counter = std::count_if(allRelations_.begin(), allRelations_.end(),
-                                   [templateId](auto&& rel){return rel.second->getTemplate() == templateId;});
-    return counter;
+    auto it = relationsByTemplate_.find(templateId);
+    return it == relationsByTemplate_.end() ? 0 : it->second.size();
 }
 
 void FamilyTree::updateEventsWithTemplate(size_t templ){
-    for(auto&& [id, event] : allEvents_){
-        if(event->getTemplate() == templ){
-            auto removed = event->updateToTemplate();
-            for(auto&& idp : removed){
-                auto optPerson = getPerson(idp);
-                if(!optPerson) continue;
-                (*optPerson)->removeEvent(event->getId());
-            }
-            if(event->getPersons().size() == 0){
-                removeEvent(event->getId());
-            }
+    auto indexed = eventsByTemplate_.find(templ);
+    if(indexed == eventsByTemplate_.end()) return;
+    // Emptied events are removed from the index, so its copy is iterated.
+    std::set<size_t> events = indexed->second;
+    for(auto&& id : events){
+        Event* event = allEvents_.at(id).get();
+        setUnsaved(DB_EVENTS, id);
+        auto removed = event->updateToTemplate();
+        for(auto&& idp : removed){
+            auto optPerson = getPerson(idp);
+            if(!optPerson) continue;
+            (*optPerson)->removeEvent(id);
+            setUnsaved(DB_PERSONS, idp);
+        }
+        if(event->getPersons().size() == 0){
+            removeEvent(id);
         }
     }
 }
 
+ValidationReport FamilyTree::validateDatabase(bool repair){
+    ValidationReport report = validation::validate(allPersons_, allRelations_, allEvents_, settings_, getKinship());
+    if(!repair) return report;
+    // Issues are ordered by their kinds, so relations and events are removed before the persons get listed in them again.
+    for(ValidationIssue& issue : report.issues)
+        issue.repaired = repairIssue(issue);
+    return report;
+}
+
 bool FamilyTree::writeConfig(const std::string& newPath){
     bool exists = std::any_of(projectPaths.begin(), projectPaths.end(), [newPath](auto&& path){return path == newPath;});
     if(!exists) projectPaths.push_back(newPath);
     parser_.writeConfig(projectPaths, openHelp);
     return !exists;
 }
+
+// =====================================================================
+// Database files
+// =====================================================================
+
+DatabaseFile database::file(FileType type){
+    switch(type){
+        case MEDIA:
+            return DB_MEDIA;
+        case NOTE:
+            return DB_NOTES;
+        case GENERAL_FILE:
+        default:
+            return DB_FILES;
+    }
+}
+
+const std::string& database::label(DatabaseFile file){
+    switch(file){
+        case DB_PERSONS:
+            return jsonlabel::PERSONS;
+        case DB_FILES:
+            return jsonlabel::FILES;
+        case DB_MEDIA:
+            return jsonlabel::MEDIA;
+        case DB_NOTES:
+            return jsonlabel::NOTES;
+        case DB_RELATIONS:
+            return jsonlabel::RELATIONS;
+        case DB_EVENTS:
+            return jsonlabel::EVENTS;
+        case DB_CONFIG:
+        default:
+            return jsonlabel::CONFIG;
+    }
+}
+
+const std::string& database::path(DatabaseFile file){
+    switch(file){
+        case DB_PERSONS:
+            return parser::JSON_PERSONS;
+        case DB_FILES:
+            return parser::JSON_FILES;
+        case DB_MEDIA:
+            return parser::JSON_MEDIA;
+        case DB_NOTES:
+            return parser::JSON_NOTES;
+        case DB_RELATIONS:
+            return parser::JSON_RELATIONS;
+        case DB_EVENTS:
+            return parser::JSON_EVENTS;
+        case DB_CONFIG:
+        default:
+            return parser::JSON_CONFIG;
+    }
+}
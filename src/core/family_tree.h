@@ -10,19 +10,105 @@
 #include <set>
 #include <memory>
 #include <functional>
+#include <future>
+#include <type_traits>
 #include <json/json.h>
 #include "file_parser.h"
 #include "config.h"
 #include "date.h"
+#include "database_validator.h"
+#include "date_index.h"
+#include "duplicate_detector.h"
 #include "person.h"
+#include "person_index.h"
 #include "strings.h"
 #include "family_tree_items.h"
+#include "inbreeding_calculator.h"
+#include "kinship_graph.h"
+#include "record_map.h"
+#include "relation_inference.h"
+#include "relationship_calculator.h"
+#include "tag_index.h"
+
+/// Files of the database which are stored separately.
+enum DatabaseFile {DB_PERSONS, DB_FILES, DB_MEDIA, DB_NOTES, DB_CONFIG, DB_RELATIONS, DB_EVENTS};
+
+/// Namespace for everything with database files.
+namespace database{
+    /// All files of the database.
+    constexpr DatabaseFile AllFiles[] = {DB_PERSONS, DB_FILES, DB_MEDIA, DB_NOTES, DB_CONFIG, DB_RELATIONS, DB_EVENTS};
+    /// Database file which holds meta-data of given type of files.
+    /// @param type Type of the files.
+    /// @return Database file with those files.
+    DatabaseFile file(FileType type);
+    /// JSON label of the records stored in the database file.
+    /// @param file Given database file.
+    /// @return Constant reference to the label.
+    const std::string& label(DatabaseFile file);
+    /// Name of the JSON file in the root directory.
+    /// @param file Given database file.
+    /// @return Constant reference to the name of the file.
+    const std::string& path(DatabaseFile file);
+}
+
+/// Copy of the unsaved part of the database taken at the start of a save.
+/// It is written to the disk on another thread, so the family tree can be edited in the meantime.
+class DatabaseSnapshot{
+    public:
+        /// Constructor copying the settings.
+        /// @param settings Current settings of the family tree.
+        explicit DatabaseSnapshot(const Settings& settings) : settings(settings){}
+        /// If the journal is folded into the files and cleared, otherwise the changed records are only appended to the journal.
+        bool compact = false;
+        /// Files which were not fully loaded. They are not rewritten and their records are kept in the journal.
+        std::set<DatabaseFile> damagedFiles;
+        /// Copied events.
+        RecordMap<Event> events;
+        /// Copied general files.
+        RecordMap<File> files;
+        /// Rewrite the files with records in the journal and clear it. The records are copied from the files on the disk and from the journal,
+        /// which do not change during the save, so the family tree does not have to be copied.
+        /// Damaged files and files which cannot be read are not rewritten and they keep their records in the journal.
+        /// @param parser Parser of the database.
+        /// @return True if the journal was folded or filtered.
+        bool foldJournal(Parser& parser) const;
+        /// Copied media.
+        RecordMap<File> media;
+        /// Copied notes.
+        RecordMap<File> notes;
+        /// Copied persons.
+        RecordMap<Person> persons;
+        /// Print the whole file of the database.
+        /// @param os Given output stream.
+        /// @param file Which file of the database is printed.
+        void printFile(std::ostream& os, DatabaseFile file) const;
+        /// Print single record of the database.
+        /// @param os Given output stream.
+        /// @param file Which file of the database holds the record.
+        /// @param id Id of the record.
+        /// @return False if there is no such record.
+        bool printRecord(std::ostream& os, DatabaseFile file, size_t id) const;
+        /// Copied relations.
+        RecordMap<Relation> relations;
+        /// Copied settings, which are used by the copied events and relations.
+        Settings settings;
+        /// Files of the database rewritten as a whole from the copied records.
+        std::set<DatabaseFile> unsavedFiles;
+        /// Changed records appended to the journal.
+        std::map<DatabaseFile, std::set<size_t>> unsavedRecords;
+        /// Write the snapshot to the database. It can be called from any thread.
+        /// @param parser Parser of the database.
+        /// @return True if everything was stored.
+        bool write(Parser& parser) const;
+};
 
 /// Main class for holding all data of a family tree. Also it acts as a bridge to the core of the application.
 class FamilyTree{
 	public:
 		/// Default constructor.
 		FamilyTree();
+		/// Destructor, which waits for the running save.
+		~FamilyTree();
 		/// Add new event to the family tree.
 		/// @return Pointer to the new event.
 		Event* addEvent();
@@ -66,6 +152,9 @@ class FamilyTree{
 		void clear();
 		/// Clear all project paths except for this one.
 		void clearProjectPaths();
+		/// Fold the journal back to the JSON files of the database and remove the journal. It waits until the files are written.
+		/// @return If the storing was successful.
+		bool compactDatabase();
 		/// Copy an existing file.
 		/// @param filePath Path to the original file on the disk.
 		/// @param type What type of file it is.
@@ -96,13 +185,84 @@ class FamilyTree{
 		/// @param relTemplates Vector of relation templates.
 		/// @param filename Path to the output file.
 		void exportTemplates(const std::vector<size_t>& eventTemplates, const std::vector<size_t>& relTemplates, const std::string& filename);
+		/// Wait for the save (and the write of the binary image) running in the background and process its result.
+		/// Unsaved changes are restored if the save failed, so they are stored next time.
+		/// @return False if the last save failed. True if it succeeded or there was no save.
+		bool finishSave();
+		/// Find the shortest chain of relations of any kind between two persons.
+		/// @param first Id of the first person.
+		/// @param second Id of the second person.
+		/// @return Optionally relatives on the way from the first person to the second one, each named in its relation with the previous person.
+		/// Empty vector for the same person and empty optional if the persons are not connected.
+		std::optional<std::vector<Kinship>> findConnection(size_t first, size_t second);
+		/// Find persons or events with the date in the range, for example born in 1800 to 1850 or events in 1914.
+		/// Unknown month or day of the bounds extends the range to the whole year or month, intervals are found by their first dates.
+		/// @param kind Whether births, deaths or events are searched.
+		/// @param from First date of the range, empty for no lower bound.
+		/// @param to Last date of the range, empty for no upper bound.
+		/// @return Ids of the persons or events with their date keys in chronological order, valid until the next change of persons or events.
+		std::span<const DatedRecord> findDates(DateKind kind, const Date& from, const Date& to);
+		/// Find pairs of persons which are probably recorded twice, for example after appending another project.
+		/// @param threshold Minimum score of a reported pair from 0 to 1.
+		/// @return Candidates for merging, the most similar first.
+		std::vector<DuplicateCandidate> findDuplicates(double threshold = duplicates::THRESHOLD);
+		/// Find Wright's coefficient of inbreeding of the person from the kinship of its father and mother.
+		/// @param person Id of the person.
+		/// @return Coefficient from 0 to 1, for example 1/16 for a child of first cousins.
+		double findInbreeding(size_t person);
+		/// Find the inbreeding coefficients of many persons at once on several threads.
+		/// @param persons Ids of the persons.
+		/// @return Coefficients in the order of the persons.
+		std::vector<double> findInbreedings(const std::vector<size_t>& persons);
+		/// Find the kinship coefficient of two persons.
+		/// @param first Id of the first person.
+		/// @param second Id of the second person.
+		/// @return Coefficient from 0 to 1, for example 1/4 for a parent and a child.
+		double findKinship(size_t first, size_t second);
+		/// Find the matrix of kinship coefficients of the persons on several threads.
+		/// @param persons Ids of the persons.
+		/// @return Symmetric matrix of the coefficients in the order of the persons.
+		std::vector<std::vector<double>> findKinships(const std::vector<size_t>& persons);
+		/// Find how the pedigree of the person collapsed, the numbers of distinct and of expected ancestors in each generation.
+		/// @param person Id of the person.
+		/// @param generations Number of generations, 0 for all of them.
+		/// @return Generations from the parents up to the oldest known ancestors.
+		std::vector<CollapsedGeneration> findPedigreeCollapse(size_t person, int generations = 0);
+		/// Find persons by their names, surnames, maiden names, titles, places and values of tags.
+		/// Words of the query match beginnings of words of the person regardless of case and diacritics, longer words also with a typo.
+		/// @param query Searched text.
+		/// @param limit Maximum number of results, 0 means all of them.
+		/// @return Ids of the persons matching all words of the query, the best matches first. Empty for an empty query.
+		std::vector<size_t> findPersons(const std::string& query, size_t limit = 0);
+		/// Find persons with the tag.
+		/// @param tag Name of the tag.
+		/// @return Ids of the persons in ascending order.
+		std::vector<size_t> findPersonsWithTag(const std::string& tag);
+		/// Find persons with the tag of given value.
+		/// @param tag Name of the tag.
+		/// @param value Exact value of the tag.
+		/// @return Ids of the persons in ascending order.
+		std::vector<size_t> findPersonsWithTag(const std::string& tag, const std::string& value);
+		/// Find how the second person is related to the first one by blood, through their closest common ancestor.
+		/// @param first Id of the first person.
+		/// @param second Id of the second person.
+		/// @return Relationship with the path between the persons, the ancestor is 0 if they are not related.
+		Relationship findRelationship(size_t first, size_t second);
+		/// Find how all persons are related to the proband by blood.
+		/// @param proband Id of the proband.
+		/// @return Relationships without paths by ids of the related persons.
+		std::map<size_t, Relationship> findRelationships(size_t proband);
+		/// Get all known dates of given kind.
+		/// @param kind Whether births, deaths or events are returned.
+		/// @return Ids of the persons or events with their date keys in chronological order, valid until the next change of persons or events.
+		std::span<const DatedRecord> getDates(DateKind kind);
 		/// Get pointer to the event.
 		/// @param id Id of the event.
 		/// @return Get optionally pointer to the event or empty.
 		std::optional<Event*> getEvent(size_t id);
 		/// Get constant reference to the container of all events.
 		/// @return Constant reference to the map of all events.
-		const std::map<size_t, std::unique_ptr<Event>>& getEvents() const;
+		const RecordMap<Event>& getEvents() const;
 		/// Get pointer to given file.
 		/// @param id Id of the file.
 		/// @param type What type of file to get.
@@ -116,7 +276,10 @@ class FamilyTree{
 		/// Get constant reference to the vector of all files.
 		/// @param type What type of files the vector has.
 		/// @return Constant reference to the map of files with given type.
-		const std::map<size_t, std::unique_ptr<File>>& getFiles(FileType type = GENERAL_FILE);
+		const RecordMap<File>& getFiles(FileType type = GENERAL_FILE);
+		/// Get the graph of relatives of all persons. It is built again if persons were added or removed or relations or templates changed since the last call.
+		/// @return Constant reference to the graph, valid until the next change of the persons, relations or templates.
+		const KinshipGraph& getKinship();
         /// Get all the orphan files.
 		/// @return Vector of all files, that will be permanently deleted.
 		std::vector<std::string> getOrphanFiles();
@@ -125,7 +288,7 @@ class FamilyTree{
 		Person* getMainPerson();
 		/// Get the container of persons.
 		/// @return Constant reference to the container.
-		const std::map<size_t, std::unique_ptr<Person>>& getPersons();
+		const RecordMap<Person>& getPersons();
 		/// Get pointer to the person by its id.
 		/// @param id Id of the person.
 		/// @return Optionally pointer to the person with its id or empty.
@@ -139,7 +302,7 @@ class FamilyTree{
 		std::optional<Relation*> getRelation(size_t id);
 		/// Get the constant reference to the map of all relations.
 		/// @return Constant reference to the map of all relations.
-		const std::map<size_t, std::unique_ptr<Relation>>& getRelations();
+		const RecordMap<Relation>& getRelations();
 		/// Get relation suggestions to the given relation.
 		/// @param relId Id of the given relation.
 		/// @return vector of all suggestions.
@@ -164,15 +327,30 @@ class FamilyTree{
         /// @param filePath Path to the file.
         /// @return If the import was successful or not and number of imported templates.
         std::pair<bool, size_t> importTemplates(const std::string& filePath);
+		/// Infer relations missing in the whole tree by the same rules as the suggestions to one relation.
+		/// @param pageSize Maximum number of suggestions on one page.
+		/// @return Pages of suggestions, suggestions within one family are kept on the same page if they fit in it.
+		std::vector<std::vector<RelationSuggestion>> inferRelations(size_t pageSize);
 		/// If the root directory for the database was already set.
 		/// @return True if the directory was set.
 		bool isDirectorySet();
 		/// If all changes are saved.
 		/// @return True if all changes are saved, otherwise false.
 		bool isSaved() const;
+		/// If a save is running in the background or its result was not processed yet.
+		/// @return True if finishSave should be called.
+		bool isSaving() const;
 		/// Log error code to the parser.
 		/// @param error What is the text of the error.
-		void log(const std::string& error);
+		/// @param level Severity of the error.
+		void log(const std::string& error, LogLevel level = LOG_ERROR);
+		/// Merge the second person into the first one. Relations and events of the second person are moved to the first one,
+		/// relations duplicating the existing ones or between both persons are removed. Unknown fields of the first person are taken from the second one
+		/// and its files are put in a folder named after it. The second person is removed.
+		/// @param kept Id of the kept person.
+		/// @param merged Id of the removed person.
+		/// @return True if both persons existed and were merged.
+		bool mergePersons(size_t kept, size_t merged);
 		/// Open a database from its root directory.
 		/// @param dirPath Path to the root directory.
 		/// @param errorMessage To show what was the potential error.
@@ -215,16 +393,29 @@ class FamilyTree{
 		/// Remove relation template and all relations based on this template.
 		/// @param id Id of the template.
 		void removeRelationTemplate(size_t id);
+		/// Remove the tag from the settings and from all persons with it.
+		/// @param tag Name of the tag.
+		/// @return Number of persons which had the tag.
+		size_t removeTag(const std::string& tag);
 		/// Rename given file.
 		/// @param id Id of the file.
 		/// @param newFilename New file name for the file.
 		/// @param type What type is the file.
 		void renameFile(size_t id, const std::string& newFilename, FileType type);
+		/// Rename the tag in the settings and in all persons with it. If a person already has the new tag, its value is replaced.
+		/// @param tag Name of the tag.
+		/// @param newTag New name of the tag.
+		/// @return Number of persons which had the tag.
+		size_t renameTag(const std::string& tag, const std::string& newTag);
 		/// Restore backup file from the database. Also load the project again.
 		/// @param backupFile Which is the backup file.
 		/// @param errorMessage If error occurred show it there.
 		/// @return If the parsing of restored database was successful or not.
         bool restoreBackup(const std::string& backupFile, std::string& errorMessage);
+		/// Set the template of the event, which keeps the index of templates up to date.
+		/// @param eventId Id of the event.
+		/// @param templId Id of the used template.
+		void setEventTemplate(size_t eventId, size_t templId);
 		/// Set the main person.
 		/// @param p New main person.
 		void setMainPerson(Person* p);
@@ -237,14 +428,31 @@ class FamilyTree{
 		/// @param pers2Id Id of the second person.
 		/// @param templId Id of the used template.
 		void setRelation(size_t relId, size_t pers1Id, size_t pers2Id, size_t templId);
-		/// Set unsaved state.
+		/// Set the template of the relation, which keeps the index of templates up to date.
+		/// @param relId Id of the relation.
+		/// @param templId Id of the used template.
+		void setRelationTemplate(size_t relId, size_t templId);
+		/// Set unsaved state of all files of the database.
 		void setUnsaved();
+		/// Set unsaved state of one file of the database. The whole file will be rewritten.
+		/// @param file Which file of the database was changed.
+		void setUnsaved(DatabaseFile file);
+		/// Set unsaved state of one record of the database. Only the record will be written to the journal.
+		/// @param file Which file of the database holds the record.
+		/// @param id Id of the changed (or removed) record. Id 0 stands for no record and it is ignored.
+		void setUnsaved(DatabaseFile file, size_t id);
 		/// If help dialog should be shown.
 		/// @return True if it should be shown.
 		bool showHelpOnStartup();
-		/// Store the whole database to its files.
+		/// Store the database. Changed records are appended to the journal, the journal is compacted
+		/// when it grows too big or when a whole file has to be rewritten. It waits until the data are written.
 		/// @return If the storing was successful.
 		bool storeDatabase();
+		/// Start storing the database in the background. Unsaved data are copied first, so the tree can be edited during the save.
+		/// When the save is done, finishSave has to be called.
+		/// @param finished Function called from the background thread when the data are written.
+		/// @return False if the directory is not set or another save is running.
+		bool storeDatabaseAsync(std::function<void()> finished = nullptr);
 		/// Get the number of events based on this event template.
 		/// @param templateId Id of the event template.
 		/// @return Number of events using this event template.
@@ -256,68 +464,85 @@ class FamilyTree{
 		/// Update events based on the changed template.
 		/// @param templ Id of the changed template.
 		void updateEventsWithTemplate(size_t templ);
+		/// Check references between all persons, relations and events and find persons which are their own ancestors.
+		/// @param repair If broken references should be repaired. Missing templates and cycles of ancestry are only reported.
+		/// @return Report of all found inconsistencies.
+		ValidationReport validateDatabase(bool repair = false);
 		/// Write to the configuration file and before add new one if it is not present.
 		/// @param newPath Path to the new project.
 		/// @return True if it was added. False if it was already present.
 		bool writeConfig(const std::string& newPath);
 	private:
 	    /// All the events in the tree.
-		std::map<size_t, std::unique_ptr<Event>> allEvents_;
+		RecordMap<Event> allEvents_;
 	    /// All files in app.
-		std::map<size_t, std::unique_ptr<File>> allFiles_;
+		RecordMap<File> allFiles_;
 		/// All media in app.
-		std::map<size_t, std::unique_ptr<File>> allMedia_;
+		RecordMap<File> allMedia_;
 		/// All notes in app.
-		std::map<size_t, std::unique_ptr<File>> allNotes_;
+		RecordMap<File> allNotes_;
 	    /// Map of all persons in family tree.
-		std::map<size_t, std::unique_ptr<Person>> allPersons_;
+		RecordMap<Person> allPersons_;
 		/// All relations in the tree.
-		std::map<size_t, std::unique_ptr<Relation>> allRelations_;
+		RecordMap<Relation> allRelations_;
+		/// Describe the JSON files and templates which the binary image is made of.
+		/// @return Key of the image, or an empty string if the files cannot be read.
+		std::string cacheKey();
+		/// Running write of the binary image.
+		std::future<void> cacheTask_;
 		/// Check file consistence of a single type.
 		/// @param os Where to write error.
 		/// @param type Which type to look for.
 		bool checkFileTypeConsistence(std::ostream& os, FileType type);
+		/// Files of the database which were not fully loaded (they are corrupted), so they are never rewritten.
+		std::set<DatabaseFile> damagedFiles_;
+		/// Sorted dates of births, deaths and events.
+		DateIndex dates_;
+		/// Remove the record of the file and update its references.
+		/// @param container Container holding the file.
+		/// @param type Type of the file.
+		/// @param id Id of the file.
+		/// @return True if the record was removed and no other record uses its stored file.
+		bool eraseFile(RecordMap<File>& container, FileType type, size_t id);
 	    /// Last free index for event. Always start from 1.
 		size_t event_index_;
+		/// Ids of events using each event template.
+		std::map<size_t, std::set<size_t>> eventsByTemplate_;
 	    /// Last free id for file. Always start from 1.
 		size_t file_index_;
+		/// References of files, media and notes from the virtual drives of all persons.
+		std::map<FileType, FileReferences> fileReferences_;
 		/// Get all files that would be removed.
 		/// @param files Where to store these files.
 		/// @param container Which map to use.
 		/// @param type Which type we are using.
-		void getGeneralOrphaFiles(std::vector<std::string>& files, const std::map<size_t, std::unique_ptr<File>>& container, FileType type);
-		/// Append relation suggestions by a parent relations.
-		/// @param suggestions Container of all suggestions.
-		/// @param parent Which person is parent.
-		/// @param child Which person is child.
-		/// @param id Id of this relation.
-		/// @param trait Trait of this relation.
-		/// @param forbiddenPersonParent Which persons are forbidden to bind to with a parent.
-		/// @param forbiddenPersonChild Which persons are forbidden to bind to with a child.
-		void getParentSuggestions(std::vector<RelationSuggestion>& suggestions, const Person* parent, const Person* child, size_t id, Trait trait,
-                            const std::set<size_t>& forbiddenPersonParent, const std::set<size_t>& forbiddenPersonChild);
-		/// Append relation suggestions by partners relations.
-		/// @param suggestions Container of all suggestions.
-		/// @param person Which person is the main one.
-		/// @param second Which person is the second one.
-		/// @param id Id of this relation.
-		/// @param forbiddenPersons Which persons are forbidden to bind to a given person.
-		void getPartnersSuggestions(std::vector<RelationSuggestion>& suggestions, const Person* person, const Person* second, size_t id, const std::set<size_t>& forbiddenPersons);
-		/// Append relation suggestions by siblings relations.
-		/// @param suggestions Container of all suggestions.
-		/// @param person Which person is the main one.
-		/// @param second Which person is the second one.
-		/// @param id Id of this relation. -- This will be changed
-		/// @param forbiddenPersons Which persons are forbidden to bind to a given person.
-		void getSiblingsSuggestions(std::vector<RelationSuggestion>& suggestions, const Person* person, const Person* second, size_t id, const std::set<size_t>& forbiddenPersons);
+		void getGeneralOrphaFiles(std::vector<std::string>& files, const RecordMap<File>& container, FileType type);
+		/// Get the calculator of inbreeding. It is built again with the parents if persons, relations or templates changed since the last call.
+		/// @return Reference to the calculator.
+		InbreedingCalculator& getInbreeding();
+		/// Coefficients of kinship and inbreeding over the parents of persons.
+		InbreedingCalculator inbreeding_;
+		/// Build the indexes of templates and of file references from all loaded records.
+		void indexRecords();
+		/// Load persons, events and relations from the binary image instead of parsing JSON files.
+		/// @param key Key of the current JSON files, the image is used only if it was made from the same files.
+		/// @return True if the image was loaded.
+		bool loadCache(const std::string& key);
 		/// Load one single file from the database.
 		/// @param file Which file in database is being loaded.
 		/// @param reader Which function read the data and load them.
 		/// @param errorMessage Where will the error message stored.
 		/// @return If the parsing was successful or not.
 		bool loadDatabaseFile(const std::string& file, std::function<void(const Json::Value&)> reader, std::string& errorMessage);
+		/// Wait until the files, media and notes are loaded in the background and merge them to their containers.
+		/// It has to be called before the containers are used.
+		void loadFiles();
+		/// Relatives of all persons resolved from the relations.
+		KinshipGraph kinship_;
 		/// Main person showing as the centre of the tree.
 		Person* mainPerson_;
+		/// Full-text index of persons.
+		PersonIndex personIndex_;
 		/// Last free id for media. Always start from 1.
 		size_t media_index_;
 		/// Last free id for note. Always start from 1.
@@ -326,62 +551,106 @@ class FamilyTree{
 		bool openHelp;
 		/// Parser for working with locally stored database.
 		Parser parser_;
+		/// Records of files, media and notes from the journal, which are applied after the files are loaded.
+		std::vector<Json::Value> pendingFileRecords_;
+		/// Files, media and notes being loaded in the background, with the flag if their file was read successfully.
+		std::map<FileType, std::future<std::pair<bool, std::vector<std::unique_ptr<File>>>>> pendingFiles_;
 		/// Last free id for person. Always start from 1.
 		size_t person_index_;
 		/// Print custom CSS.
 		/// @param dirPath Path to the directory for the CSS.
 		void printCss(const std::string& dirPath);
-		/// Print all files from vector container.
-		/// @param os Given stream.
-		/// @param container Given container of files.
-		/// @param label What is the label in JSON file.
-		void printFiles(std::ostream& os, const std::map<size_t, std::unique_ptr<File>>& container, const std::string& label);
-		/// Print all events.
+		/// Print the exported persons with their events, relations and used templates.
 		/// @param os Given output stream.
-		void printEvents(std::ostream& os);
+		/// @param includingEvents If events of the persons are exported.
+		/// @param includingRelations If relations of the persons are exported.
+		void printExport(std::ostream& os, bool includingEvents, bool includingRelations);
 		/// Print single person to an output in html format.
 		/// @param os Which output stream to use.
 		/// @param links True if they should be links to other persons.
 		/// @param p Which person is to be printed.
 		void printHtmlPerson(std::ostream& os, bool links, Person* p);
-		/// Print all the people into a stream in a semi-structured JSON format.
-		/// @param os Given stream.
-		void printPeople(std::ostream& os);
-		/// Print all relations.
-		/// @param os Given output stream.
-		void printRelations(std::ostream& os);
 		/// Paths to existing projects.
 		std::vector<std::string> projectPaths;
+		/// Read and load single event from its JSON value.
+		/// @param value Loaded record of the event.
+		void readJsonEvent(const Json::Value& value);
         /// Read and load all events from its JSON value.
 		/// @param value Loaded value from the source file.
 		void readJsonEvents(const Json::Value& value);
-		/// Read and load meta-data about files from JSON value.
-		/// @param value Loaded value from the source file.
+		/// Read and load meta-data about single file from JSON value.
+		/// @param value Loaded record of the file.
 		/// @param container Which vector to use for storing files.
-		/// @param label Which label was used in the JSON file.
 		/// @param index Indexing of given container.
-		void readJsonFiles(const Json::Value& value, std::map<size_t, std::unique_ptr<File>>& container, const std::string& label, size_t& index);
-		/// Read and load people from given JSON value.
-		/// @param value Loaded value from the file.
-		void readJsonPeople(const Json::Value& value);
+		/// @param type Type of the file.
+		void readJsonFile(const Json::Value& value, RecordMap<File>& container, size_t& index, FileType type);
+		/// Read and load single person from given JSON value.
+		/// @param value Loaded record of the person.
+		void readJsonPerson(const Json::Value& value);
+		/// Read and load single relation from its JSON value.
+		/// @param value Loaded record of the relation.
+		void readJsonRelation(const Json::Value& value);
 		/// Read and load all relations from its JSON value.
 		/// @param value Loaded value from the source file.
 		void readJsonRelations(const Json::Value& value);
+		/// Start or stop counting files in the virtual drives of the person.
+		/// @param person Person added to or removed from the tree.
+		/// @param referenced True if the person is in the tree.
+		void referenceFiles(Person& person, bool referenced);
+		/// Apply one record from the journal.
+		/// @param value Loaded record of the journal.
+		void readJournalRecord(const Json::Value& value);
 		/// Last free index for relation.
 		size_t relation_index_;
+		/// Ids of relations using each relation template.
+		std::map<size_t, std::set<size_t>> relationsByTemplate_;
+		/// Relationships of persons through their common ancestors.
+		RelationshipCalculator relationships_;
 		/// Remove general orphan file.
 		/// @param container Which container holding files is to be used.
 		/// @param type Which type will be used.
 		/// @param dir Which directory in database to use.
 		/// @return Number of remove files.
-		size_t removeGeneralOrphanFile(std::map<size_t, std::unique_ptr<File>>& container, FileType type, const std::string& dir);
-		/// If all changes were saved or not.
-		bool savedChanges_;
+		size_t removeGeneralOrphanFile(RecordMap<File>& container, FileType type, const std::string& dir);
+		/// Remove orphan files of given type.
+		/// It is skipped if neither files of this type nor persons (owners of the files) were changed.
+		/// @param type What type of files are checked.
+		void removeOrphanFiles(FileType type);
+		/// Repair one broken reference. The records are checked again, because an earlier repair could have changed them.
+		/// @param issue Found inconsistency.
+		/// @return True if the reference is not broken anymore.
+		bool repairIssue(const ValidationIssue& issue);
+		/// Snapshot written by the running save.
+		std::unique_ptr<DatabaseSnapshot> saveSnapshot_;
+		/// Running save, its result says if the snapshot was stored.
+		std::future<bool> saveTask_;
 		/// Settings of the app.
 		Settings settings_;
-		/// Store file database when putting file to database. Also remove all orphan files.
-		/// @param type What type of files are saved.
-		void storeFileDatabase(FileType type);
+		/// Write the binary image of loaded persons, events and relations on a background thread.
+		/// @param key Key of the JSON files the data were loaded from.
+		void storeCache(const std::string& key);
+		/// Store the copy of the file in the database and create its record.
+		/// With deduplication enabled, files and media with the same content share one stored file.
+		/// @param filePath Path to the original file on the disk.
+		/// @param id Id of the new record.
+		/// @param type Type of the file.
+		/// @return Pointer to the new record if the file was stored.
+		std::optional<File*> storeFile(const std::string& filePath, size_t id, FileType type);
+		/// Take a snapshot of the database and write it on a background thread.
+		/// @param compact If the files are rewritten as a whole instead of appending to the journal.
+		/// @param finished Function called from the background thread when the data are written.
+		/// @return False if the directory is not set or another save is running.
+		bool startSave(bool compact, std::function<void()> finished);
+		/// Copy the unsaved part of the database and mark it as saved.
+		/// @param compact If the files are rewritten as a whole, so they are copied as a whole.
+		/// @return New snapshot.
+		std::unique_ptr<DatabaseSnapshot> takeSnapshot(bool compact);
+		/// Values of tags of all persons, kept up to date on every change of a person.
+		TagIndex tagIndex_;
+		/// Files of the database which have to be rewritten as a whole.
+		std::set<DatabaseFile> unsavedFiles_;
+		/// Changed records of each file of the database.
+		std::map<DatabaseFile, std::set<size_t>> unsavedRecords_;
 };
 
 #endif
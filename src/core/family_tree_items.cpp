@@ -7,6 +7,10 @@
 
 Event::Event(Settings* settings) : id_(1), settings_(settings), template_(1){}
 
+Event::Event(const Event& other, Settings* settings) : Event(other){
+    settings_ = settings;
+}
+
 void Event::addPerson(size_t person, const std::string& role){
 	if(role == events::NO_ROLE){
         if(std::any_of(persons_.begin(), persons_.end(), [person](auto&& pair){return pair.second == person;}))
@@ -39,7 +43,7 @@ size_t Event::getId() const{
 	return id_;
 }
 
-const std::vector<std::pair<std::string, size_t>>& Event::getPersons() const{
+const std::vector<std::pair<Symbol, size_t>>& Event::getPersons() const{
 	return persons_;
 }
 
@@ -79,6 +83,20 @@ void Event::printHtml(std::ostream& os, const std::vector<std::pair<std::string,
     }
 }
 
+void Event::readBinary(BinaryReader& reader){
+	id_ = reader.read<size_t>();
+	template_ = reader.read<size_t>();
+	size_t persons = reader.read<size_t>();
+	persons_.resize(persons);
+	for(auto&& [role, person] : persons_){
+		reader.read(role);
+		person = reader.read<size_t>();
+	}
+	date_.readBinary(reader);
+	reader.read(place_);
+	reader.read(text_);
+}
+
 void Event::readJson(const Json::Value& value){
 	id_ = value[jsonlabel::ID].asUInt64();
 	template_ = value[jsonlabel::TEMPLATE].asUInt64();
@@ -175,6 +193,19 @@ std::vector<size_t> Event::updateToTemplate(){
     return removed;
 }
 
+void Event::writeBinary(BinaryWriter& writer) const{
+	writer.write(id_);
+	writer.write(template_);
+	writer.write(persons_.size());
+	for(auto&& [role, person] : persons_){
+		writer.write(role);
+		writer.write(person);
+	}
+	date_.writeBinary(writer);
+	writer.write(place_);
+	writer.write(text_);
+}
+
 // =====================================================================
 // functions for Event
 // =====================================================================
@@ -192,15 +223,15 @@ std::ostream& operator <<(std::ostream& os, const Event& e){
         first = false;
         os << "{\"" << jsonlabel::PERSON << "\":" << person;
         if(role != events::NO_ROLE)
-            os << ",\"" << jsonlabel::ROLE << "\":\"" << role << "\"";
+            os << ",\"" << jsonlabel::ROLE << "\":" << JsonString(role);
         os << "}";
     }
     os << "]";
 	if(templ->containsDate())
 		os << "," << e.getDate();
 	if(templ->containsPlace())
-		os << ", \"" << jsonlabel::PLACE << "\":\"" << e.getPlace() << "\"";
-	os << ",\"" << jsonlabel::TEXT << "\":\"" << e.getText() << "\"";
+		os << ", \"" << jsonlabel::PLACE << "\":" << JsonString(e.getPlace());
+	os << ",\"" << jsonlabel::TEXT << "\":" << JsonString(e.getText());
 	os << "}";
 	return os;
 }
@@ -211,6 +242,10 @@ std::ostream& operator <<(std::ostream& os, const Event& e){
 
 Relation::Relation(Settings* settings) : id_(1), person1_(0), person2_(0), settings_(settings), template_(0){}
 
+Relation::Relation(const Relation& other, Settings* settings) : Relation(other){
+    settings_ = settings;
+}
+
 size_t Relation::getFirstPerson() const{
 	return person1_;
 }
@@ -300,6 +335,13 @@ void Relation::printHtml(std::ostream& os, const std::string& firstPerson, const
     os << ".</info></p>" << std::endl;
 }
 
+void Relation::readBinary(BinaryReader& reader){
+	id_ = reader.read<size_t>();
+	person1_ = reader.read<size_t>();
+	person2_ = reader.read<size_t>();
+	template_ = reader.read<size_t>();
+}
+
 void Relation::readJson(const Json::Value& value){
 	id_ = value[jsonlabel::ID].asUInt64();
 	person1_ = value[jsonlabel::FIRST_PERSON].asUInt64();
@@ -329,6 +371,13 @@ std::string Relation::str(const std::string& firstPerson, const std::string& sec
     return ss.str();
 }
 
+void Relation::writeBinary(BinaryWriter& writer) const{
+	writer.write(id_);
+	writer.write(person1_);
+	writer.write(person2_);
+	writer.write(template_);
+}
+
 // =====================================================================
 // functions for Relation
 // =====================================================================
@@ -355,6 +404,10 @@ RelationSuggestion::RelationSuggestion(size_t lockedP, size_t suggestedP, bool p
 
 File::File() : id_(1){}
 
+const std::string& File::getBlob() const{
+	return blob_;
+}
+
 const std::string& File::getFilename() const{
 	return filename_;
 }
@@ -364,6 +417,7 @@ size_t File::getId() const{
 }
 
 std::string File::getRealName() const{
+	if(!blob_.empty()) return blob_;
 	std::stringstream ss;
 	ss << id_ << "-" << filename_;
 	return ss.str();
@@ -372,6 +426,11 @@ std::string File::getRealName() const{
 void File::readJson(const Json::Value& value){
 	id_ = value[jsonlabel::ID].asUInt64();
 	filename_ = value[jsonlabel::NAME].asString();
+	blob_ = value[jsonlabel::BLOB].asString();
+}
+
+void File::setBlob(const std::string& blob){
+	blob_ = blob;
 }
 
 void File::setFilename(const std::string& fileName){
@@ -388,7 +447,9 @@ void File::setId(size_t id){
 
 std::ostream& operator <<(std::ostream& os, const File& f){
 	os << "{\"" << jsonlabel::ID << "\":" << f.getId();
-	os << ", \"" << jsonlabel::NAME << "\":\"" << f.getFilename() << "\"";
+	os << ", \"" << jsonlabel::NAME << "\":" << JsonString(f.getFilename());
+	if(!f.getBlob().empty())
+		os << ", \"" << jsonlabel::BLOB << "\":" << JsonString(f.getBlob());
 	os << "}";
 	return os;
 }
@@ -7,9 +7,12 @@
 #include <vector>
 #include <ostream>
 #include <json/json.h>
+#include "binary_cache.h"
 #include "config.h"
 #include "date.h"
 #include "strings.h"
+#include "json_string.h"
+#include "symbol.h"
 
 /// Class holding data for a single event.
 class Event{
@@ -17,6 +20,10 @@ class Event{
 		/// Default constructor.
 		/// @param settings The settings used in app (to access the template).
 		explicit Event(Settings* settings);
+		/// Copy the event, but access the templates through other settings.
+		/// @param other Copied event.
+		/// @param settings The settings used by the copy.
+		Event(const Event& other, Settings* settings);
 		/// Add person to the vector.
 		/// @param person Id of the person.
 		/// @param role Special role for this person, or empty if he does not have special role.
@@ -34,7 +41,7 @@ class Event{
 		size_t getId() const;
 		/// Get the vector of persons.
 		/// @return Constant reference to the vector of persons.
-		const std::vector<std::pair<std::string, size_t>>& getPersons() const;
+		const std::vector<std::pair<Symbol, size_t>>& getPersons() const;
 		/// Get the place of this event.
 		/// @return Constant reference to the place.
 		const std::string& getPlace() const;
@@ -51,6 +58,9 @@ class Event{
 		/// @param os Given output stream,
 		/// @param persons List of pairs for role&person names.
 		void printHtml(std::ostream& os, const std::vector<std::pair<std::string, std::string>>& persons);
+		/// Read the event from the binary image.
+		/// @param reader Reader of the image.
+		void readBinary(BinaryReader& reader);
 		/// Read the relation from JSON value.
 		/// @param value The JSON value from file.
 		void readJson(const Json::Value& value);
@@ -79,15 +89,18 @@ class Event{
 		/// Update this event to the changed template.
 		/// @return Vector of all persons which were removed.
 		std::vector<size_t> updateToTemplate();
+		/// Write the event to the binary image.
+		/// @param writer Writer of the image.
+		void writeBinary(BinaryWriter& writer) const;
 	private:
 	    /// Date of this event.
 		WrappedDate date_;
 		/// Id of this event.
 		size_t id_;
         /// People with their roles.
-		std::vector<std::pair<std::string, size_t>> persons_;
+		std::vector<std::pair<Symbol, size_t>> persons_;
 		/// Place of this event.
-		std::string place_;
+		Symbol place_;
 		/// Settings used in app.
 		Settings* settings_;
 		/// Template for this event.
@@ -109,6 +122,10 @@ class Relation{
 	    /// Default constructor.
 	    /// @param settings Pointer to the settings of the app.
 	    explicit Relation(Settings* settings);
+	    /// Copy the relation, but access the templates through other settings.
+	    /// @param other Copied relation.
+	    /// @param settings The settings used by the copy.
+	    Relation(const Relation& other, Settings* settings);
 	    /// Get the first person of the relation.
 		/// @return Id of the first person.
 		size_t getFirstPerson() const;
@@ -156,6 +173,9 @@ class Relation{
 		/// @param secondPerson Name of the second person.
 		/// @param promoted What is the name of the promoted version.
 		void printHtml(std::ostream& os, const std::string& firstPerson, const std::string& secondPerson, const std::string& promoted);
+		/// Read the relation from the binary image.
+		/// @param reader Reader of the image.
+		void readBinary(BinaryReader& reader);
 		/// Read the relation from JSON value.
 		/// @param value The JSON value from file.
 		void readJson(const Json::Value& value);
@@ -174,6 +194,9 @@ class Relation{
 		/// @param secondPerson String representing the second person.
         /// @return String representing the relation.
 		std::string str(const std::string& firstPerson, const std::string& secondPerson) const;
+		/// Write the relation to the binary image.
+		/// @param writer Writer of the image.
+		void writeBinary(BinaryWriter& writer) const;
 	private:
 	    /// Id of this relation.
 		size_t id_;
@@ -220,18 +243,24 @@ class File{
 	public:
 	    /// Default constructor.
 	    File();
+	    /// Get the name of the shared stored file.
+		/// @return Constant reference to the name, empty if the file is stored on its own.
+		const std::string& getBlob() const;
 	    /// Get the file name.
 		/// @return Constant reference to the file name.
 		const std::string& getFilename() const;
 		/// Get the id of the file.
 		/// @return Id of the file.
 		size_t getId() const;
-		/// Get the real name of the file. Which is [id]-[filename]
+		/// Get the real name of the file. Which is [id]-[filename], or the name of the shared stored file.
 		/// @return The real name of the file.
 		std::string getRealName() const;
 		/// Read the file meta-data from JSON value.
 		/// @param value The JSON value of the file.
 		void readJson(const Json::Value& value);
+		/// Set the name of the shared stored file with the same content.
+		/// @param blob Name of the stored file in its directory.
+		void setBlob(const std::string& blob);
 	    /// Set the file name.
 		/// @param fileName Given name of the file.
 		void setFilename(const std::string& fileName);
@@ -239,6 +268,8 @@ class File{
 		/// @param id Given id.
 		void setId(size_t id);
 	private:
+	    /// Name of the shared stored file, empty if the file is stored on its own.
+		std::string blob_;
 	    /// File name.
 		std::string filename_;
 		/// Id of the file.
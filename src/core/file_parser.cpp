@@ -1,5 +1,390 @@
 /// @file file_parser.cpp Source file for working with predefined database.
 #include "file_parser.h"
+#include <charconv>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <sys/ioctl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #ifdef __linux__
+        #include <linux/fs.h>
+    #endif
+    #ifdef __APPLE__
+        #include <sys/clonefile.h>
+    #endif
+#endif
+
+// =====================================================================
+// MappedFile
+// =====================================================================
+
+MappedFile::MappedFile(const std::filesystem::path& path) : data_(nullptr), mapping_(nullptr), open_(false), size_(0){
+    #ifdef _WIN32
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER fileSize;
+        if(!GetFileSizeEx(file, &fileSize)){
+            CloseHandle(file);
+            return;
+        }
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+        open_ = true;
+        if(size_ > 0){
+            mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(mapping_ != nullptr)
+                data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            open_ = data_ != nullptr;
+        }
+        CloseHandle(file);
+    #else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) return;
+        struct stat info;
+        if(fstat(fd, &info) != 0){
+            ::close(fd);
+            return;
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        open_ = true;
+        if(size_ > 0){
+            void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapped == MAP_FAILED){
+                open_ = false;
+            }
+            else{
+                madvise(mapped, size_, MADV_SEQUENTIAL);
+                data_ = static_cast<const char*>(mapped);
+            }
+        }
+        ::close(fd);
+    #endif
+}
+
+MappedFile::~MappedFile(){
+    if(data_ == nullptr) return;
+    #ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_);
+    #else
+        munmap(const_cast<char*>(data_), size_);
+    #endif
+}
+
+const char* MappedFile::data() const{
+    return data_;
+}
+
+bool MappedFile::isOpen() const{
+    return open_;
+}
+
+size_t MappedFile::size() const{
+    return size_;
+}
+
+// =====================================================================
+// JsonRecordReader
+// =====================================================================
+
+JsonRecordReader::JsonRecordReader(const char* begin, const char* end) : begin_(begin), end_(end), pos_(begin){
+    Json::CharReaderBuilder builder;
+    builder["collectComments"] = false;
+    reader_.reset(builder.newCharReader());
+}
+
+bool JsonRecordReader::readArray(const std::string& label, const std::function<void(const Json::Value&)>& record){
+    return readRawArray(label, [this, &record](std::string_view text){
+        Json::Value value;
+        if(!reader_->parse(text.data(), text.data() + text.size(), &value, nullptr)) return false;
+        record(value);
+        return true;
+    });
+}
+
+bool JsonRecordReader::readDocument(Json::Value& root){
+    if(begin_ == end_) return false;
+    return reader_->parse(begin_, end_, &root, nullptr);
+}
+
+bool JsonRecordReader::readMember(const std::string& label, std::string_view& value){
+    pos_ = begin_;
+    skipWhitespace();
+    if(pos_ == end_ || *pos_ != '{') return false;
+    ++pos_;
+    skipWhitespace();
+    while(pos_ != end_ && *pos_ != '}'){
+        const char* keyBegin = pos_;
+        if(*pos_ != '"' || !skipString()) return false;
+        std::string_view key (keyBegin + 1, pos_ - keyBegin - 2);
+        skipWhitespace();
+        if(pos_ == end_ || *pos_ != ':') return false;
+        ++pos_;
+        skipWhitespace();
+        const char* valueBegin = pos_;
+        if(!skipValue()) return false;
+        if(key == label){
+            value = std::string_view(valueBegin, pos_ - valueBegin);
+            return true;
+        }
+        skipWhitespace();
+        if(pos_ == end_ || (*pos_ != ',' && *pos_ != '}')) return false;
+        if(*pos_ == ',') ++pos_;
+        skipWhitespace();
+    }
+    return false;
+}
+
+bool JsonRecordReader::readRawArray(const std::string& label, const std::function<bool(std::string_view)>& record){
+    pos_ = begin_;
+    skipWhitespace();
+    if(pos_ == end_ || *pos_ != '{') return false;
+    ++pos_;
+    skipWhitespace();
+    if(pos_ != end_ && *pos_ == '}') return true;
+    while(pos_ != end_){
+        skipWhitespace();
+        const char* keyBegin = pos_;
+        if(pos_ == end_ || *pos_ != '"' || !skipString()) return false;
+        std::string_view key (keyBegin + 1, pos_ - keyBegin - 2);
+        skipWhitespace();
+        if(pos_ == end_ || *pos_ != ':') return false;
+        ++pos_;
+        skipWhitespace();
+        if(key == label && pos_ != end_ && *pos_ == '['){
+            ++pos_;
+            skipWhitespace();
+            if(pos_ != end_ && *pos_ == ']') ++pos_;
+            else{
+                while(true){
+                    skipWhitespace();
+                    const char* valueBegin = pos_;
+                    if(!skipValue() || !record(std::string_view(valueBegin, pos_ - valueBegin))) return false;
+                    skipWhitespace();
+                    if(pos_ == end_) return false;
+                    if(*pos_ == ']'){
+                        ++pos_;
+                        break;
+                    }
+                    if(*pos_ != ',') return false;
+                    ++pos_;
+                }
+            }
+        }
+        else if(!skipValue()) return false;
+        skipWhitespace();
+        if(pos_ == end_) return false;
+        if(*pos_ == '}') return true;
+        if(*pos_ != ',') return false;
+        ++pos_;
+    }
+    return false;
+}
+
+void JsonRecordReader::skipWhitespace(){
+    while(pos_ != end_ && (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t'))
+        ++pos_;
+}
+
+bool JsonRecordReader::skipString(){
+    ++pos_;
+    while(pos_ != end_){
+        if(*pos_ == '\\'){
+            if(end_ - pos_ < 2) return false;
+            pos_ += 2;
+            continue;
+        }
+        if(*pos_ == '"'){
+            ++pos_;
+            return true;
+        }
+        ++pos_;
+    }
+    return false;
+}
+
+bool JsonRecordReader::skipValue(){
+    if(pos_ == end_) return false;
+    if(*pos_ == '"') return skipString();
+    if(*pos_ == '{' || *pos_ == '['){
+        size_t depth = 0;
+        while(pos_ != end_){
+            switch(*pos_){
+                case '"':
+                    if(!skipString()) return false;
+                    continue;
+                case '{':
+                case '[':
+                    ++depth;
+                    break;
+                case '}':
+                case ']':
+                    if(--depth == 0){
+                        ++pos_;
+                        return true;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            ++pos_;
+        }
+        return false;
+    }
+    const char* start = pos_;
+    while(pos_ != end_ && *pos_ != ',' && *pos_ != '}' && *pos_ != ']' && *pos_ != ' ' && *pos_ != '\n' && *pos_ != '\r' && *pos_ != '\t')
+        ++pos_;
+    return pos_ != start;
+}
+
+// =====================================================================
+// FileStreamBuffer
+// =====================================================================
+
+FileStreamBuffer::FileStreamBuffer(const std::filesystem::path& path) : buffer_(BUFFER_SIZE), failed_(false){
+    #ifdef _WIN32
+        file_ = _wfopen(path.c_str(), L"wb");
+    #else
+        file_ = fopen(path.c_str(), "wb");
+    #endif
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+FileStreamBuffer::~FileStreamBuffer(){
+    if(file_ != nullptr) fclose(file_);
+}
+
+bool FileStreamBuffer::close(){
+    if(file_ == nullptr) return false;
+    bool success = flushBuffer() && fflush(file_) == 0;
+    #ifdef _WIN32
+        success = success && _commit(_fileno(file_)) == 0;
+    #else
+        success = success && fsync(fileno(file_)) == 0;
+    #endif
+    success = fclose(file_) == 0 && success;
+    file_ = nullptr;
+    return success && !failed_;
+}
+
+bool FileStreamBuffer::flushBuffer(){
+    size_t size = pptr() - pbase();
+    if(size > 0 && fwrite(pbase(), 1, size, file_) != size) failed_ = true;
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    return !failed_;
+}
+
+bool FileStreamBuffer::isOpen() const{
+    return file_ != nullptr;
+}
+
+FileStreamBuffer::int_type FileStreamBuffer::overflow(int_type ch){
+    if(file_ == nullptr || !flushBuffer()) return traits_type::eof();
+    if(traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+int FileStreamBuffer::sync(){
+    if(file_ == nullptr) return -1;
+    return flushBuffer() ? 0 : -1;
+}
+
+std::streamsize FileStreamBuffer::xsputn(const char* s, std::streamsize n){
+    if(file_ == nullptr) return 0;
+    if(n <= epptr() - pptr()){
+        std::copy(s, s + n, pptr());
+        pbump(static_cast<int>(n));
+        return n;
+    }
+    if(!flushBuffer()) return 0;
+    if(static_cast<size_t>(n) >= buffer_.size()){
+        if(fwrite(s, 1, n, file_) != static_cast<size_t>(n)){
+            failed_ = true;
+            return 0;
+        }
+        return n;
+    }
+    std::copy(s, s + n, pptr());
+    pbump(static_cast<int>(n));
+    return n;
+}
+
+// =====================================================================
+// Parser
+// =====================================================================
+
+namespace{
+    /// Copy the file. Where the file system supports it, the copy shares the data with the original (reflink),
+    /// so it takes no space until one of them is changed.
+    /// @param from Path to the original file.
+    /// @param to Path to the new file, it must not exist.
+    /// @return True if the file was copied.
+    bool cloneFile(const std::filesystem::path& from, const std::filesystem::path& to){
+        #if defined(__linux__) && defined(FICLONE)
+            int source = ::open(from.c_str(), O_RDONLY);
+            if(source >= 0){
+                int target = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+                if(target >= 0){
+                    bool cloned = ioctl(target, FICLONE, source) == 0;
+                    ::close(target);
+                    ::close(source);
+                    if(cloned) return true;
+                    std::filesystem::remove(to);
+                }
+                else ::close(source);
+            }
+        #elif defined(__APPLE__)
+            if(clonefile(from.c_str(), to.c_str(), 0) == 0) return true;
+        #endif
+        return std::filesystem::copy_file(from, to);
+    }
+
+    /// Hash the content of the file by 64-bit FNV-1a.
+    /// @param path Path to the file.
+    /// @return Hash of the content.
+    uint64_t hashFile(const std::filesystem::path& path){
+        std::ifstream is (path, std::ios::binary);
+        if(!is) throw std::runtime_error("File " + path.string() + " could not be read.");
+        std::vector<char> buffer (FileStreamBuffer::BUFFER_SIZE);
+        uint64_t hash = 14695981039346656037ULL;
+        while(is){
+            is.read(buffer.data(), buffer.size());
+            for(std::streamsize i = 0; i < is.gcount(); ++i){
+                hash ^= static_cast<unsigned char>(buffer[i]);
+                hash *= 1099511628211ULL;
+            }
+        }
+        return hash;
+    }
+
+    /// Compare the content of two files.
+    /// @param first Path to the first file.
+    /// @param second Path to the second file.
+    /// @return True if both files have the same content.
+    bool sameContent(const std::filesystem::path& first, const std::filesystem::path& second){
+        if(std::filesystem::file_size(first) != std::filesystem::file_size(second)) return false;
+        std::ifstream a (first, std::ios::binary);
+        std::ifstream b (second, std::ios::binary);
+        std::vector<char> bufferA (FileStreamBuffer::BUFFER_SIZE);
+        std::vector<char> bufferB (FileStreamBuffer::BUFFER_SIZE);
+        while(a && b){
+            a.read(bufferA.data(), bufferA.size());
+            b.read(bufferB.data(), bufferB.size());
+            if(a.gcount() != b.gcount() || !std::equal(bufferA.begin(), bufferA.begin() + a.gcount(), bufferB.begin()))
+                return false;
+        }
+        return a.eof() && b.eof();
+    }
+}
 
 Parser::Parser(){
     #ifdef _WIN32
@@ -22,6 +407,37 @@ Parser::Parser(){
         writeConfig(true);
 }
 
+bool Parser::appendJournal(const std::string& records){
+    if(records.empty()) return true;
+    std::filesystem::path journal = root_ / parser::JOURNAL;
+    #ifdef _WIN32
+        FILE* file = _wfopen(journal.c_str(), L"ab+");
+    #else
+        FILE* file = fopen(journal.c_str(), "ab+");
+    #endif
+    if(file == nullptr){
+        log("Journal could not be opened.");
+        return false;
+    }
+    // Previous write may have failed in the middle of a line, so the records start on a new one.
+    bool torn = false;
+    if(fseek(file, -1, SEEK_END) == 0){
+        char last = 0;
+        torn = fread(&last, 1, 1, file) == 1 && last != '\n';
+        fseek(file, 0, SEEK_END);
+    }
+    bool success = (!torn || fputc('\n', file) == '\n') && fwrite(records.data(), 1, records.size(), file) == records.size();
+    success = fflush(file) == 0 && success;
+    #ifdef _WIN32
+        success = _commit(_fileno(file)) == 0 && success;
+    #else
+        success = fsync(fileno(file)) == 0 && success;
+    #endif
+    success = fclose(file) == 0 && success;
+    if(!success) log("Journal could not be written.");
+    return success;
+}
+
 void Parser::checkFileConsistency(std::set<std::string>& database, std::vector<std::string>& found, const std::string& dir){
     namespace fs = std::filesystem;
     fs::path dirPath = root_ / dir;
@@ -42,6 +458,35 @@ void Parser::checkFileConsistency(std::set<std::string>& database, std::vector<s
 
 void Parser::clear(){
     root_ = std::filesystem::path();
+    logger_.setFile(root_);
+}
+
+void Parser::clearJournal(){
+    try{
+        std::filesystem::remove(root_ / parser::JOURNAL);
+    } catch(std::exception& e){
+        log(e.what());
+    }
+}
+
+bool Parser::filterJournal(const std::function<bool(const Json::Value&)>& keep){
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader (builder.newCharReader());
+    std::string kept;
+    bool read = readJournalLines([&](std::string_view line){
+        Json::Value value;
+        if(!reader->parse(line.data(), line.data() + line.size(), &value, nullptr) || !keep(value)) return;
+        kept.append(line);
+        kept.push_back('\n');
+    });
+    if(!read) return false;
+    if(kept.empty()){
+        clearJournal();
+        return true;
+    }
+    // The last line break is added by the writer.
+    kept.pop_back();
+    return writeJSON(parser::JOURNAL, [&kept](std::ostream& os){os << kept;});
 }
 
 bool Parser::copyFile(const std::string& filePath, const std::string& dir, std::string& fileName, size_t id){
@@ -52,7 +497,7 @@ bool Parser::copyFile(const std::string& filePath, const std::string& dir, std::
         ss << id << "-" << originalPath.filename().string();
         fileName = originalPath.filename().string();
         fs::path newPath = root_ / dir / ss.str();
-        return fs::copy_file(originalPath, newPath);
+        return cloneFile(originalPath, newPath);
     } catch (std::exception& e){
         log(e.what());
         return false;
@@ -126,6 +571,22 @@ std::string Parser::createResourcesDir(const std::string& target){
     return targetPath.string();
 }
 
+bool Parser::fingerprint(const std::string& fileName, BinaryWriter& writer){
+    namespace fs = std::filesystem;
+    try{
+        fs::path file = root_ / fileName;
+        MappedFile mapped (file);
+        if(!mapped.isOpen()) return false;
+        writer.write(mapped.size());
+        writer.write(fs::last_write_time(file).time_since_epoch().count());
+        writer.write(cache::hash(mapped.data(), mapped.size()));
+        return true;
+    } catch(std::exception& e){
+        log(e.what(), LOG_WARNING);
+        return false;
+    }
+}
+
 std::string Parser::getAbsoluteFilePath(const std::string& dir, const std::string& fileName) const{
     namespace fs = std::filesystem;
 	fs::path filePath = root_ / dir / fileName;
@@ -147,24 +608,21 @@ bool Parser::isRootDirectorySet(){
 	return !root_.empty();
 }
 
-void Parser::log(const std::string&  error){
-    if(!isRootDirectorySet()) return;
-    try{
-        namespace fs = std::filesystem;
-        fs::path logFile = root_ / parser::ERROR_LOG;
-        std::ofstream os;
-        os.open(logFile, std::ios_base::app);
-        auto time = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(time);
-        os << std::put_time(std::localtime(&time_t), "%Y-%m-%d %X") << ": " << error << std::endl;
-    } catch(std::exception& e){
-        std::cerr << e.what() << std::endl;
-    }
+size_t Parser::journalSize(){
+    std::error_code ec;
+    auto size = std::filesystem::file_size(root_ / parser::JOURNAL, ec);
+    return ec ? 0 : static_cast<size_t>(size);
+}
+
+void Parser::log(const std::string&  error, LogLevel level){
+    logger_.log(error, level);
 }
 
 void Parser::makeNewDatabase(const std::string& dirPath){
 	root_ = std::filesystem::path(dirPath);
+	logger_.setFile(root_ / parser::ERROR_LOG);
 	createAllDirs();
+	clearJournal();
 	createJsonFile(parser::JSON_PERSONS);
 	createJsonFile(parser::JSON_CONFIG);
 	createJsonFile(parser::JSON_EVENTS);
@@ -178,15 +636,8 @@ std::pair<bool, std::vector<std::string>> Parser::readConfig(){
     std::vector<std::string> paths;
     bool help = true;
     try{
-        std::ifstream ifs;
-        ifs.open(configPath_);
-        std::stringstream ss;
-        std::string str;
-        while(getline(ifs,str))
-            ss << str;
-        Json::Reader reader;
         Json::Value root;
-        reader.parse(ss.str(), root);
+        readJSONFile(configPath_.string(), root, false);
         for(Json::ArrayIndex i = 0; i < root[jsonlabel::ROOT].size(); ++i)
             paths.push_back(root[jsonlabel::ROOT][i][jsonlabel::DIR].asString());
         help = root[jsonlabel::HELP].asInt();
@@ -196,20 +647,83 @@ std::pair<bool, std::vector<std::string>> Parser::readConfig(){
 	return {help, paths};
 }
 
+bool Parser::readCache(const std::function<bool(BinaryReader&)>& reader){
+    MappedFile file (root_ / parser::CACHE);
+    if(!file.isOpen() || file.size() == 0) return false;
+    try{
+        BinaryReader binaryReader (file.data(), file.data() + file.size());
+        return reader(binaryReader);
+    } catch(std::exception& e){
+        log(e.what(), LOG_WARNING);
+        return false;
+    }
+}
+
+bool Parser::readJournal(const std::function<void(const Json::Value&)>& record){
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader (builder.newCharReader());
+    return readJournalLines([this, &reader, &record](std::string_view line){
+        Json::Value value;
+        if(reader->parse(line.data(), line.data() + line.size(), &value, nullptr)) record(value);
+        else log("Corrupted record in the journal was skipped.");
+    });
+}
+
+bool Parser::readJournalLines(const std::function<void(std::string_view)>& line){
+    namespace fs = std::filesystem;
+    fs::path journal = root_ / parser::JOURNAL;
+    if(!fs::exists(journal)) return true;
+    // Length of the complete lines, anything after them was torn by an interrupted write.
+    size_t complete = 0;
+    {
+        MappedFile mapped (journal);
+        if(!mapped.isOpen()) return false;
+        const char* end = mapped.data() + mapped.size();
+        for(const char* lineBegin = mapped.data(); lineBegin < end;){
+            const char* lineEnd = std::find(lineBegin, end, '\n');
+            if(lineEnd == end){
+                log("Unfinished record at the end of the journal was skipped.");
+                break;
+            }
+            if(lineBegin != lineEnd) line(std::string_view(lineBegin, lineEnd - lineBegin));
+            lineBegin = lineEnd + 1;
+            complete = lineBegin - mapped.data();
+        }
+        if(complete == mapped.size()) return true;
+    }
+    // The torn record is cut off (after unmapping the file), otherwise the next appended record would continue its line.
+    std::error_code error;
+    fs::resize_file(journal, complete, error);
+    if(error) log("Unfinished record could not be removed from the journal.");
+    return true;
+}
+
 bool Parser::readJSONFile(const std::string& fileName, Json::Value& root, bool inDatabase){
 	try{
 		namespace fs = std::filesystem;
 		fs::path file;
 		if(inDatabase) file = root_ / fileName;
 		else file = fs::path(fileName);
-		std::ifstream ifs;
-		ifs.open(file);
-		std::ostringstream ss;
-		std::string str;
-		while(getline(ifs,str))
-			ss << str;
-		Json::Reader reader;
-		return reader.parse(ss.str(), root);
+		MappedFile mapped (file);
+		if(!mapped.isOpen()) return false;
+		JsonRecordReader reader (mapped.data(), mapped.data() + mapped.size());
+		return reader.readDocument(root);
+	} catch(const std::exception& e){
+		log(e.what());
+		return false;
+	}
+}
+
+bool Parser::readJSONRecords(const std::string& fileName, const std::string& label, const std::function<void(const Json::Value&)>& record, bool inDatabase){
+	try{
+		namespace fs = std::filesystem;
+		fs::path file;
+		if(inDatabase) file = root_ / fileName;
+		else file = fs::path(fileName);
+		MappedFile mapped (file);
+		if(!mapped.isOpen()) return false;
+		JsonRecordReader reader (mapped.data(), mapped.data() + mapped.size());
+		return reader.readArray(label, record);
 	} catch(const std::exception& e){
 		log(e.what());
 		return false;
@@ -267,9 +781,54 @@ void Parser::restoreBackup(const std::string& backupFile){
     }
 }
 
+bool Parser::rewriteRecords(const std::string& fileName, const std::string& label, const std::map<size_t, std::string>& records){
+    return writeJSON(fileName, [this, &fileName, &label, &records](std::ostream& os){
+        // The old file is unmapped when the printer returns, before it is replaced.
+        MappedFile mapped (root_ / fileName);
+        if(!mapped.isOpen()){
+            os.setstate(std::ios::failbit);
+            return;
+        }
+        bool first = true;
+        auto print = [&os, &first](std::string_view record){
+            if(!first) os << ",";
+            first = false;
+            os << record;
+        };
+        // Next changed record, all changed records before it are already written.
+        auto next = records.begin();
+        os << "{\"" << label << "\":[";
+        JsonRecordReader reader (mapped.data(), mapped.data() + mapped.size());
+        bool read = reader.readRawArray(label, [&](std::string_view record){
+            std::string_view idText;
+            size_t id = 0;
+            if(!JsonRecordReader(record.data(), record.data() + record.size()).readMember(jsonlabel::ID, idText)) return false;
+            if(std::from_chars(idText.data(), idText.data() + idText.size(), id).ec != std::errc()) return false;
+            for(; next != records.end() && next->first < id; ++next)
+                if(!next->second.empty()) print(next->second);
+            if(next != records.end() && next->first == id){
+                if(!next->second.empty()) print(next->second);
+                ++next;
+            }
+            // Record written before as a changed one means the old file was not ordered by ids.
+            else if(!records.contains(id)) print(record);
+            return true;
+        });
+        if(!read){
+            log("File " + fileName + " is corrupted, its changes stay in the journal.");
+            os.setstate(std::ios::failbit);
+            return;
+        }
+        for(; next != records.end(); ++next)
+            if(!next->second.empty()) print(next->second);
+        os << "]}";
+    });
+}
+
 bool Parser::setDatabase(const std::string& dirPath){
 	namespace fs = std::filesystem;
 	root_ = fs::path(dirPath);
+	logger_.setFile(root_ / parser::ERROR_LOG);
 	bool success = true;
 	success = success
 		&& fs::exists(root_ / parser::JSON_CONFIG)    && (root_ / parser::JSON_CONFIG).extension()    == ".json"
@@ -286,6 +845,50 @@ bool Parser::setDatabase(const std::string& dirPath){
 	return success;
 }
 
+bool Parser::storeBlob(const std::string& filePath, const std::string& dir, std::string& fileName, std::string& blobName){
+    try{
+        namespace fs = std::filesystem;
+        fs::path originalPath (filePath);
+        fileName = originalPath.filename().string();
+        std::stringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << hashFile(originalPath) << std::dec << "-" << fs::file_size(originalPath);
+        std::string key = ss.str();
+        std::string extension = originalPath.extension().string();
+        // Different content with the same hash gets its own name, so the hash only speeds up the lookup.
+        for(size_t collision = 0;; ++collision){
+            blobName = key + (collision == 0 ? "" : "-" + std::to_string(collision)) + extension;
+            fs::path blobPath = root_ / dir / blobName;
+            if(!fs::exists(blobPath)) return cloneFile(originalPath, blobPath);
+            if(sameContent(originalPath, blobPath)) return true;
+        }
+    } catch (std::exception& e){
+        log(e.what());
+        return false;
+    }
+}
+
+bool Parser::writeCache(const std::string& data){
+    namespace fs = std::filesystem;
+    fs::path file = root_ / parser::CACHE;
+    fs::path temporary = file;
+    temporary += ".tmp";
+    try{
+        std::ofstream os (temporary, std::ios_base::binary | std::ios_base::trunc);
+        os.write(data.data(), data.size());
+        os.close();
+        if(!os){
+            log("File " + parser::CACHE + " could not be written.", LOG_WARNING);
+            fs::remove(temporary);
+            return false;
+        }
+        fs::rename(temporary, file);
+        return true;
+    } catch(std::exception& e){
+        log(e.what(), LOG_WARNING);
+        return false;
+    }
+}
+
 void Parser::writeConfig(bool help){
     try{
         std::ofstream out;
@@ -357,40 +960,43 @@ void Parser::writeHtml(const std::string& html, const std::string& dirPath, cons
     writeHtml(html, filePath.string());
 }
 
-void Parser::writeJSON(const std::string& data, const std::string& fileName, bool inDatabase){
-	Json::Value root;
-	Json::Reader reader;
+bool Parser::writeJSON(const std::string& fileName, const std::function<void(std::ostream&)>& printer, bool inDatabase){
 	namespace fs = std::filesystem;
-	bool parsingSuccessful = reader.parse(data, root);
 	fs::path file;
-	fs::path backup;
-	if(inDatabase){
-        file = root_ / fileName;
-        backup = file;
-        backup += ".bak";
-        try{
-            fs::copy(file, backup);
-        } catch(std::exception& e){
-            log("Backup was not made for " + fileName + " due to an error: " + e.what() +".");
-        }
-	}
-    else{
-        file = fs::path(fileName);
-    }
-	if(parsingSuccessful){
-		try{
-			std::ofstream os;
-			os.open(file);
-			os << root << std::endl;
-		} catch(std::exception& e){
-			log(e.what());
+	if(inDatabase) file = root_ / fileName;
+	else file = fs::path(fileName);
+	fs::path temporary = file;
+	temporary += ".tmp";
+	try{
+		bool success;
+		{
+			FileStreamBuffer buffer (temporary);
+			if(!buffer.isOpen()){
+				log("File " + temporary.string() + " could not be created.");
+				return false;
+			}
+			std::ostream os (&buffer);
+			printer(os);
+			os << '\n';
+			success = os.good() && buffer.close();
 		}
-	}
-	if(inDatabase){
-        try{
-            fs::remove(backup);
-        } catch(std::exception& e){
-            log("Backup for " + fileName + " was not deleted due to an error: " + e.what() +".");
-        }
+		if(!success){
+			log("File " + fileName + " could not be written.");
+			fs::remove(temporary);
+			return false;
+		}
+		fs::rename(temporary, file);
+		#ifndef _WIN32
+			// Make the rename itself durable.
+			int dir = ::open(file.parent_path().c_str(), O_RDONLY);
+			if(dir >= 0){
+				fsync(dir);
+				::close(dir);
+			}
+		#endif
+		return true;
+	} catch(const std::exception& e){
+		log(e.what());
+		return false;
 	}
 }
@@ -2,17 +2,26 @@
 #ifndef file_parser_h_
 #define file_parser_h_
 
+#include <algorithm>
+#include <cstdio>
 #include <filesystem>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <vector>
 #include <json/json.h>
 #include <chrono>
 #include <iomanip>
 #include <ctime>
+#include <map>
 #include <set>
+#include <functional>
+#include <memory>
+#include "binary_cache.h"
 #include "strings.h"
+#include "logger.h"
 
 /// Namespace for all strings representing files and directories in the database.
 namespace parser{
@@ -36,15 +45,149 @@ namespace parser{
     const std::string MEDIA_DIR = "Media";
     /// Directory for all notes.
     const std::string NOTES_DIR = "Notes";
+    /// Binary image of the loaded database, which is used instead of parsing unchanged JSON files.
+    const std::string CACHE = ".cache.bin";
     /// File for writing error log.
     const std::string ERROR_LOG = ".error.log";
+    /// Append-only journal with changed records which were not yet written to the JSON files.
+    const std::string JOURNAL = "Journal.jsonl";
+    /// Size of the journal (in bytes) after which the journal is folded back to the JSON files.
+    const size_t JOURNAL_LIMIT = 16 * 1024 * 1024;
 }
 
+/// Read-only memory mapping of a whole file. The content is paged in by the system on demand, thus it is not copied to the heap.
+class MappedFile{
+    public:
+        /// Map the file to the memory.
+        /// @param path Path to the file.
+        explicit MappedFile(const std::filesystem::path& path);
+        /// Unmap the file.
+        ~MappedFile();
+        /// Mapping cannot be copied.
+        MappedFile(const MappedFile&) = delete;
+        /// Mapping cannot be copied.
+        MappedFile& operator=(const MappedFile&) = delete;
+        /// Get the beginning of the mapped content.
+        /// @return Pointer to the first character or nullptr if the file is empty.
+        const char* data() const;
+        /// If the file was opened and mapped (empty file counts as mapped).
+        /// @return True if the content can be read.
+        bool isOpen() const;
+        /// Get the size of the mapped file.
+        /// @return Number of bytes.
+        size_t size() const;
+    private:
+        /// Beginning of the mapped content.
+        const char* data_;
+        /// Handle of the mapping (only used on Windows).
+        void* mapping_;
+        /// If the file was opened.
+        bool open_;
+        /// Size of the mapped content.
+        size_t size_;
+};
+
+/// Streaming reader of JSON arrays. It walks the raw text and hands over one record (one element of the array) at a time,
+/// so the whole document is never built in the memory.
+class JsonRecordReader{
+    public:
+        /// Default constructor.
+        /// @param begin First character of the JSON document.
+        /// @param end One past the last character of the JSON document.
+        JsonRecordReader(const char* begin, const char* end);
+        /// Read every element of the array stored under the label of the top-level object.
+        /// If the label is not present there are no records, which is not an error.
+        /// @param label Label of the array in the top-level object.
+        /// @param record Function called for each parsed element.
+        /// @return True if the document was well-formed.
+        bool readArray(const std::string& label, const std::function<void(const Json::Value&)>& record);
+        /// Find the text of one member of the top-level object without parsing it.
+        /// @param label Label of the member.
+        /// @param value Where the text of the value is stored.
+        /// @return True if the member was found.
+        bool readMember(const std::string& label, std::string_view& value);
+        /// Read every element of the array stored under the label of the top-level object, as the text of the element.
+        /// @param label Label of the array in the top-level object.
+        /// @param record Function called for each element, it returns false if the element is malformed.
+        /// @return True if the document and all the elements were well-formed.
+        bool readRawArray(const std::string& label, const std::function<bool(std::string_view)>& record);
+        /// Parse the whole document at once.
+        /// @param root Where to store the parsed document.
+        /// @return True if the parsing was successful.
+        bool readDocument(Json::Value& root);
+    private:
+        /// Beginning of the document.
+        const char* begin_;
+        /// End of the document.
+        const char* end_;
+        /// Current position in the document.
+        const char* pos_;
+        /// Parser of single records.
+        std::unique_ptr<Json::CharReader> reader_;
+        /// Skip all white characters.
+        void skipWhitespace();
+        /// Skip a string starting at current position (including the quotes).
+        /// @return False if the string is not terminated.
+        bool skipString();
+        /// Skip any value starting at current position.
+        /// @return False if the value is malformed.
+        bool skipValue();
+};
+
+/// Output stream buffer writing directly to a file through a fixed-size buffer, so the written data are never held in memory as a whole.
+class FileStreamBuffer : public std::streambuf{
+    public:
+        /// Size of the buffer in bytes.
+        static constexpr size_t BUFFER_SIZE = 64 * 1024;
+        /// Open (and truncate) the file.
+        /// @param path Path to the file.
+        explicit FileStreamBuffer(const std::filesystem::path& path);
+        /// Close the file if it is still open.
+        ~FileStreamBuffer();
+        /// Buffer cannot be copied.
+        FileStreamBuffer(const FileStreamBuffer&) = delete;
+        /// Buffer cannot be copied.
+        FileStreamBuffer& operator=(const FileStreamBuffer&) = delete;
+        /// Write the rest of the buffer, flush the file to the disk and close it.
+        /// @return True if all the data are stored on the disk.
+        bool close();
+        /// If the file was opened.
+        /// @return True if the file can be written.
+        bool isOpen() const;
+    protected:
+        /// Write the full buffer to the file and store one character.
+        /// @param ch Character which did not fit in the buffer.
+        /// @return The character or EOF on failure.
+        int_type overflow(int_type ch) override;
+        /// Write the buffer to the file.
+        /// @return 0 on success, -1 on failure.
+        int sync() override;
+        /// Write more characters at once. Long sequences bypass the buffer.
+        /// @param s Written characters.
+        /// @param n Number of characters.
+        /// @return Number of written characters.
+        std::streamsize xsputn(const char* s, std::streamsize n) override;
+    private:
+        /// Fixed-size buffer.
+        std::vector<char> buffer_;
+        /// If some write failed.
+        bool failed_;
+        /// Opened file.
+        FILE* file_;
+        /// Write the content of the buffer to the file.
+        /// @return True if the write was successful.
+        bool flushBuffer();
+};
+
 /// Main class for working with the database.
 class Parser{
 	public:
 	    /// Default constructor.
 	    Parser();
+	    /// Append records to the journal and flush them to the disk.
+	    /// @param records Records in JSON format, each one on its own line.
+	    /// @return True if the records are stored on the disk.
+	    bool appendJournal(const std::string& records);
 	    /// Check the consistency of files.
 	    /// @param database Which files are stored in database, these will be removed from the list if found.
 	    /// @param found Files found and not present in database.
@@ -52,6 +195,12 @@ class Parser{
 	    void checkFileConsistency(std::set<std::string>& database, std::vector<std::string>& found, const std::string& dir);
 	    /// Clear stored data.
 	    void clear();
+	    /// Remove the journal, because all its records were written to the JSON files.
+	    void clearJournal();
+	    /// Rewrite the journal with only some of its records, the unfinished last record is dropped.
+	    /// @param keep Function deciding if the record is kept.
+	    /// @return True if the journal was rewritten.
+	    bool filterJournal(const std::function<bool(const Json::Value&)>& keep);
 	    /// If the database store some backup files, which may be used. Note there can be only one backup file (when the app is working properly).
 	    /// @param backupFile If there is backup there will be stored the name of the file.
 	    /// @return True if there is a backup file.
@@ -71,6 +220,11 @@ class Parser{
 		/// @param target Where the resource directory should be (either a path to the directory or an html file).
 		/// @return String representing the path to the resources directory.
 		std::string createResourcesDir(const std::string& target);
+		/// Describe the content of the file in database, so its changes can be detected.
+		/// @param fileName Name of the file in the root directory.
+		/// @param writer Where the size, time of the last modification and hash of the content are written.
+		/// @return True if the file could be read.
+		bool fingerprint(const std::string& fileName, BinaryWriter& writer);
 		/// Get the absolute path to the file in database.
 		/// @param dir Which directory should have the file.
 		/// @param fileName What is the file-name in its directory.
@@ -85,21 +239,45 @@ class Parser{
 	    /// Whether the directory has been already set.
 		/// @return True if the directory was already chosen.
 		bool isRootDirectorySet();
-		/// Log error to the error file.
+		/// Get the size of the journal.
+		/// @return Size of the journal in bytes, 0 if there is none.
+		size_t journalSize();
+		/// Log error to the error file. The message is only buffered, it is written later in the background.
 		/// @param error What error occurred.
-		void log(const std::string&  error);
+		/// @param level Severity of the error.
+		void log(const std::string&  error, LogLevel level = LOG_ERROR);
 		/// Make new empty database. Create all directories and files.
 		/// @param dirPath Path to the chosen root directory.
 		void makeNewDatabase(const std::string& dirPath);
 		/// Read config file if it exists and return vector of all saved paths.
 		/// @return If help should be shown and vector of strings representing paths to the directories.
 		std::pair<bool, std::vector<std::string>> readConfig();
+		/// Read the binary image of the database. The file is memory-mapped, so it is read at once without copying.
+		/// @param reader Function reading the image, it returns false if the image cannot be used.
+		/// @return True if the image exists and it was read.
+		bool readCache(const std::function<bool(BinaryReader&)>& reader);
+		/// Read all records from the journal in the order they were written.
+		/// Unfinished last record (the application was interrupted while writing it) is skipped and cut off from the journal.
+		/// @param record Function called for each record.
+		/// @return True if the journal does not exist or it was read, false if it cannot be read.
+		bool readJournal(const std::function<void(const Json::Value&)>& record);
+		/// Read all lines of the journal without parsing them, unfinished last record is cut off like in readJournal.
+		/// @param line Function called for each non-empty line (without the line break).
+		/// @return True if the journal does not exist or it was read, false if it cannot be read.
+		bool readJournalLines(const std::function<void(std::string_view)>& line);
 		/// Load the content of JSON file to Json::Value format.
 		/// @param fileName File in the root directory to be used.
 		/// @param root Where to store parsed data from the file.
 		/// @param inDatabase If the file is in database or not, if it is not, then it is for import.
 		/// @return True if the parsing was successful. False otherwise.
 		bool readJSONFile(const std::string& fileName, Json::Value& root, bool inDatabase = true);
+		/// Stream all records of one array from JSON file. The file is memory-mapped and only one record is parsed at a time.
+		/// @param fileName File in the root directory to be used.
+		/// @param label Label of the array in the top-level object.
+		/// @param record Function called for each record.
+		/// @param inDatabase If the file is in database or not, if it is not, then it is for import.
+		/// @return True if the parsing was successful. False otherwise.
+		bool readJSONRecords(const std::string& fileName, const std::string& label, const std::function<void(const Json::Value&)>& record, bool inDatabase = true);
 		/// Remove backup files if there is any.
 		void removeBackup();
 		/// Remove file with given name in given directory.
@@ -114,10 +292,29 @@ class Parser{
 		/// Restore backup file.
 		/// @param backupFile Which backup file is going to be restored.
         void restoreBackup(const std::string& backupFile);
+		/// Rewrite the array of records of the JSON file with some records replaced, removed or added.
+		/// Unchanged records are copied as they are, the records stay ordered by their ids.
+		/// @param fileName File in the root directory.
+		/// @param label Label of the array in the top-level object.
+		/// @param records New text of the changed records by their ids, empty text for removed records.
+		/// @return True if the old file was read and the new one was written.
+		bool rewriteRecords(const std::string& fileName, const std::string& label, const std::map<size_t, std::string>& records);
 		/// Set the root directory and check its content.
 		/// @param dirPath Path to the root directory.
 		/// @return True if all files and directories exist.
 		bool setDatabase(const std::string& dirPath);
+		/// Store file in the directory once for its content. The name of the stored file is derived from the hash of the content,
+		/// so the same content imported again only refers to the already stored file.
+		/// @param filePath Path to the original file.
+		/// @param dir Which directory to use in database of the root directory.
+		/// @param fileName Is the name of the original file. Use for return value.
+		/// @param blobName Is the name of the stored file in the directory. Use for return value.
+		/// @return True if the file is stored, false otherwise.
+		bool storeBlob(const std::string& filePath, const std::string& dir, std::string& fileName, std::string& blobName);
+		/// Replace the binary image of the database. It is not synchronized to the disk, because a lost image is only rebuilt.
+		/// @param data Content of the image.
+		/// @return True if the image was written.
+		bool writeCache(const std::string& data);
 		/// Write only current project path to the configuration.
 		/// @param help If help window should be shown at the start-up.
 		void writeConfig(bool help);
@@ -134,11 +331,13 @@ class Parser{
 		/// @param dirPath Path to the root directory.
 		/// @param filename Name of the file in root directory.
 		void writeHtml(const std::string& html, const std::string& dirPath, const std::string& filename);
-		/// Write data in JSON formatting to its file. Before create a backup and after saving delete the backup.
-		/// @param data Preprocessed JSON format string of data.
+		/// Write data in JSON formatting to its file. The data are streamed to a temporary file,
+		/// which replaces the original file only after everything was written to the disk.
 		/// @param file The name of the JSON file in the root directory.
+		/// @param printer Function writing the JSON data to given stream.
 		/// @param inDatabase If the file is in database or not, if it is not it is for export.
-		void writeJSON(const std::string& data, const std::string& file, bool inDatabase = true);
+		/// @return True if the file was written.
+		bool writeJSON(const std::string& file, const std::function<void(std::ostream&)>& printer, bool inDatabase = true);
 	private:
 	    /// If there is backup for this file-name.
 	    /// @param backupFile If this backup file exists put there the name of it.
@@ -152,6 +351,8 @@ class Parser{
 		void createJsonFile(const std::string& fileName);
 		/// Path to the root directory.
 		std::filesystem::path root_;
+		/// Logger writing to the error log of the database.
+		Logger logger_;
 		/// Path to the configuration file.
 		std::filesystem::path configPath_;
 };
@@ -0,0 +1,253 @@
+/// @file inbreeding_calculator.cpp Source file for the calculator of kinship and inbreeding coefficients.
+#include "inbreeding_calculator.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <map>
+#include <thread>
+#include <utility>
+
+namespace{
+    /// Maximum number of memoized coefficients, all of them are dropped when it is exceeded.
+    constexpr size_t MAX_CACHED = 1 << 22;
+
+    /// Probability that an allele is passed down through the generations.
+    /// @param generations Number of generations.
+    /// @return One half to the power of the generations.
+    double weight(int generations){
+        return std::ldexp(1.0, -generations);
+    }
+
+    /// Key of a pair of persons, which does not depend on their order.
+    /// @param first Position of the first person.
+    /// @param second Position of the second person.
+    /// @return Both positions in one number.
+    uint64_t pairKey(size_t first, size_t second){
+        if(first > second) std::swap(first, second);
+        return (static_cast<uint64_t>(first) << 32) | static_cast<uint64_t>(second);
+    }
+
+    /// Call the task for each index on several threads. Each thread takes the next index when it is done, so uneven tasks are spread evenly.
+    /// @param count Number of indices.
+    /// @param task Function called with the index and the memoized coefficients of the thread.
+    template<typename Memo, typename Task>
+    void parallel(size_t count, Task task){
+        size_t threads = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+        std::atomic<size_t> next = 0;
+        std::vector<std::future<void>> workers;
+        for(size_t i = 0; i < threads; ++i){
+            workers.push_back(std::async(std::launch::async, [&next, &task, count](){
+                Memo memo;
+                for(size_t index = next++; index < count; index = next++){
+                    if(memo.size() > MAX_CACHED) memo.clear();
+                    task(index, memo);
+                }
+            }));
+        }
+        for(auto&& worker : workers)
+            worker.get();
+    }
+}
+
+// =====================================================================
+// InbreedingCalculator
+// =====================================================================
+
+InbreedingCalculator::InbreedingCalculator() : valid_(false){}
+
+void InbreedingCalculator::build(const RecordMap<Person>& persons, const RelationshipCalculator& relationships){
+    memo_.clear();
+    positions_ = RecordPositions(persons);
+    size_t size = positions_.size();
+    parents_.assign(size, {Step{0, 0}, Step{0, 0}});
+    std::vector<size_t> childOffsets (size + 1, 0);
+    std::vector<size_t> pending (size, 0);
+    for(auto&& [id, person] : persons){
+        size_t position = positions_.find(id);
+        parents_[position] = relationships.getParents(id);
+        for(Step& parent : parents_[position]){
+            if(parent.person != 0 && !persons.contains(parent.person)) parent = Step{0, 0};
+            if(parent.person == 0) continue;
+            ++childOffsets[positions_.find(parent.person) + 1];
+            ++pending[position];
+        }
+    }
+    for(size_t i = 1; i < childOffsets.size(); ++i)
+        childOffsets[i] += childOffsets[i - 1];
+    // Children, order and components are kept by positions, only the parents keep ids of the persons.
+    std::vector<size_t> children (childOffsets.back());
+    std::vector<size_t> next (childOffsets.begin(), childOffsets.end() - 1);
+    for(size_t position = 0; position < size; ++position)
+        for(const Step& parent : parents_[position])
+            if(parent.person != 0)
+                children[next[positions_.find(parent.person)]++] = position;
+    // Founders are ranked first and each person follows once all its parents are ranked.
+    std::vector<size_t> order;
+    order.reserve(size);
+    for(size_t position = 0; position < size; ++position)
+        if(pending[position] == 0) order.push_back(position);
+    for(size_t i = 0; i < order.size(); ++i)
+        for(size_t j = childOffsets[order[i]]; j < childOffsets[order[i] + 1]; ++j)
+            if(--pending[children[j]] == 0) order.push_back(children[j]);
+    ranks_.assign(size, size);
+    for(size_t i = 0; i < order.size(); ++i)
+        ranks_[order[i]] = i;
+    // Persons in cycles of parenthood and their descendants are ranked last, the parents closing the cycles are left out.
+    size_t rank = order.size();
+    for(size_t position = 0; position < size; ++position)
+        if(ranks_[position] == size) ranks_[position] = rank++;
+    for(size_t position = 0; position < size; ++position)
+        for(Step& parent : parents_[position])
+            if(parent.person != 0 && ranks_[positions_.find(parent.person)] >= ranks_[position]) parent = Step{0, 0};
+    // Components are joined along the parents, so the persons without a common ancestor are mostly told apart at once.
+    components_.resize(size);
+    for(size_t position = 0; position < size; ++position)
+        components_[position] = position;
+    auto root = [this](size_t position){
+        while(components_[position] != position){
+            components_[position] = components_[components_[position]];
+            position = components_[position];
+        }
+        return position;
+    };
+    for(size_t position = 0; position < size; ++position)
+        for(const Step& parent : parents_[position])
+            if(parent.person != 0) components_[root(positions_.find(parent.person))] = root(position);
+    for(size_t position = 0; position < size; ++position)
+        components_[position] = root(position);
+    valid_ = true;
+}
+
+std::vector<CollapsedGeneration> InbreedingCalculator::findCollapse(size_t person, int generations) const{
+    std::vector<CollapsedGeneration> result;
+    if(positions_.find(person) >= parents_.size()) return result;
+    // Each ancestor is counted once for every line of descent, parents may skip generations, so generations are taken in order.
+    std::map<int, std::unordered_map<size_t, double>> levels;
+    levels[0][person] = 1;
+    while(!levels.empty()){
+        auto level = levels.extract(levels.begin());
+        int generation = level.key();
+        if(generations > 0 && generation > generations) break;
+        double positions = 0;
+        for(auto&& [ancestor, lines] : level.mapped()){
+            positions += lines;
+            for(const Step& parent : parents_[positions_.find(ancestor)])
+                if(parent.person != 0)
+                    levels[generation + parent.generations][parent.person] += lines;
+        }
+        if(generation > 0)
+            result.push_back(CollapsedGeneration{generation, weight(-generation), positions, level.mapped().size()});
+    }
+    return result;
+}
+
+double InbreedingCalculator::findInbreeding(size_t person){
+    if(memo_.size() > MAX_CACHED) memo_.clear();
+    return inbreeding(person, memo_);
+}
+
+std::vector<double> InbreedingCalculator::findInbreedings(const std::vector<size_t>& persons) const{
+    std::vector<double> result (persons.size(), 0);
+    parallel<Memo>(persons.size(), [this, &persons, &result](size_t index, Memo& memo){
+        result[index] = inbreeding(persons[index], memo);
+    });
+    return result;
+}
+
+double InbreedingCalculator::findKinship(size_t first, size_t second){
+    if(memo_.size() > MAX_CACHED) memo_.clear();
+    return kinship(first, second, memo_);
+}
+
+std::vector<std::vector<double>> InbreedingCalculator::findKinships(const std::vector<size_t>& persons) const{
+    std::vector<std::vector<double>> result (persons.size(), std::vector<double>(persons.size(), 0));
+    // Each row computes the upper triangle, the rest is mirrored once all rows are done.
+    parallel<Memo>(persons.size(), [this, &persons, &result](size_t row, Memo& memo){
+        for(size_t column = row; column < persons.size(); ++column)
+            result[row][column] = kinship(persons[row], persons[column], memo);
+    });
+    for(size_t row = 0; row < persons.size(); ++row)
+        for(size_t column = 0; column < row; ++column)
+            result[row][column] = result[column][row];
+    return result;
+}
+
+double InbreedingCalculator::inbreeding(size_t person, Memo& memo) const{
+    size_t position = positions_.find(person);
+    if(position >= parents_.size()) return 0;
+    const auto& [father, mother] = parents_[position];
+    if(!mayBeRelated(father.person, mother.person)) return 0;
+    // Parents skipping generations stand for unknown persons in between, who pass down the allele with one half each.
+    return weight(father.generations - 1) * weight(mother.generations - 1) * kinship(father.person, mother.person, memo);
+}
+
+void InbreedingCalculator::invalidate(){
+    if(!valid_) return;
+    memo_ = {};
+    valid_ = false;
+}
+
+bool InbreedingCalculator::isValid() const{
+    return valid_;
+}
+
+double InbreedingCalculator::kinship(size_t first, size_t second, Memo& memo) const{
+    if(!mayBeRelated(first, second)) return 0;
+    // Deep pedigrees would overflow the call stack, so pairs waiting for the coefficients of their parents are kept on an explicit stack.
+    std::vector<std::pair<size_t, size_t>> stack {{first, second}};
+    auto key = [this](size_t a, size_t b){
+        return pairKey(positions_.find(a), positions_.find(b));
+    };
+    while(!stack.empty()){
+        auto [younger, older] = stack.back();
+        uint64_t pair = key(younger, older);
+        if(memo.contains(pair)){
+            stack.pop_back();
+            continue;
+        }
+        // The person ranked later cannot be an ancestor of the other one, so it is the one replaced by its parents.
+        if(ranks_[positions_.find(younger)] < ranks_[positions_.find(older)]) std::swap(younger, older);
+        const std::array<Step, 2>& parents = parents_[positions_.find(younger)];
+        const auto& [father, mother] = parents;
+        std::array<std::pair<size_t, size_t>, 2> pairs;
+        std::array<double, 2> weights;
+        size_t count = 0;
+        double value = 0;
+        if(younger == older){
+            value = 0.5;
+            if(mayBeRelated(father.person, mother.person)){
+                pairs[count] = {father.person, mother.person};
+                weights[count++] = 0.5 * weight(father.generations - 1) * weight(mother.generations - 1);
+            }
+        }
+        else{
+            for(const Step& parent : parents){
+                if(!mayBeRelated(parent.person, older)) continue;
+                pairs[count] = {parent.person, older};
+                weights[count++] = weight(parent.generations);
+            }
+        }
+        bool ready = true;
+        for(size_t i = 0; i < count; ++i){
+            auto found = memo.find(key(pairs[i].first, pairs[i].second));
+            if(found == memo.end()){
+                stack.push_back(pairs[i]);
+                ready = false;
+            }
+            else value += weights[i] * found->second;
+        }
+        if(!ready) continue;
+        memo.emplace(pair, value);
+        stack.pop_back();
+    }
+    return memo.at(key(first, second));
+}
+
+bool InbreedingCalculator::mayBeRelated(size_t first, size_t second) const{
+    if(first == 0 || second == 0) return false;
+    size_t firstPosition = positions_.find(first);
+    size_t secondPosition = positions_.find(second);
+    if(firstPosition >= components_.size() || secondPosition >= components_.size()) return false;
+    return components_[firstPosition] == components_[secondPosition];
+}
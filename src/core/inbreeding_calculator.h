@@ -0,0 +1,100 @@
+/// @file inbreeding_calculator.h Header file for the calculator of kinship and inbreeding coefficients.
+#ifndef inbreeding_calculator_h_
+#define inbreeding_calculator_h_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "person.h"
+#include "record_map.h"
+#include "relationship_calculator.h"
+
+/// Ancestors of a person in one generation, which shows how much the pedigree collapsed.
+struct CollapsedGeneration{
+    /// Number of the generation, 1 for the parents.
+    int generation;
+    /// Number of ancestors in a pedigree without any collapse, which is 2 to the power of the generation.
+    double expected;
+    /// Number of known places in the pedigree, an ancestor reached by more lines of descent is counted for each of them.
+    double positions;
+    /// Number of distinct known ancestors.
+    size_t distinct;
+};
+
+/// Calculator of Wright's coefficients of kinship and inbreeding over the resolved fathers and mothers.
+/// Persons are ranked in topological order, so the younger person of a pair is always expanded to its parents and the recursion ends at the founders.
+/// Coefficients of the pairs are memoized, so each pair of ancestors is computed only once however many lines of descent lead to it.
+/// The calculator is only a cache, it has to be invalidated when persons, relations or templates change and built again before it is used.
+class InbreedingCalculator{
+    public:
+        /// Default constructor of an invalid calculator.
+        InbreedingCalculator();
+        /// Take the parents of all persons and rank the persons.
+        /// @param persons Container of all persons.
+        /// @param relationships Calculator with the resolved parents, it has to be built.
+        void build(const RecordMap<Person>& persons, const RelationshipCalculator& relationships);
+        /// Count ancestors of the person in each generation.
+        /// @param person Id of the person.
+        /// @param generations Number of generations to count, 0 for all of them.
+        /// @return Generations from the parents up to the oldest known ancestors.
+        std::vector<CollapsedGeneration> findCollapse(size_t person, int generations = 0) const;
+        /// Find the inbreeding coefficient of the person, the probability that both alleles at a locus are identical by descent.
+        /// @param person Id of the person.
+        /// @return Coefficient from 0 to 1.
+        double findInbreeding(size_t person);
+        /// Find the inbreeding coefficients of the persons on several threads.
+        /// @param persons Ids of the persons.
+        /// @return Coefficients in the order of the persons.
+        std::vector<double> findInbreedings(const std::vector<size_t>& persons) const;
+        /// Find the kinship coefficient of two persons, the probability that alleles picked from both of them are identical by descent.
+        /// @param first Id of the first person.
+        /// @param second Id of the second person.
+        /// @return Coefficient from 0 to 1, it is one half of the relatedness.
+        double findKinship(size_t first, size_t second);
+        /// Find the kinship coefficients of all pairs of the persons on several threads.
+        /// @param persons Ids of the persons.
+        /// @return Symmetric matrix of the coefficients in the order of the persons.
+        std::vector<std::vector<double>> findKinships(const std::vector<size_t>& persons) const;
+        /// Mark the calculator to be built again.
+        void invalidate();
+        /// If the calculator reflects the current persons and relations.
+        /// @return True if it was built after the last change.
+        bool isValid() const;
+    private:
+        /// Memoized coefficients by the positions of both persons.
+        using Memo = std::unordered_map<uint64_t, double>;
+        /// Step to a parent.
+        using Step = RelationshipCalculator::Step;
+        /// Pedigree component of each person by its position, persons in different components have no common ancestor.
+        std::vector<size_t> components_;
+        /// Coefficients memoized by the single queries.
+        Memo memo_;
+        /// Father and mother of each person by the position of the person, parents which would close a cycle are left out.
+        std::vector<std::array<Step, 2>> parents_;
+        /// Positions of the persons, which index the vectors.
+        RecordPositions positions_;
+        /// Topological rank of each person by its position, parents are ranked before their children.
+        std::vector<size_t> ranks_;
+        /// If the calculator was built after the last change.
+        bool valid_;
+        /// Compute the inbreeding coefficient from the parents.
+        /// @param person Id of the person.
+        /// @param memo Coefficients known so far, the computed ones are added.
+        /// @return Inbreeding coefficient.
+        double inbreeding(size_t person, Memo& memo) const;
+        /// Compute the kinship coefficient without recursion.
+        /// @param first Id of the first person.
+        /// @param second Id of the second person.
+        /// @param memo Coefficients known so far, the computed ones are added.
+        /// @return Kinship coefficient.
+        double kinship(size_t first, size_t second, Memo& memo) const;
+        /// If the persons may have a common ancestor.
+        /// @param first Id of the first person.
+        /// @param second Id of the second person.
+        /// @return False if one of the persons is unknown or they are in different components.
+        bool mayBeRelated(size_t first, size_t second) const;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/// @file json_string.cpp Source file for writing strings in JSON format.
+#include "json_string.h"
+
+// =====================================================================
+// JsonString
+// =====================================================================
+
+JsonString::JsonString(const std::string& str) : str_(str){}
+
+const std::string& JsonString::str() const{
+    return str_;
+}
+
+// =====================================================================
+// functions for JsonString
+// =====================================================================
+
+std::ostream& operator<<(std::ostream& os, const JsonString& js){
+    static const char hex[] = "0123456789abcdef";
+    const std::string& str = js.str();
+    os.put('"');
+    size_t written = 0;
+    for(size_t i = 0; i < str.size(); ++i){
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        if(c >= 0x20 && c != '"' && c != '\\') continue;
+        // Write the part without special characters at once.
+        os.write(str.data() + written, i - written);
+        written = i + 1;
+        switch(c){
+            case '"':
+                os << "\\\"";
+                break;
+            case '\\':
+                os << "\\\\";
+                break;
+            case '\b':
+                os << "\\b";
+                break;
+            case '\f':
+                os << "\\f";
+                break;
+            case '\n':
+                os << "\\n";
+                break;
+            case '\r':
+                os << "\\r";
+                break;
+            case '\t':
+                os << "\\t";
+                break;
+            default:
+                os << "\\u00" << hex[c >> 4] << hex[c & 0xF];
+                break;
+        }
+    }
+    os.write(str.data() + written, str.size() - written);
+    os.put('"');
+    return os;
+}
@@ -0,0 +1,28 @@
+/// @file json_string.h Header file for writing strings in JSON format.
+#ifndef json_string_h_
+#define json_string_h_
+
+#include <string>
+#include <ostream>
+
+/// Wrapper of a string, which is written to a stream as a quoted JSON string with all special characters escaped.
+class JsonString{
+	public:
+		/// Default constructor.
+		/// @param str Wrapped string. It must outlive the wrapper.
+		explicit JsonString(const std::string& str);
+		/// Get the wrapped string.
+		/// @return Constant reference to the wrapped string.
+		const std::string& str() const;
+	private:
+		/// Wrapped string.
+		const std::string& str_;
+};
+
+/// Writing a string to given stream in JSON formatting (quoted and escaped).
+/// @param os Given stream.
+/// @param js Given wrapped string.
+/// @return Reference to the changed stream.
+std::ostream& operator<<(std::ostream& os, const JsonString& js);
+
+#endif
@@ -0,0 +1,153 @@
+/// @file kinship_graph.cpp Source file for the graph of relatives resolved from the relations.
+#include "kinship_graph.h"
+#include <algorithm>
+#include "strings.h"
+
+// =====================================================================
+// Kin
+// =====================================================================
+
+Kin kin::kind(Trait trait, int generations){
+    switch(trait){
+        case Fatherhood:
+        case Motherhood:
+            if(generations > 0) return KIN_PARENT;
+            if(generations < 0) return KIN_CHILD;
+            return KIN_OTHER;
+        case Partnership:
+            return KIN_PARTNER;
+        case Sibling:
+            return KIN_SIBLING;
+        case None:
+        default:
+            return KIN_OTHER;
+    }
+}
+
+// =====================================================================
+// KinshipGraph
+// =====================================================================
+
+KinshipGraph::KinshipGraph() : valid_(false){}
+
+void KinshipGraph::build(const RecordMap<Person>& persons, const RecordMap<Relation>& relations, const Settings& settings){
+    positions_ = RecordPositions(persons);
+    // Both directions of a relation by positions of the persons, first person's view is resolved as is, the second one has the generation difference negated.
+    std::vector<std::pair<size_t, Kinship>> resolved;
+    resolved.reserve(relations.size() * 2);
+    for(auto&& [id, rel] : relations){
+        size_t first = rel->getFirstPerson();
+        size_t second = rel->getSecondPerson();
+        // Ids of unknown persons come from damaged records, so they must not size the rows.
+        if(!persons.contains(first) || !persons.contains(second)) continue;
+        Trait trait = None;
+        int generations = 0;
+        const std::string* firstName = &EMPTY_STRING;
+        const std::string* secondName = &EMPTY_STRING;
+        auto optTempl = settings.getRelationTemplate(rel->getTemplate());
+        if(optTempl){
+            trait = (*optTempl)->getTrait();
+            generations = (*optTempl)->getGenerationDifference();
+            firstName = &(*optTempl)->getFirstName();
+            secondName = &(*optTempl)->getSecondName();
+        }
+        resolved.push_back({positions_.find(first), Kinship{second, id, trait, generations, secondName}});
+        resolved.push_back({positions_.find(second), Kinship{first, id, trait, -generations, firstName}});
+    }
+    offsets_.assign(positions_.size() * kin::COUNT + 1, 0);
+    for(auto&& [person, kinship] : resolved)
+        ++offsets_[person * kin::COUNT + kin::kind(kinship.trait, kinship.generations) + 1];
+    for(size_t i = 1; i < offsets_.size(); ++i)
+        offsets_[i] += offsets_[i - 1];
+    // Relations are visited in the order of ids, so filling the rows in the same order keeps each row sorted.
+    std::vector<size_t> next (offsets_.begin(), offsets_.end() - 1);
+    edges_.resize(resolved.size());
+    for(auto&& [person, kinship] : resolved)
+        edges_[next[person * kin::COUNT + kin::kind(kinship.trait, kinship.generations)]++] = kinship;
+    valid_ = true;
+}
+
+std::optional<std::vector<Kinship>> KinshipGraph::findPath(size_t from, size_t to) const{
+    if(from == to) return std::vector<Kinship>();
+    /// Person reached by one of the searches.
+    struct Visit{
+        /// Person the search came from, 0 for the start.
+        size_t previous;
+        /// Edge from the previous person.
+        const Kinship* edge;
+        /// Number of relations from the start.
+        size_t depth;
+    };
+    std::unordered_map<size_t, Visit> forward {{from, Visit{0, nullptr, 0}}};
+    std::unordered_map<size_t, Visit> backward {{to, Visit{0, nullptr, 0}}};
+    std::vector<size_t> forwardFrontier {from};
+    std::vector<size_t> backwardFrontier {to};
+    std::optional<size_t> meeting;
+    size_t best = 0;
+    while(!meeting && !forwardFrontier.empty() && !backwardFrontier.empty()){
+        // The smaller frontier is expanded by a whole level and the closest meeting of the level gives the shortest chain.
+        bool isForward = forwardFrontier.size() <= backwardFrontier.size();
+        std::unordered_map<size_t, Visit>& visited = isForward ? forward : backward;
+        const std::unordered_map<size_t, Visit>& other = isForward ? backward : forward;
+        std::vector<size_t>& frontier = isForward ? forwardFrontier : backwardFrontier;
+        std::vector<size_t> next;
+        for(size_t person : frontier){
+            size_t depth = visited.at(person).depth + 1;
+            for(const Kinship& relative : getRelatives(person)){
+                if(!visited.try_emplace(relative.person, Visit{person, &relative, depth}).second) continue;
+                next.push_back(relative.person);
+                auto found = other.find(relative.person);
+                if(found != other.end() && (!meeting || depth + found->second.depth < best)){
+                    meeting = relative.person;
+                    best = depth + found->second.depth;
+                }
+            }
+        }
+        frontier = std::move(next);
+    }
+    if(!meeting) return {};
+    std::vector<Kinship> path;
+    for(size_t person = *meeting; person != from;){
+        const Visit& visit = forward.at(person);
+        path.push_back(*visit.edge);
+        person = visit.previous;
+    }
+    std::reverse(path.begin(), path.end());
+    // Edges of the backward search lead towards the meeting, so the opposite edges are taken.
+    for(size_t person = *meeting; person != to;){
+        const Visit& visit = backward.at(person);
+        path.push_back(**getRelative(person, visit.edge->relation));
+        person = visit.previous;
+    }
+    return path;
+}
+
+std::optional<const Kinship*> KinshipGraph::getRelative(size_t person, size_t relation) const{
+    for(auto&& kinship : getRelatives(person))
+        if(kinship.relation == relation)
+            return &kinship;
+    return {};
+}
+
+std::span<const Kinship> KinshipGraph::getRelatives(size_t person) const{
+    size_t position = positions_.find(person);
+    return range(position * kin::COUNT, (position + 1) * kin::COUNT);
+}
+
+std::span<const Kinship> KinshipGraph::getRelatives(size_t person, Kin kind) const{
+    size_t position = positions_.find(person);
+    return range(position * kin::COUNT + kind, position * kin::COUNT + kind + 1);
+}
+
+void KinshipGraph::invalidate(){
+    valid_ = false;
+}
+
+bool KinshipGraph::isValid() const{
+    return valid_;
+}
+
+std::span<const Kinship> KinshipGraph::range(size_t from, size_t to) const{
+    if(to >= offsets_.size()) return {};
+    return std::span<const Kinship>(edges_.data() + offsets_[from], edges_.data() + offsets_[to]);
+}
@@ -0,0 +1,98 @@
+/// @file kinship_graph.h Header file for the graph of relatives resolved from the relations.
+#ifndef kinship_graph_h_
+#define kinship_graph_h_
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "config.h"
+#include "family_tree_items.h"
+#include "person.h"
+#include "record_map.h"
+
+/// Kind of the relative as seen from the person.
+enum Kin {KIN_PARENT, KIN_CHILD, KIN_PARTNER, KIN_SIBLING, KIN_OTHER};
+
+/// Namespace for everything with kinds of relatives.
+namespace kin{
+    /// Number of kinds of relatives.
+    constexpr size_t COUNT = 5;
+    /// Kind of the relative by the trait of the relation.
+    /// @param trait Trait of the relation.
+    /// @param generations How many generations is the relative older.
+    /// @return Kind of the relative. Parenthood without a generation difference is other.
+    Kin kind(Trait trait, int generations);
+}
+
+/// Relative of a person, which is one edge of the kinship graph.
+struct Kinship{
+    /// Id of the relative.
+    size_t person;
+    /// Id of the relation.
+    size_t relation;
+    /// Trait of the relation.
+    Trait trait;
+    /// How many generations is the relative older, negative if it is younger.
+    int generations;
+    /// Name of the relative in the relation. It points to the template, which outlives the graph.
+    const std::string* name;
+};
+
+/// Relatives of all persons resolved with the relation templates.
+/// Edges are stored in one vector in compressed sparse rows, so relatives of a person are a contiguous range grouped by their kind.
+/// Within a kind the relatives are ordered by ids of the relations. Rows are indexed by positions of the persons, relations of unknown persons are left out.
+/// The graph is only a cache, it has to be invalidated when persons are added or removed or when relations or templates change and built again before it is used.
+class KinshipGraph{
+    public:
+        /// Default constructor of an invalid graph.
+        KinshipGraph();
+        /// Build the graph from all relations.
+        /// @param persons Container of all persons.
+        /// @param relations Container of all relations.
+        /// @param settings Settings with the relation templates.
+        void build(const RecordMap<Person>& persons, const RecordMap<Relation>& relations, const Settings& settings);
+        /// Find the shortest chain of relations between two persons by a breadth-first search from both of them.
+        /// @param from Id of the first person.
+        /// @param to Id of the second person.
+        /// @return Optionally relatives on the way from the first person to the second one, each named in its relation with the previous person.
+        /// Empty vector for the same person and empty optional if the persons are not connected.
+        std::optional<std::vector<Kinship>> findPath(size_t from, size_t to) const;
+        /// Get the relative by the relation.
+        /// @param person Id of the person.
+        /// @param relation Id of the relation of the person.
+        /// @return Optionally pointer to the relative or empty if the person is not in the relation.
+        std::optional<const Kinship*> getRelative(size_t person, size_t relation) const;
+        /// Get all relatives of the person.
+        /// @param person Id of the person.
+        /// @return Relatives grouped by their kind.
+        std::span<const Kinship> getRelatives(size_t person) const;
+        /// Get relatives of the person of given kind.
+        /// @param person Id of the person.
+        /// @param kind Kind of the relatives.
+        /// @return Relatives ordered by ids of the relations.
+        std::span<const Kinship> getRelatives(size_t person, Kin kind) const;
+        /// Mark the graph to be built again.
+        void invalidate();
+        /// If the graph reflects the current persons and relations.
+        /// @return True if it was built after the last change.
+        bool isValid() const;
+    private:
+        /// Relatives of all persons.
+        std::vector<Kinship> edges_;
+        /// Beginning of the relatives of each person and kind at index position * kin::COUNT + kind, the last item is the number of edges.
+        std::vector<size_t> offsets_;
+        /// Positions of the persons, which index the rows.
+        RecordPositions positions_;
+        /// If the graph was built after the last change.
+        bool valid_;
+        /// Get the relatives between two offsets.
+        /// @param from Index of the first offset.
+        /// @param to Index of the last offset.
+        /// @return Relatives in the range or empty if the person is not in the graph.
+        std::span<const Kinship> range(size_t from, size_t to) const;
+};
+
+#endif
@@ -0,0 +1,155 @@
+/// @file logger.cpp Source file for the buffered logger.
+#include "logger.h"
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+// =====================================================================
+// Log levels
+// =====================================================================
+
+const std::string& logging::str(LogLevel level){
+    static const std::string names[] = {"debug", "info", "warning", "error"};
+    return names[level];
+}
+
+// =====================================================================
+// Logger
+// =====================================================================
+
+namespace{
+    /// How often the background thread writes the messages.
+    constexpr std::chrono::seconds FLUSH_INTERVAL(1);
+
+    /// Write one line of the log.
+    /// @param os Opened log file.
+    /// @param time When the message was logged.
+    /// @param level Severity of the message.
+    /// @param message Text of the message.
+    void writeLine(std::ostream& os, std::chrono::system_clock::time_point time, LogLevel level, const std::string& message){
+        auto time_t = std::chrono::system_clock::to_time_t(time);
+        os << std::put_time(std::localtime(&time_t), "%Y-%m-%d %X") << " [" << logging::str(level) << "]: " << message << '\n';
+    }
+}
+
+Logger::Logger() : begin_(0), buffer_(CAPACITY), dropped_(0), lastDropped_(false), lastLevel_(LOG_ERROR), level_(LOG_INFO), rate_(0), repeated_(0), size_(0), stop_(false){
+    flusher_ = std::thread([this](){run();});
+}
+
+Logger::~Logger(){
+    {
+        std::lock_guard lock (mutex_);
+        stop_ = true;
+    }
+    condition_.notify_one();
+    flusher_.join();
+}
+
+void Logger::flush(){
+    writeBuffer();
+}
+
+void Logger::log(const std::string& message, LogLevel level){
+    std::unique_lock lock (mutex_);
+    if(level < level_ || file_.empty()) return;
+    if(level == lastLevel_ && message == last_){
+        if(lastDropped_) ++dropped_;
+        else ++repeated_;
+        return;
+    }
+    pushRepeated();
+    last_ = message;
+    lastLevel_ = level;
+    auto now = std::chrono::steady_clock::now();
+    if(now - rateStart_ >= std::chrono::seconds(1)){
+        rateStart_ = now;
+        rate_ = 0;
+    }
+    // Errors are rare and important, so only less severe messages are rate-limited.
+    lastDropped_ = level < LOG_ERROR && rate_ >= RATE_LIMIT;
+    if(lastDropped_){
+        ++dropped_;
+        return;
+    }
+    ++rate_;
+    push(level, message);
+    if(level == LOG_ERROR){
+        // Error may be followed by a crash, so it is written before the call returns.
+        lock.unlock();
+        writeBuffer();
+    }
+    // Waking the thread up for each message would cost more than the message itself.
+    else if(size_ >= CAPACITY / 2) condition_.notify_one();
+}
+
+void Logger::push(LogLevel level, const std::string& message){
+    Entry& entry = buffer_[(begin_ + size_) % CAPACITY];
+    if(size_ == CAPACITY){
+        begin_ = (begin_ + 1) % CAPACITY;
+        ++dropped_;
+    }
+    else ++size_;
+    entry.level = level;
+    entry.message = message;
+    entry.time = std::chrono::system_clock::now();
+}
+
+void Logger::pushRepeated(){
+    if(repeated_ == 0) return;
+    push(lastLevel_, "Previous message repeated " + std::to_string(repeated_) + " times.");
+    repeated_ = 0;
+}
+
+void Logger::run(){
+    std::unique_lock lock (mutex_);
+    while(!stop_){
+        condition_.wait_for(lock, FLUSH_INTERVAL, [this](){return stop_ || size_ >= CAPACITY / 2;});
+        lock.unlock();
+        writeBuffer();
+        lock.lock();
+    }
+    lock.unlock();
+    writeBuffer();
+}
+
+void Logger::setFile(const std::filesystem::path& file){
+    writeBuffer();
+    std::lock_guard lock (mutex_);
+    file_ = file;
+    last_.clear();
+}
+
+void Logger::setLevel(LogLevel level){
+    std::lock_guard lock (mutex_);
+    level_ = level;
+}
+
+void Logger::writeBuffer(){
+    std::lock_guard writeLock (writeMutex_);
+    std::vector<Entry> entries;
+    size_t dropped;
+    std::filesystem::path file;
+    {
+        std::lock_guard lock (mutex_);
+        pushRepeated();
+        entries.reserve(size_);
+        for(size_t i = 0; i < size_; ++i)
+            entries.push_back(std::move(buffer_[(begin_ + i) % CAPACITY]));
+        begin_ = 0;
+        size_ = 0;
+        dropped = dropped_;
+        dropped_ = 0;
+        file = file_;
+    }
+    if((entries.empty() && dropped == 0) || file.empty()) return;
+    try{
+        std::ofstream os (file, std::ios_base::app);
+        for(auto&& entry : entries)
+            writeLine(os, entry.time, entry.level, entry.message);
+        if(dropped > 0)
+            writeLine(os, std::chrono::system_clock::now(), LOG_WARNING, std::to_string(dropped) + " messages were dropped.");
+    } catch(std::exception& e){
+        std::cerr << e.what() << std::endl;
+    }
+}
@@ -0,0 +1,111 @@
+/// @file logger.h Header file for the buffered logger writing messages on a background thread.
+#ifndef logger_h_
+#define logger_h_
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Severity of logged messages.
+enum LogLevel {LOG_DEBUG, LOG_INFO, LOG_WARNING, LOG_ERROR};
+
+/// Namespace for constants with log levels.
+namespace logging{
+    /// All levels from the least severe.
+    constexpr LogLevel AllLevels[] = {LOG_DEBUG, LOG_INFO, LOG_WARNING, LOG_ERROR};
+    /// Name of the level written to the log.
+    /// @param level Given level.
+    /// @return Constant reference to the name.
+    const std::string& str(LogLevel level);
+}
+
+/// Logger keeping messages in a ring buffer in memory. They are written to the file by a background thread,
+/// so logging itself does not touch the file system. Repeated messages are merged and a burst of messages is rate-limited.
+/// Errors are written at once together with the buffered messages, so they are not lost if the application crashes.
+class Logger{
+    public:
+        /// Maximal number of messages waiting in the buffer, older messages are overwritten.
+        static constexpr size_t CAPACITY = 1024;
+        /// Maximal number of messages accepted in one second. Errors are not limited.
+        static constexpr size_t RATE_LIMIT = 200;
+        /// Constructor, which starts the background thread.
+        Logger();
+        /// Destructor, which writes the rest of the messages and stops the background thread.
+        ~Logger();
+        /// Logger cannot be copied.
+        Logger(const Logger&) = delete;
+        /// Logger cannot be copied.
+        Logger& operator=(const Logger&) = delete;
+        /// Write all buffered messages to the file now.
+        void flush();
+        /// Add message to the log. Errors are written to the file before it returns.
+        /// @param message Text of the message.
+        /// @param level Severity of the message.
+        void log(const std::string& message, LogLevel level = LOG_ERROR);
+        /// Set the file with the log. Buffered messages are written to the previous file.
+        /// @param file Path to the file, messages are ignored if it is empty.
+        void setFile(const std::filesystem::path& file);
+        /// Set the least severe level which is logged.
+        /// @param level Given level.
+        void setLevel(LogLevel level);
+    private:
+        /// One buffered message.
+        struct Entry{
+            /// Severity of the message.
+            LogLevel level;
+            /// Text of the message.
+            std::string message;
+            /// When the message was logged.
+            std::chrono::system_clock::time_point time;
+        };
+        /// Index of the oldest message in the ring buffer.
+        size_t begin_;
+        /// Ring buffer of messages.
+        std::vector<Entry> buffer_;
+        /// Wakes the background thread up.
+        std::condition_variable condition_;
+        /// Number of messages dropped since the last write.
+        size_t dropped_;
+        /// Path to the log file.
+        std::filesystem::path file_;
+        /// Background thread writing the messages.
+        std::thread flusher_;
+        /// Last logged message.
+        std::string last_;
+        /// If the last logged message was dropped by rate-limiting.
+        bool lastDropped_;
+        /// Level of the last logged message.
+        LogLevel lastLevel_;
+        /// Least severe level which is logged.
+        LogLevel level_;
+        /// Guards the buffer and all counters.
+        std::mutex mutex_;
+        /// Add message to the ring buffer. Mutex has to be locked.
+        /// @param level Severity of the message.
+        /// @param message Text of the message.
+        void push(LogLevel level, const std::string& message);
+        /// Add the number of repetitions of the last message to the buffer. Mutex has to be locked.
+        void pushRepeated();
+        /// Number of messages accepted in the current second.
+        size_t rate_;
+        /// Start of the current second for rate-limiting.
+        std::chrono::steady_clock::time_point rateStart_;
+        /// How many times the last message was repeated and not written yet.
+        size_t repeated_;
+        /// Run the background thread.
+        void run();
+        /// Number of messages in the ring buffer.
+        size_t size_;
+        /// If the background thread should end.
+        bool stop_;
+        /// Take all the messages from the buffer and write them to the file at once.
+        void writeBuffer();
+        /// Guards the order of writes to the file.
+        std::mutex writeMutex_;
+};
+
+#endif
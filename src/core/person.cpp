@@ -1,20 +1,86 @@
 /// @file person.cpp Source file for all classes closely related to person.
 #include "person.h"
 
+// =====================================================================
+// FileReferences
+// =====================================================================
+
+void FileReferences::addBlob(const std::string& blob){
+    if(!blob.empty()) ++blobs_[blob];
+}
+
+void FileReferences::addFile(size_t fileId){
+    files_.insert(fileId);
+    if(getReferences(fileId) == 0) orphans_.insert(fileId);
+}
+
+void FileReferences::addReference(size_t fileId){
+    if(++references_[fileId] == 1) orphans_.erase(fileId);
+}
+
+void FileReferences::clear(){
+    blobs_.clear();
+    files_.clear();
+    orphans_.clear();
+    references_.clear();
+}
+
+const std::set<size_t>& FileReferences::getOrphans() const{
+    return orphans_;
+}
+
+size_t FileReferences::getReferences(size_t fileId) const{
+    auto it = references_.find(fileId);
+    return it == references_.end() ? 0 : it->second;
+}
+
+bool FileReferences::removeBlob(const std::string& blob){
+    if(blob.empty()) return true;
+    auto it = blobs_.find(blob);
+    if(it == blobs_.end()) return true;
+    if(--it->second > 0) return false;
+    blobs_.erase(it);
+    return true;
+}
+
+void FileReferences::removeFile(size_t fileId){
+    files_.erase(fileId);
+    orphans_.erase(fileId);
+}
+
+void FileReferences::removeReference(size_t fileId){
+    auto it = references_.find(fileId);
+    if(it == references_.end()) return;
+    if(--it->second > 0) return;
+    references_.erase(it);
+    if(files_.contains(fileId)) orphans_.insert(fileId);
+}
+
 // =====================================================================
 // VirtualDrive
 // =====================================================================
 
 VirtualDrive::VirtualDrive(const std::string& name) : name_(name){}
 
+VirtualDrive::VirtualDrive(const VirtualDrive& other){
+    copyDrive(other);
+}
+
+VirtualDrive& VirtualDrive::operator=(const VirtualDrive& other){
+    if(this != &other) copyDrive(other);
+    return *this;
+}
+
 void VirtualDrive::addFile(size_t fileId){
     bool exists = std::any_of(files_.begin(), files_.end(), [fileId](size_t file){return file == fileId;});
     if(exists) return;
     files_.push_back(fileId);
+    if(references_) references_->addReference(fileId);
 }
 
 VirtualDrive* VirtualDrive::addSubdrive(){
     subdrives_.push_back(std::make_unique<VirtualDrive>());
+    subdrives_.back()->references_ = references_;
     return subdrives_.at(subdrives_.size() - 1).get();
 }
 
@@ -23,10 +89,14 @@ VirtualDrive* VirtualDrive::addSubdrive(const std::string& name){
         if(pSubdrive->getName() == name) return pSubdrive.get();
     }
     subdrives_.push_back(std::make_unique<VirtualDrive>(name));
+    subdrives_.back()->references_ = references_;
     return subdrives_.at(subdrives_.size() - 1).get();
 }
 
 void VirtualDrive::copyDrive(const VirtualDrive& other, size_t plusIndex){
+    // Replaced files are uncounted and the copied ones counted again.
+    FileReferences* references = references_;
+    setReferences(nullptr);
     name_ = other.getName();
     files_.clear();
     subdrives_.clear();
@@ -35,6 +105,7 @@ void VirtualDrive::copyDrive(const VirtualDrive& other, size_t plusIndex){
         subdrives_.push_back(std::make_unique<VirtualDrive>(subdrive->getName()));
         subdrives_[subdrives_.size() - 1]->copyDrive(*subdrive, plusIndex);
     }
+    setReferences(references);
 }
 
 const std::vector<size_t>& VirtualDrive::getFiles() const{
@@ -49,6 +120,14 @@ const std::vector<std::unique_ptr<VirtualDrive>>& VirtualDrive::getSubdrives() c
     return subdrives_;
 }
 
+void VirtualDrive::readBinary(BinaryReader& reader){
+    reader.read(name_);
+    reader.read(files_);
+    size_t subdrives = reader.read<size_t>();
+    for(size_t i = 0; i < subdrives; ++i)
+        addSubdrive()->readBinary(reader);
+}
+
 void VirtualDrive::readJson(const Json::Value& value){
     name_ = value[jsonlabel::NAME].asString();
     for(Json::ArrayIndex i = 0; i < value[jsonlabel::FILES].size(); ++i){
@@ -62,18 +141,33 @@ void VirtualDrive::readJson(const Json::Value& value){
 
 void VirtualDrive::remove(const std::string& subfolderName){
     auto it = std::find_if(subdrives_.begin(), subdrives_.end(), [subfolderName](const std::unique_ptr<VirtualDrive>& drive){return drive->getName() == subfolderName;});
-    if (it != subdrives_.end()) subdrives_.erase(it);
+    if (it == subdrives_.end()) return;
+    (*it)->setReferences(nullptr);
+    subdrives_.erase(it);
 }
 
 void VirtualDrive::removeFile(size_t id){
     auto it = std::find_if(files_.begin(), files_.end(), [id](size_t fileId){return id == fileId;});
-    if (it != files_.end()) files_.erase(it);
+    if (it == files_.end()) return;
+    files_.erase(it);
+    if(references_) references_->removeReference(id);
 }
 
 void VirtualDrive::rename(const std::string& name){
     name_ = name;
 }
 
+void VirtualDrive::setReferences(FileReferences* references){
+    if(references == references_) return;
+    for(auto&& file : files_){
+        if(references_) references_->removeReference(file);
+        if(references) references->addReference(file);
+    }
+    references_ = references;
+    for(auto&& subdrive : subdrives_)
+        subdrive->setReferences(references);
+}
+
 void VirtualDrive::usedFiles(std::vector<size_t>& used) const{
     std::copy(files_.begin(), files_.end(), std::back_inserter(used));
     for(auto&& subdrive : subdrives_){
@@ -81,13 +175,21 @@ void VirtualDrive::usedFiles(std::vector<size_t>& used) const{
     }
 }
 
+void VirtualDrive::writeBinary(BinaryWriter& writer) const{
+    writer.write(name_);
+    writer.write(files_);
+    writer.write(subdrives_.size());
+    for(auto&& subdrive : subdrives_)
+        subdrive->writeBinary(writer);
+}
+
 // =====================================================================
 // functions for VirtualDrive
 // =====================================================================
 
 std::ostream& operator<<(std::ostream& os, const VirtualDrive& vd){
     os << "{";
-    os << "\"" << jsonlabel::NAME << "\":\"" << vd.getName() << "\"";
+    os << "\"" << jsonlabel::NAME << "\":" << JsonString(vd.getName());
     os << ",\"" << jsonlabel::FILES << "\":[";
     bool first = true;
     for(auto&& file : vd.getFiles()){
@@ -157,7 +259,7 @@ void Person::addTag(const std::string& tag, const std::string& value){
 			return;
 		}
 	}
-	tags_.push_back(std::make_pair(tag,value));
+	tags_.emplace_back(tag, value);
 }
 
 WrappedDate* Person::birthDate(){
@@ -179,18 +281,18 @@ std::pair<bool, const std::string&> Person::existsTag(const std::string& tag) co
 
 void Person::exportJson(std::ostream& os, bool includingEvents, bool includingRelations){
     os << "{\"" << jsonlabel::ID << "\":" << getId();
-	os << ",\"" << jsonlabel::NAME << "\":\"" << getName() << "\"";
-	os << ",\"" << jsonlabel::SURNAME << "\":\"" << getSurname() << "\"";
-	os << ",\"" << jsonlabel::MAIDEN_NAME << "\":\"" << getMaidenName() << "\"";
+	os << ",\"" << jsonlabel::NAME << "\":" << JsonString(getName());
+	os << ",\"" << jsonlabel::SURNAME << "\":" << JsonString(getSurname());
+	os << ",\"" << jsonlabel::MAIDEN_NAME << "\":" << JsonString(getMaidenName());
 	os << ",\"" << jsonlabel::GENDER << "\":" << getGender();
 	os << ", \"" << jsonlabel::BIRTH << "\":{" << getBirthDate();
-	os << ", \"" << jsonlabel::PLACE << "\":\"" << getBirthPlace() << "\"}";
+	os << ", \"" << jsonlabel::PLACE << "\":" << JsonString(getBirthPlace()) << "}";
 	os << ", \"" << jsonlabel::LIVES << "\":" << isAlive();
-	os << ", \"" << jsonlabel::FRONT_TITLE << "\":\"" << getFrontTitle() << "\"";
-	os << ",\"" << jsonlabel::AFTER_TITLE << "\":\"" << getAfterTitle() << "\"";
+	os << ", \"" << jsonlabel::FRONT_TITLE << "\":" << JsonString(getFrontTitle());
+	os << ",\"" << jsonlabel::AFTER_TITLE << "\":" << JsonString(getAfterTitle());
 	if(!isAlive()){
 		os << ", \"" << jsonlabel::DEATH << "\":{" << getDeathDate();
-		os << ", \"" << jsonlabel::PLACE << "\":\"" << getDeathPlace() << "\"}";
+		os << ", \"" << jsonlabel::PLACE << "\":" << JsonString(getDeathPlace()) << "}";
 	}
 	if(includingRelations){
         os << ", \"" << jsonlabel::FATHER << "\":" << getFather();
@@ -208,8 +310,8 @@ void Person::exportJson(std::ostream& os, bool includingEvents, bool includingRe
 			os <<",";
 		}
 		first = false;
-		os << "{\"" << jsonlabel::TAG << "\":\"" << tag << "\"";
-		os <<  ",\"" << jsonlabel::VALUE << "\":\"" << value << "\"}";
+		os << "{\"" << jsonlabel::TAG << "\":" << JsonString(tag);
+		os <<  ",\"" << jsonlabel::VALUE << "\":" << JsonString(value) << "}";
 	}
 	os << "]";
 	os << "}";
@@ -313,7 +415,7 @@ const std::string& Person::getSurname() const{
 	return surname_;
 }
 
-const std::vector<std::pair<std::string, std::string>>& Person::getTags() const{
+const std::vector<std::pair<Symbol, std::string>>& Person::getTags() const{
 	return tags_;
 }
 
@@ -394,6 +496,35 @@ void Person::promoteRelation(size_t id, Trait type){
     }
 }
 
+void Person::readBinary(BinaryReader& reader){
+	id_ = reader.read<size_t>();
+	reader.read(name_);
+	reader.read(surname_);
+	reader.read(maidenName_);
+	gender_ = Gender(reader.read<int>());
+	dateOfBirth_.readBinary(reader);
+	reader.read(placeOfBirth_);
+	lives_ = reader.read<bool>();
+	reader.read(titleInFront_);
+	reader.read(titleAfter_);
+	dateOfDeath_.readBinary(reader);
+	reader.read(placeOfDeath_);
+	father_ = reader.read<size_t>();
+	mother_ = reader.read<size_t>();
+	partner_ = reader.read<size_t>();
+	reader.read(events_);
+	reader.read(relations_);
+	rootMediaDrive_.readBinary(reader);
+	rootFileDrive_.readBinary(reader);
+	rootNoteDrive_.readBinary(reader);
+	size_t tags = reader.read<size_t>();
+	tags_.resize(tags);
+	for(auto&& [tag, value] : tags_){
+		reader.read(tag);
+		reader.read(value);
+	}
+}
+
 void Person::readJson(const Json::Value& value){
 	id_ = value[jsonlabel::ID].asUInt64();
 	name_ = value[jsonlabel::NAME].asString();
@@ -452,8 +583,8 @@ void Person::setBirthDate(int y, int m, int d){
     dateOfBirth_.setText() = EMPTY_STRING;
 }
 
-std::string& Person::setBirthPlace(){
-	return placeOfBirth_;
+void Person::setBirthPlace(const std::string& place){
+	placeOfBirth_ = place;
 }
 
 void Person::setDeathDate(int y, int m, int d){
@@ -462,8 +593,8 @@ void Person::setDeathDate(int y, int m, int d){
     dateOfDeath_.setText() = EMPTY_STRING;
 }
 
-std::string& Person::setDeathPlace(){
-	return placeOfDeath_;
+void Person::setDeathPlace(const std::string& place){
+	placeOfDeath_ = place;
 }
 
 void Person::setFather(size_t father){
@@ -553,6 +684,34 @@ void Person::updateSpecialRelation(size_t relId, Trait trait){
         partner_ = 0;
 }
 
+void Person::writeBinary(BinaryWriter& writer) const{
+	writer.write(id_);
+	writer.write(name_);
+	writer.write(surname_);
+	writer.write(maidenName_);
+	writer.write(static_cast<int>(gender_));
+	dateOfBirth_.writeBinary(writer);
+	writer.write(placeOfBirth_);
+	writer.write(lives_);
+	writer.write(titleInFront_);
+	writer.write(titleAfter_);
+	dateOfDeath_.writeBinary(writer);
+	writer.write(placeOfDeath_);
+	writer.write(father_);
+	writer.write(mother_);
+	writer.write(partner_);
+	writer.write(events_);
+	writer.write(relations_);
+	rootMediaDrive_.writeBinary(writer);
+	rootFileDrive_.writeBinary(writer);
+	rootNoteDrive_.writeBinary(writer);
+	writer.write(tags_.size());
+	for(auto&& [tag, value] : tags_){
+		writer.write(tag);
+		writer.write(value);
+	}
+}
+
 // =====================================================================
 // functions for Person
 // =====================================================================
@@ -572,18 +731,18 @@ void printSizeTContainer(std::ostream& os, const std::vector<size_t>& container,
 
 std::ostream& operator<<(std::ostream& os, const Person& p){
 	os << "{\"" << jsonlabel::ID << "\":" << p.getId();
-	os << ",\"" << jsonlabel::NAME << "\":\"" << p.getName() << "\"";
-	os << ",\"" << jsonlabel::SURNAME << "\":\"" << p.getSurname() << "\"";
-	os << ",\"" << jsonlabel::MAIDEN_NAME << "\":\"" << p.getMaidenName() << "\"";
+	os << ",\"" << jsonlabel::NAME << "\":" << JsonString(p.getName());
+	os << ",\"" << jsonlabel::SURNAME << "\":" << JsonString(p.getSurname());
+	os << ",\"" << jsonlabel::MAIDEN_NAME << "\":" << JsonString(p.getMaidenName());
 	os << ",\"" << jsonlabel::GENDER << "\":" << p.getGender();
 	os << ", \"" << jsonlabel::BIRTH << "\":{" << p.getBirthDate();
-	os << ", \"" << jsonlabel::PLACE << "\":\"" << p.getBirthPlace() << "\"}";
+	os << ", \"" << jsonlabel::PLACE << "\":" << JsonString(p.getBirthPlace()) << "}";
 	os << ", \"" << jsonlabel::LIVES << "\":" << p.isAlive();
-	os << ", \"" << jsonlabel::FRONT_TITLE << "\":\"" << p.getFrontTitle() << "\"";
-	os << ",\"" << jsonlabel::AFTER_TITLE << "\":\"" << p.getAfterTitle() << "\"";
+	os << ", \"" << jsonlabel::FRONT_TITLE << "\":" << JsonString(p.getFrontTitle());
+	os << ",\"" << jsonlabel::AFTER_TITLE << "\":" << JsonString(p.getAfterTitle());
 	if(!p.isAlive()){
 		os << ", \"" << jsonlabel::DEATH << "\":{" << p.getDeathDate();
-		os << ", \"" << jsonlabel::PLACE << "\":\"" << p.getDeathPlace() << "\"}";
+		os << ", \"" << jsonlabel::PLACE << "\":" << JsonString(p.getDeathPlace()) << "}";
 	}
 	os << ", \"" << jsonlabel::FATHER << "\":" << p.getFather();
 	os << ", \"" << jsonlabel::MOTHER << "\":" << p.getMother();
@@ -600,8 +759,8 @@ std::ostream& operator<<(std::ostream& os, const Person& p){
 			os <<",";
 		}
 		first = false;
-		os << "{\"" << jsonlabel::TAG << "\":\"" << tag << "\"";
-		os <<  ",\"" << jsonlabel::VALUE << "\":\"" << value << "\"}";
+		os << "{\"" << jsonlabel::TAG << "\":" << JsonString(tag);
+		os <<  ",\"" << jsonlabel::VALUE << "\":" << JsonString(value) << "}";
 	}
 	os << "]";
 	os << "}";
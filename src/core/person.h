@@ -3,13 +3,63 @@
 #define person_h_
 
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <ostream>
+#include <set>
 #include <sstream>
 #include <json/json.h>
+#include "binary_cache.h"
 #include "date.h"
 #include "strings.h"
+#include "json_string.h"
 #include "config.h"
+#include "symbol.h"
+
+/// Reference counts of files of one type, which are used in the virtual drives of persons in the family tree.
+/// Existing files without any reference are kept aside as orphans, so they are known without walking the drives.
+/// Records sharing one stored file are counted too, so the stored file is removed with its last record.
+class FileReferences{
+    public:
+        /// Record using the shared stored file was added to the family tree.
+        /// @param blob Name of the stored file, empty if the record has its own file.
+        void addBlob(const std::string& blob);
+        /// Record of the file was added to the family tree.
+        /// @param fileId Id of the file.
+        void addFile(size_t fileId);
+        /// Drive started to use the file.
+        /// @param fileId Id of the file.
+        void addReference(size_t fileId);
+        /// Forget all files, stored files and references.
+        void clear();
+        /// Get files, which exist, but no drive uses them.
+        /// @return Constant reference to the ids of orphan files.
+        const std::set<size_t>& getOrphans() const;
+        /// Get the number of drives using the file.
+        /// @param fileId Id of the file.
+        /// @return Number of references.
+        size_t getReferences(size_t fileId) const;
+        /// Record using the shared stored file was removed from the family tree.
+        /// @param blob Name of the stored file, empty if the record had its own file.
+        /// @return True if no other record uses the stored file, so it can be deleted.
+        bool removeBlob(const std::string& blob);
+        /// Record of the file was removed from the family tree.
+        /// @param fileId Id of the file.
+        void removeFile(size_t fileId);
+        /// Drive stopped using the file.
+        /// @param fileId Id of the file.
+        void removeReference(size_t fileId);
+    private:
+        /// Number of records using each shared stored file.
+        std::unordered_map<std::string, size_t> blobs_;
+        /// Ids of existing files.
+        std::unordered_set<size_t> files_;
+        /// Ids of existing files without any reference.
+        std::set<size_t> orphans_;
+        /// Number of references of the files by their ids, files without any reference are left out.
+        std::unordered_map<size_t, size_t> references_;
+};
 
 /// Class for virtualization of folder structure for each person.
 class VirtualDrive{
@@ -19,6 +69,13 @@ class VirtualDrive{
         /// Constructor for known name.
         /// @param name Name of this folder.
         explicit VirtualDrive(const std::string& name);
+        /// Copy constructor, which copies all the sub-folders.
+        /// @param other Copied folder.
+        VirtualDrive(const VirtualDrive& other);
+        /// Copy assignment, which copies all the sub-folders.
+        /// @param other Copied folder.
+        /// @return Reference to this folder.
+        VirtualDrive& operator=(const VirtualDrive& other);
         /// Add file to the folder by its id. Only if it is not already there.
         /// @param fileId Id of the file.
         void addFile(size_t fileId);
@@ -42,6 +99,9 @@ class VirtualDrive{
         /// Get constant reference to the container of files.
         /// @return Constant reference to the container of pointers to virtual drives.
         const std::vector<std::unique_ptr<VirtualDrive>>& getSubdrives() const;
+        /// Load data from the binary image.
+        /// @param reader Reader of the image.
+        void readBinary(BinaryReader& reader);
         /// Load data from JSON value.
         /// @param value Given JSON value.
         void readJson(const Json::Value& value);
@@ -54,14 +114,23 @@ class VirtualDrive{
         /// Rename this folder.
         /// @param name New name of this folder.
         void rename(const std::string& name);
+        /// Count files of this folder and all its sub-folders in given references instead of the current ones.
+        /// Drives of persons in the family tree are counted, copies made elsewhere are not.
+        /// @param references References of the family tree, or nullptr to stop counting.
+        void setReferences(FileReferences* references);
         /// Vector of all used files.
         /// @param used Vector of all files contained in this folder and sub-folders.
         void usedFiles(std::vector<size_t>& used) const;
+        /// Write data to the binary image.
+        /// @param writer Writer of the image.
+        void writeBinary(BinaryWriter& writer) const;
     private:
         /// Container of all files.
         std::vector<size_t> files_;
         /// Name of the folder.
         std::string name_;
+        /// References updated by changes of this folder, or nullptr.
+        FileReferences* references_ = nullptr;
         /// Container of pointers to the sub-folders.
         std::vector<std::unique_ptr<VirtualDrive>> subdrives_;
 };
@@ -179,7 +248,7 @@ class Person{
 		const std::string& getSurname() const;
 		/// Get all tags.
 		/// @return Constant reference to the tags container.
-		const std::vector<std::pair<std::string, std::string>>& getTags() const;
+		const std::vector<std::pair<Symbol, std::string>>& getTags() const;
 		/// Import person from single file JSON. Some values may not be present from the import.
 		/// @param value JSON value.
 		void importJson(const Json::Value& value);
@@ -193,6 +262,9 @@ class Person{
 		/// @param id Of the relation.
 		/// @param type Type of the relation.
 		void promoteRelation(size_t id, Trait type);
+		/// Read data from the binary image to this person.
+		/// @param reader Reader of the image.
+		void readBinary(BinaryReader& reader);
 		/// Read data from JSON to this person.
 		/// @param value Loaded JSON data from the file.
 		void readJson(const Json::Value& value);
@@ -213,17 +285,17 @@ class Person{
 		/// @param m Number of month.
 		/// @param y Number of year.
 		void setBirthDate(int y, int m, int d);
-		/// Set the birth place by giving reference to the string.
-		/// @return Reference to the birth place.
-		std::string& setBirthPlace();
+		/// Set the birth place.
+		/// @param place New birth place.
+		void setBirthPlace(const std::string& place);
 		/// Set the exact death date.
 		/// @param d Number of day.
 		/// @param m Number of month.
 		/// @param y Number of year.
 		void setDeathDate(int y, int m, int d);
-		/// Set the death place by giving reference to the string.
-		/// @return Reference to the death place.
-		std::string& setDeathPlace();
+		/// Set the death place.
+		/// @param place New death place.
+		void setDeathPlace(const std::string& place);
 		/// Set father for the person. If father is present put him into relations.
 		/// @param father Index to fatherhood relation.
 		void setFather(size_t father);
@@ -266,6 +338,9 @@ class Person{
 		/// @param relId Which id it has.
 		/// @param trait Which trait it now has.
 		void updateSpecialRelation(size_t relId, Trait trait);
+		/// Write data of this person to the binary image.
+		/// @param writer Writer of the image.
+		void writeBinary(BinaryWriter& writer) const;
 	private:
 	    /// Date of birth.
 		WrappedDate dateOfBirth_;
@@ -290,9 +365,9 @@ class Person{
 		/// Id of the partnership relation.
 		size_t partner_;
 		/// Place of birth.
-		std::string placeOfBirth_;
+		Symbol placeOfBirth_;
 		/// Place of death.
-		std::string placeOfDeath_;
+		Symbol placeOfDeath_;
 		/// All relations ids (from Family Tree).
 		std::vector<size_t> relations_;
 		/// Root drive for files.
@@ -304,7 +379,7 @@ class Person{
 		/// Surname of the person.
 		std::string surname_;
 		/// Persons tags. First is the tag itself and second is the value.
-		std::vector<std::pair<std::string, std::string>> tags_;
+		std::vector<std::pair<Symbol, std::string>> tags_;
         /// Title that is after the name.
 		std::string titleAfter_;
 		/// Title that is in front of a name.
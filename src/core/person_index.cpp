@@ -0,0 +1,244 @@
+/// @file person_index.cpp Source file for the full-text search index of persons.
+#include "person_index.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace{
+    /// Base letters of U+00C0 to U+017F, space for symbols.
+    const char* const LATIN_FOLD =
+        "aaaaaaaceeeeiiiidnooooo ouuuuytsaaaaaaaceeeeiiiidnooooo ouuuuyty"
+        "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiiiiijjkkklllllll"
+        "lllnnnnnnnnnoooooooorrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+    /// Weight of names, surnames and maiden names.
+    constexpr size_t WEIGHT_NAME = 3;
+    /// Weight of birth and death places.
+    constexpr size_t WEIGHT_PLACE = 2;
+    /// Weight of titles and values of tags.
+    constexpr size_t WEIGHT_OTHER = 1;
+    /// Score of a term equal to the word.
+    constexpr size_t QUALITY_EXACT = 3;
+    /// Score of a term starting with the word.
+    constexpr size_t QUALITY_PREFIX = 2;
+    /// Score of a term starting with the word up to a typo.
+    constexpr size_t QUALITY_TYPO = 1;
+
+    /// Split normalized text to words.
+    /// @param text Normalized text.
+    /// @return Vector of words.
+    std::vector<std::string> words(const std::string& text){
+        std::vector<std::string> result;
+        std::istringstream is (text);
+        std::string word;
+        while(is >> word)
+            result.push_back(word);
+        return result;
+    }
+
+    /// Number of typos allowed in the word.
+    /// @param word Normalized word.
+    /// @return Allowed edit distance.
+    size_t allowedTypos(const std::string& word){
+        if(word.size() < 4) return 0;
+        return word.size() < 8 ? 1 : 2;
+    }
+}
+
+// =====================================================================
+// Search
+// =====================================================================
+
+std::string search::normalize(const std::string& text){
+    std::string result;
+    result.reserve(text.size());
+    for(size_t i = 0; i < text.size(); ++i){
+        unsigned char c = text[i];
+        if(c < 0x80){
+            result.push_back(std::isalnum(c) ? std::tolower(c) : ' ');
+        }
+        else if(c >= 0xC3 && c <= 0xC5 && i + 1 < text.size() && (static_cast<unsigned char>(text[i + 1]) & 0xC0) == 0x80){
+            // Two byte sequences from U+00C0 to U+017F cover the Latin letters with diacritics.
+            size_t codepoint = ((c & 0x1F) << 6) | (static_cast<unsigned char>(text[i + 1]) & 0x3F);
+            result.push_back(codepoint >= 0xC0 ? LATIN_FOLD[codepoint - 0xC0] : ' ');
+            ++i;
+        }
+        else result.push_back(c);
+    }
+    return result;
+}
+
+size_t search::prefixDistance(const std::string& word, const std::string& term, size_t limit){
+    // Optimal string alignment distance, where the end of the term is free.
+    size_t columns = std::min(term.size(), word.size() + limit) + 1;
+    std::vector<size_t> previous (columns), current (columns), next (columns);
+    for(size_t j = 0; j < columns; ++j)
+        current[j] = j;
+    for(size_t i = 1; i <= word.size(); ++i){
+        next[0] = i;
+        size_t rowMin = next[0];
+        for(size_t j = 1; j < columns; ++j){
+            size_t cost = word[i - 1] == term[j - 1] ? 0 : 1;
+            next[j] = std::min({current[j] + 1, next[j - 1] + 1, current[j - 1] + cost});
+            if(i > 1 && j > 1 && word[i - 1] == term[j - 2] && word[i - 2] == term[j - 1])
+                next[j] = std::min(next[j], previous[j - 2] + 1);
+            rowMin = std::min(rowMin, next[j]);
+        }
+        if(rowMin > limit) return limit + 1;
+        std::swap(previous, current);
+        std::swap(current, next);
+    }
+    return std::min(*std::min_element(current.begin(), current.end()), limit + 1);
+}
+
+// =====================================================================
+// PersonIndex
+// =====================================================================
+
+PersonIndex::PersonIndex() : valid_(false){}
+
+void PersonIndex::add(const Person& person){
+    std::map<std::string, size_t> fields;
+    auto addField = [&fields](const std::string& text, size_t weight){
+        for(auto&& word : words(search::normalize(text))){
+            size_t& current = fields[word];
+            current = std::max(current, weight);
+        }
+    };
+    addField(person.getName(), WEIGHT_NAME);
+    addField(person.getSurname(), WEIGHT_NAME);
+    addField(person.getMaidenName(), WEIGHT_NAME);
+    addField(person.getBirthPlace(), WEIGHT_PLACE);
+    addField(person.getDeathPlace(), WEIGHT_PLACE);
+    addField(person.getFrontTitle(), WEIGHT_OTHER);
+    addField(person.getAfterTitle(), WEIGHT_OTHER);
+    for(auto&& [tag, value] : person.getTags())
+        addField(value, WEIGHT_OTHER);
+    std::vector<const std::string*>& personTerms = personTerms_[person.getId()];
+    for(auto&& [word, weight] : fields){
+        auto [it, inserted] = terms_.try_emplace(word);
+        if(inserted){
+            for(uint32_t gram : gramsOf(it->first))
+                grams_[gram].push_back(&it->first);
+        }
+        it->second.push_back(Posting{person.getId(), weight});
+        personTerms.push_back(&it->first);
+    }
+}
+
+std::vector<size_t> PersonIndex::find(const std::string& query, size_t limit) const{
+    std::vector<std::string> queryWords = words(search::normalize(query));
+    if(queryWords.empty()) return {};
+    std::unordered_map<size_t, size_t> total;
+    match(queryWords[0], total);
+    for(size_t i = 1; i < queryWords.size() && !total.empty(); ++i){
+        std::unordered_map<size_t, size_t> scores;
+        match(queryWords[i], scores);
+        for(auto it = total.begin(); it != total.end();){
+            auto found = scores.find(it->first);
+            if(found == scores.end())
+                it = total.erase(it);
+            else{
+                it->second += found->second;
+                ++it;
+            }
+        }
+    }
+    std::vector<std::pair<size_t, size_t>> ranked (total.begin(), total.end());
+    auto better = [](const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b){
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    };
+    if(limit != 0 && limit < ranked.size()){
+        std::partial_sort(ranked.begin(), ranked.begin() + limit, ranked.end(), better);
+        ranked.resize(limit);
+    }
+    else std::sort(ranked.begin(), ranked.end(), better);
+    std::vector<size_t> result;
+    result.reserve(ranked.size());
+    for(auto&& [person, score] : ranked)
+        result.push_back(person);
+    return result;
+}
+
+std::vector<uint32_t> PersonIndex::gramsOf(const std::string& word){
+    std::string padded = "\1\1" + word;
+    std::vector<uint32_t> grams;
+    grams.reserve(word.size());
+    for(size_t i = 0; i + 2 < padded.size(); ++i)
+        grams.push_back((static_cast<unsigned char>(padded[i]) << 16) | (static_cast<unsigned char>(padded[i + 1]) << 8) | static_cast<unsigned char>(padded[i + 2]));
+    return grams;
+}
+
+void PersonIndex::invalidate(){
+    if(!valid_) return;
+    // Assigning empty containers releases also the buckets of the hash tables.
+    grams_ = {};
+    personTerms_ = {};
+    stale_.clear();
+    terms_.clear();
+    valid_ = false;
+}
+
+void PersonIndex::invalidate(size_t person){
+    if(valid_) stale_.insert(person);
+}
+
+void PersonIndex::match(const std::string& word, std::unordered_map<size_t, size_t>& scores) const{
+    auto score = [&scores](const std::vector<Posting>& postings, size_t quality){
+        for(auto&& posting : postings){
+            size_t& best = scores[posting.person];
+            best = std::max(best, quality * posting.weight);
+        }
+    };
+    for(auto it = terms_.lower_bound(word); it != terms_.end() && it->first.starts_with(word); ++it)
+        score(it->second, it->first.size() == word.size() ? QUALITY_EXACT : QUALITY_PREFIX);
+    size_t typos = allowedTypos(word);
+    if(typos == 0) return;
+    // A term within the distance shares all trigrams of the word except at most three per edit, or four per transposition.
+    std::vector<uint32_t> grams = gramsOf(word);
+    std::unordered_map<const std::string*, size_t> shared;
+    for(uint32_t gram : grams){
+        auto found = grams_.find(gram);
+        if(found == grams_.end()) continue;
+        for(const std::string* term : found->second)
+            ++shared[term];
+    }
+    size_t required = grams.size() > 4 * typos ? grams.size() - 4 * typos : 1;
+    for(auto&& [term, count] : shared){
+        if(count < required || term->starts_with(word)) continue;
+        if(search::prefixDistance(word, *term, typos) <= typos)
+            score(terms_.at(*term), QUALITY_TYPO);
+    }
+}
+
+void PersonIndex::refresh(const RecordMap<Person>& persons){
+    if(!valid_){
+        for(auto&& [id, person] : persons)
+            add(*person);
+        valid_ = true;
+        return;
+    }
+    for(size_t id : stale_){
+        remove(id);
+        if(persons.contains(id))
+            add(*persons.at(id));
+    }
+    stale_.clear();
+}
+
+void PersonIndex::remove(size_t person){
+    auto found = personTerms_.find(person);
+    if(found == personTerms_.end()) return;
+    for(const std::string* term : found->second){
+        auto it = terms_.find(*term);
+        std::vector<Posting>& postings = it->second;
+        postings.erase(std::find_if(postings.begin(), postings.end(), [person](const Posting& posting){ return posting.person == person; }));
+        if(!postings.empty()) continue;
+        for(uint32_t gram : gramsOf(*term)){
+            std::vector<const std::string*>& gramTerms = grams_[gram];
+            gramTerms.erase(std::find(gramTerms.begin(), gramTerms.end(), term));
+            if(gramTerms.empty()) grams_.erase(gram);
+        }
+        terms_.erase(it);
+    }
+    personTerms_.erase(found);
+}
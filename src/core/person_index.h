@@ -0,0 +1,83 @@
+/// @file person_index.h Header file for the full-text search index of persons.
+#ifndef person_index_h_
+#define person_index_h_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "person.h"
+#include "record_map.h"
+
+/// Namespace for everything with searching persons.
+namespace search{
+    /// Fold the text for searching. Letters are lowercased, Latin letters lose their diacritics and everything else except digits becomes a space.
+    /// @param text Text in UTF-8.
+    /// @return Normalized text.
+    std::string normalize(const std::string& text);
+    /// Edit distance between the word and the closest prefix of the term, adjacent transpositions count as one edit.
+    /// @param word Searched word.
+    /// @param term Indexed term.
+    /// @param limit Maximum interesting distance.
+    /// @return Distance or limit + 1 if it is greater than the limit.
+    size_t prefixDistance(const std::string& word, const std::string& term, size_t limit);
+}
+
+/// Inverted index of words from names, surnames, maiden names, titles, places and values of tags of all persons.
+/// Each query word matches terms which are equal to it, start with it or start with it up to a typo. Candidates for typos are found by the trigrams they share with the word.
+/// Persons are indexed lazily: edited persons are only marked stale and they are indexed again at the next search.
+class PersonIndex{
+    public:
+        /// Default constructor of an invalid index.
+        PersonIndex();
+        /// Find persons matching all words of the query.
+        /// @param query Searched text.
+        /// @param limit Maximum number of results, 0 means all of them.
+        /// @return Ids of the persons, the best matches first.
+        std::vector<size_t> find(const std::string& query, size_t limit = 0) const;
+        /// Drop the whole index, it is built again at the next refresh.
+        void invalidate();
+        /// Mark the person to be indexed again at the next refresh.
+        /// @param person Id of the changed, added or removed person.
+        void invalidate(size_t person);
+        /// Bring the index up to date with the persons.
+        /// @param persons Container of all persons.
+        void refresh(const RecordMap<Person>& persons);
+    private:
+        /// Person containing the term.
+        struct Posting{
+            /// Id of the person.
+            size_t person;
+            /// Weight of the most important field with the term.
+            size_t weight;
+        };
+        /// Terms by the trigrams they contain.
+        std::unordered_map<uint32_t, std::vector<const std::string*>> grams_;
+        /// Terms of each indexed person, so the person can be removed.
+        std::unordered_map<size_t, std::vector<const std::string*>> personTerms_;
+        /// Persons which have to be indexed again.
+        std::set<size_t> stale_;
+        /// Persons containing each term, ordered by the terms, so terms with a common prefix are together.
+        std::map<std::string, std::vector<Posting>> terms_;
+        /// If the index was built.
+        bool valid_;
+        /// Add the person to the index.
+        /// @param person Indexed person.
+        void add(const Person& person);
+        /// Trigrams of the word padded at its beginning.
+        /// @param word Normalized word.
+        /// @return Trigrams packed to integers.
+        static std::vector<uint32_t> gramsOf(const std::string& word);
+        /// Find persons matching one word.
+        /// @param word Normalized word.
+        /// @param scores Where the best score of each person is stored.
+        void match(const std::string& word, std::unordered_map<size_t, size_t>& scores) const;
+        /// Remove the person from the index.
+        /// @param person Id of the person.
+        void remove(size_t person);
+};
+
+#endif
@@ -0,0 +1,294 @@
+/// @file record_map.h Header file for the dense container of records indexed by their ids.
+#ifndef record_map_h_
+#define record_map_h_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Container of records owned by unique pointers and indexed directly by their ids.
+/// Ids are assigned incrementally by the family tree, so the slots are dense and a lookup is a single index into the vector.
+/// Ids far beyond the number of records (e.g. from an edited file) are kept in a sparse map instead, so they never size the slots.
+/// Removed records leave an empty slot, thus ids (and pointers to the records) stay stable.
+/// The interface follows std::map, so iterating yields pairs of id and pointer in the order of ids.
+template<typename T>
+class RecordMap{
+    public:
+        /// One slot of the container. Empty slot has no record.
+        using value_type = std::pair<size_t, std::unique_ptr<T>>;
+        /// Slots always cover at least this many ids.
+        static constexpr size_t MIN_SLOTS = 1024;
+        /// Slots cover ids up to this multiple of the number of records, higher ids are sparse.
+        static constexpr size_t SLOTS_PER_RECORD = 8;
+        /// Iterator over occupied slots and then over the sparse records, both in the order of ids.
+        template<bool Const>
+        class Iterator{
+            public:
+                /// Type of the value.
+                using value_type = typename RecordMap::value_type;
+                /// Type of the iterator of the vector.
+                using SlotIterator = std::conditional_t<Const, typename std::vector<value_type>::const_iterator, typename std::vector<value_type>::iterator>;
+                /// Type of the iterator of the sparse records.
+                using SparseIterator = std::conditional_t<Const, typename std::map<size_t, value_type>::const_iterator, typename std::map<size_t, value_type>::iterator>;
+                /// Category of the iterator.
+                using iterator_category = std::forward_iterator_tag;
+                /// Type of the difference.
+                using difference_type = std::ptrdiff_t;
+                /// Type of the pointer.
+                using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+                /// Type of the reference.
+                using reference = std::conditional_t<Const, const value_type&, value_type&>;
+                /// Default constructor.
+                Iterator() = default;
+                /// Constructor, which skips empty slots.
+                /// @param it Current slot.
+                /// @param end End of the slots.
+                /// @param sparse Current sparse record, used when the slots are passed.
+                Iterator(SlotIterator it, SlotIterator end, SparseIterator sparse) : end_(end), it_(it), sparse_(sparse){
+                    skipEmpty();
+                }
+                /// Mutable iterator can be used as a constant one.
+                /// @param other Mutable iterator.
+                template<bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+                Iterator(const Iterator<OtherConst>& other) : end_(other.end_), it_(other.it_), sparse_(other.sparse_){}
+                /// Get the current slot.
+                /// @return Reference to the pair of id and record.
+                reference operator*() const{
+                    return it_ != end_ ? *it_ : sparse_->second;
+                }
+                /// Get the current slot.
+                /// @return Pointer to the pair of id and record.
+                pointer operator->() const{
+                    return &(**this);
+                }
+                /// Move to the next occupied slot.
+                /// @return Reference to this iterator.
+                Iterator& operator++(){
+                    if(it_ == end_){
+                        ++sparse_;
+                        return *this;
+                    }
+                    ++it_;
+                    skipEmpty();
+                    return *this;
+                }
+                /// Move to the next occupied slot.
+                /// @return Iterator before the move.
+                Iterator operator++(int){
+                    Iterator previous = *this;
+                    ++(*this);
+                    return previous;
+                }
+                /// Compare two iterators.
+                /// @param other The other iterator.
+                /// @return True if they point to the same slot.
+                bool operator==(const Iterator& other) const{
+                    return it_ == other.it_ && sparse_ == other.sparse_;
+                }
+            private:
+                template<bool> friend class Iterator;
+                /// End of the slots.
+                SlotIterator end_;
+                /// Current slot.
+                SlotIterator it_;
+                /// Current sparse record.
+                SparseIterator sparse_;
+                /// Move to the first occupied slot from the current one.
+                void skipEmpty(){
+                    while(it_ != end_ && !it_->second) ++it_;
+                }
+        };
+        /// Mutable iterator.
+        using iterator = Iterator<false>;
+        /// Constant iterator.
+        using const_iterator = Iterator<true>;
+        /// Default constructor.
+        RecordMap() : size_(0){}
+        /// Get the record with given id.
+        /// @param id Id of the record.
+        /// @return Reference to the pointer owning the record.
+        /// @throw std::out_of_range If there is no such record.
+        std::unique_ptr<T>& at(size_t id){
+            if(!contains(id)) throw std::out_of_range("RecordMap::at");
+            return id < slots_.size() ? slots_[id].second : sparse_.find(id)->second.second;
+        }
+        /// Get the record with given id.
+        /// @param id Id of the record.
+        /// @return Constant reference to the pointer owning the record.
+        /// @throw std::out_of_range If there is no such record.
+        const std::unique_ptr<T>& at(size_t id) const{
+            if(!contains(id)) throw std::out_of_range("RecordMap::at");
+            return id < slots_.size() ? slots_[id].second : sparse_.find(id)->second.second;
+        }
+        /// Get the first record.
+        /// @return Iterator to the record with the lowest id.
+        iterator begin(){
+            return iterator(slots_.begin(), slots_.end(), sparse_.begin());
+        }
+        /// Get the first record.
+        /// @return Iterator to the record with the lowest id.
+        const_iterator begin() const{
+            return const_iterator(slots_.begin(), slots_.end(), sparse_.begin());
+        }
+        /// Remove all records.
+        void clear(){
+            slots_.clear();
+            sparse_.clear();
+            size_ = 0;
+        }
+        /// If there is a record with given id.
+        /// @param id Id of the record.
+        /// @return True if the record exists.
+        bool contains(size_t id) const{
+            if(id < slots_.size()) return static_cast<bool>(slots_[id].second);
+            return sparse_.count(id) > 0;
+        }
+        /// Number of records with given id.
+        /// @param id Id of the record.
+        /// @return 1 if the record exists, 0 otherwise.
+        size_t count(size_t id) const{
+            return contains(id) ? 1 : 0;
+        }
+        /// If there are no records.
+        /// @return True if the container is empty.
+        bool empty() const{
+            return size_ == 0;
+        }
+        /// Get the end of the records.
+        /// @return Iterator past the last record.
+        iterator end(){
+            return iterator(slots_.end(), slots_.end(), sparse_.end());
+        }
+        /// Get the end of the records.
+        /// @return Iterator past the last record.
+        const_iterator end() const{
+            return const_iterator(slots_.end(), slots_.end(), sparse_.end());
+        }
+        /// Remove the record with given id.
+        /// @param id Id of the record.
+        /// @return Number of removed records.
+        size_t erase(size_t id){
+            if(!contains(id)) return 0;
+            if(id < slots_.size()) slots_[id].second.reset();
+            else sparse_.erase(id);
+            --size_;
+            return 1;
+        }
+        /// Remove the record at given position. Other iterators stay valid.
+        /// @param it Position of the record.
+        /// @return Iterator to the next record.
+        iterator erase(iterator it){
+            size_t id = it->first;
+            ++it;
+            erase(id);
+            return it;
+        }
+        /// Find the record with given id.
+        /// @param id Id of the record.
+        /// @return Iterator to the record or end if it does not exist.
+        iterator find(size_t id){
+            if(!contains(id)) return end();
+            if(id < slots_.size()) return iterator(slots_.begin() + id, slots_.end(), sparse_.begin());
+            return iterator(slots_.end(), slots_.end(), sparse_.find(id));
+        }
+        /// Find the record with given id.
+        /// @param id Id of the record.
+        /// @return Iterator to the record or end if it does not exist.
+        const_iterator find(size_t id) const{
+            if(!contains(id)) return end();
+            if(id < slots_.size()) return const_iterator(slots_.begin() + id, slots_.end(), sparse_.begin());
+            return const_iterator(slots_.end(), slots_.end(), sparse_.find(id));
+        }
+        /// Insert the record if there is no record with the same id.
+        /// @param entry Id and the record.
+        /// @return Iterator to the record with the id and true if the record was inserted.
+        std::pair<iterator, bool> insert(value_type&& entry){
+            size_t id = entry.first;
+            if(contains(id)) return {find(id), false};
+            ++size_;
+            if(id >= slots_.size()){
+                if(id >= std::max(MIN_SLOTS, size_ * SLOTS_PER_RECORD)){
+                    sparse_.emplace(id, std::move(entry));
+                    return {find(id), true};
+                }
+                grow(id);
+            }
+            slots_[id].second = std::move(entry.second);
+            return {find(id), true};
+        }
+        /// Number of records.
+        /// @return Number of records.
+        size_t size() const{
+            return size_;
+        }
+        /// Number of the slots, records with lower ids are stored in them and the others are sparse.
+        /// @return Number of the slots.
+        size_t slots() const{
+            return slots_.size();
+        }
+    private:
+        /// Number of records.
+        size_t size_;
+        /// Slots indexed by ids of the records.
+        std::vector<value_type> slots_;
+        /// Records with ids beyond the slots.
+        std::map<size_t, value_type> sparse_;
+        /// Add slots up to given id and move the sparse records which fit in them.
+        /// @param id Id of the new last slot.
+        void grow(size_t id){
+            // Growing geometrically keeps inserting records with increasing ids amortized constant.
+            if(id >= slots_.capacity())
+                slots_.reserve(std::max(id + 1, slots_.capacity() * 2));
+            for(size_t i = slots_.size(); i <= id; ++i)
+                slots_.emplace_back(i, nullptr);
+            while(!sparse_.empty() && sparse_.begin()->first <= id){
+                slots_[sparse_.begin()->first].second = std::move(sparse_.begin()->second.second);
+                sparse_.erase(sparse_.begin());
+            }
+        }
+};
+
+/// Dense positions of records for structures holding an item for each record.
+/// Records in the slots keep their ids as positions, sparse records follow them in the order of ids.
+/// Positions are taken when the structure is built, so it is not affected by later inserts into the container.
+class RecordPositions{
+    public:
+        /// Default constructor without any positions.
+        RecordPositions() : size_(0), slots_(0){}
+        /// Take the positions of all records of the container.
+        /// @param records Container of the records.
+        template<typename T>
+        explicit RecordPositions(const RecordMap<T>& records) : size_(records.slots()), slots_(records.slots()){
+            for(auto&& [id, record] : records)
+                if(id >= slots_) sparse_.emplace(id, size_++);
+        }
+        /// Get the position of the record.
+        /// @param id Id of the record.
+        /// @return Position of the record, or the number of positions if it was not in the container.
+        size_t find(size_t id) const{
+            if(id < slots_) return id;
+            auto it = sparse_.find(id);
+            return it == sparse_.end() ? size_ : it->second;
+        }
+        /// Number of positions.
+        /// @return Number of the slots and the sparse records.
+        size_t size() const{
+            return size_;
+        }
+    private:
+        /// Number of positions.
+        size_t size_;
+        /// Number of the slots, which are positions of the same ids.
+        size_t slots_;
+        /// Positions of the sparse records by their ids.
+        std::unordered_map<size_t, size_t> sparse_;
+};
+
+#endif
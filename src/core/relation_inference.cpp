@@ -0,0 +1,216 @@
+/// @file relation_inference.cpp Source file for the inference of missing relations from the existing ones.
+#include "relation_inference.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+namespace{
+    /// If the persons are the same or already related. Only relatives of the person with less of them are scanned.
+    /// @param kinship Graph of relatives of all persons.
+    /// @param first Id of the first person.
+    /// @param second Id of the second person.
+    /// @return True if no relation should be suggested between the persons.
+    bool related(const KinshipGraph& kinship, size_t first, size_t second){
+        if(first == second) return true;
+        auto relatives = kinship.getRelatives(first);
+        auto others = kinship.getRelatives(second);
+        if(others.size() < relatives.size()){
+            std::swap(relatives, others);
+            std::swap(first, second);
+        }
+        return std::any_of(relatives.begin(), relatives.end(), [second](const Kinship& relative){ return relative.person == second; });
+    }
+
+    /// The other parent of a child.
+    /// @param trait Trait of the known parent.
+    /// @return Motherhood for fatherhood and the other way around.
+    Trait otherParent(Trait trait){
+        return trait == Motherhood ? Fatherhood : Motherhood;
+    }
+
+    /// Append suggestions implied by a parenthood, partners of the parent are parents and its children are siblings of the child.
+    /// Siblings of the child are children of the parent and its parents are partners of the parent.
+    /// @param kinship Graph of relatives of all persons.
+    /// @param parent Id of the parent.
+    /// @param child Id of the child.
+    /// @param relation Id of the relation.
+    /// @param trait Trait of the relation.
+    /// @param suggestions Container of the suggestions.
+    void suggestParents(const KinshipGraph& kinship, size_t parent, size_t child, size_t relation, Trait trait, std::vector<RelationSuggestion>& suggestions){
+        for(const Kinship& relative : kinship.getRelatives(parent)){
+            if(relative.relation == relation) continue;
+            Kin kind = kin::kind(relative.trait, relative.generations);
+            if(kind != KIN_PARTNER && kind != KIN_CHILD) continue;
+            if(related(kinship, child, relative.person)) continue;
+            if(kind == KIN_PARTNER)
+                suggestions.push_back(RelationSuggestion(child, relative.person, false, false, otherParent(trait)));
+            else
+                suggestions.push_back(RelationSuggestion(child, relative.person, false, true, Sibling));
+        }
+        for(const Kinship& relative : kinship.getRelatives(child)){
+            if(relative.relation == relation) continue;
+            Kin kind = kin::kind(relative.trait, relative.generations);
+            if(kind != KIN_SIBLING && kind != KIN_PARENT) continue;
+            if(related(kinship, parent, relative.person)) continue;
+            if(kind == KIN_SIBLING)
+                suggestions.push_back(RelationSuggestion(parent, relative.person, true, false, trait));
+            else
+                suggestions.push_back(RelationSuggestion(parent, relative.person, false, true, Partnership));
+        }
+    }
+
+    /// Append suggestions implied by a partnership, children of one partner are children of the other one.
+    /// @param kinship Graph of relatives of all persons.
+    /// @param person Id of the partner whose children are taken.
+    /// @param second Id of the other partner.
+    /// @param relation Id of the relation.
+    /// @param suggestions Container of the suggestions.
+    void suggestPartners(const KinshipGraph& kinship, size_t person, size_t second, size_t relation, std::vector<RelationSuggestion>& suggestions){
+        for(const Kinship& child : kinship.getRelatives(person, KIN_CHILD)){
+            if(child.relation != relation && !related(kinship, second, child.person))
+                suggestions.push_back(RelationSuggestion(second, child.person, true, false, otherParent(child.trait)));
+        }
+    }
+
+    /// Append suggestions implied by siblings, parents of one sibling are parents of the other one.
+    /// @param kinship Graph of relatives of all persons.
+    /// @param person Id of the sibling whose parents are taken.
+    /// @param second Id of the other sibling.
+    /// @param relation Id of the relation.
+    /// @param suggestions Container of the suggestions.
+    void suggestSiblings(const KinshipGraph& kinship, size_t person, size_t second, size_t relation, std::vector<RelationSuggestion>& suggestions){
+        for(const Kinship& parent : kinship.getRelatives(person, KIN_PARENT)){
+            if(parent.relation != relation && !related(kinship, second, parent.person))
+                suggestions.push_back(RelationSuggestion(second, parent.person, false, false, parent.trait));
+        }
+    }
+
+    /// Append suggestions implied by the relation with a relative.
+    /// @param kinship Graph of relatives of all persons.
+    /// @param person Id of the person.
+    /// @param relative Relative of the person.
+    /// @param suggestions Container of the suggestions.
+    void suggestRelative(const KinshipGraph& kinship, size_t person, const Kinship& relative, std::vector<RelationSuggestion>& suggestions){
+        switch(kin::kind(relative.trait, relative.generations)){
+            case KIN_PARENT:
+                suggestParents(kinship, relative.person, person, relative.relation, relative.trait, suggestions);
+                break;
+            case KIN_CHILD:
+                suggestParents(kinship, person, relative.person, relative.relation, relative.trait, suggestions);
+                break;
+            case KIN_PARTNER:
+                suggestPartners(kinship, person, relative.person, relative.relation, suggestions);
+                suggestPartners(kinship, relative.person, person, relative.relation, suggestions);
+                break;
+            case KIN_SIBLING:
+                suggestSiblings(kinship, person, relative.person, relative.relation, suggestions);
+                suggestSiblings(kinship, relative.person, person, relative.relation, suggestions);
+                break;
+            default:
+                break;
+        }
+    }
+
+    /// Key of the suggested relation, which does not depend on the relation it was implied by.
+    /// @param suggestion Given suggestion.
+    /// @return Parent and child or both persons ordered by ids for symmetrical relations, with the trait.
+    std::tuple<size_t, size_t, Trait> key(const RelationSuggestion& suggestion){
+        if(suggestion.symetrical)
+            return {std::min(suggestion.lockedPerson, suggestion.suggestedPerson), std::max(suggestion.lockedPerson, suggestion.suggestedPerson), suggestion.trait};
+        if(suggestion.parent)
+            return {suggestion.lockedPerson, suggestion.suggestedPerson, suggestion.trait};
+        return {suggestion.suggestedPerson, suggestion.lockedPerson, suggestion.trait};
+    }
+}
+
+// =====================================================================
+// Inference
+// =====================================================================
+
+std::vector<std::vector<RelationSuggestion>> inference::paginate(const std::vector<std::vector<RelationSuggestion>>& groups, size_t pageSize){
+    std::vector<std::vector<RelationSuggestion>> pages;
+    pageSize = std::max<size_t>(pageSize, 1);
+    for(auto&& group : groups){
+        if(pages.empty() || pages.back().size() + group.size() > pageSize) pages.emplace_back();
+        for(const RelationSuggestion& suggestion : group){
+            // Groups bigger than a page are split.
+            if(pages.back().size() == pageSize) pages.emplace_back();
+            pages.back().push_back(suggestion);
+        }
+    }
+    return pages;
+}
+
+std::vector<RelationSuggestion> inference::suggest(const KinshipGraph& kinship, size_t person, size_t relation){
+    std::vector<RelationSuggestion> suggestions;
+    auto optRelative = kinship.getRelative(person, relation);
+    if(optRelative) suggestRelative(kinship, person, **optRelative, suggestions);
+    return suggestions;
+}
+
+std::vector<std::vector<RelationSuggestion>> inference::suggestAll(const RecordMap<Person>& persons, const KinshipGraph& kinship){
+    RecordPositions positions (persons);
+    size_t size = positions.size();
+    // Persons are joined along the relations by their positions, suggestions never leave a component, so the components are independent.
+    std::vector<size_t> roots (size);
+    for(size_t position = 0; position < size; ++position)
+        roots[position] = position;
+    auto root = [&roots](size_t position){
+        while(roots[position] != position){
+            roots[position] = roots[roots[position]];
+            position = roots[position];
+        }
+        return position;
+    };
+    for(auto&& [id, person] : persons){
+        for(const Kinship& relative : kinship.getRelatives(id))
+            if(persons.contains(relative.person)) roots[root(positions.find(relative.person))] = root(positions.find(id));
+    }
+    std::vector<size_t> componentIndex (size, size);
+    std::vector<std::vector<size_t>> components;
+    for(auto&& [id, person] : persons){
+        size_t componentRoot = root(positions.find(id));
+        if(componentIndex[componentRoot] == size){
+            componentIndex[componentRoot] = components.size();
+            components.emplace_back();
+        }
+        components[componentIndex[componentRoot]].push_back(id);
+    }
+    std::erase_if(components, [](auto&& component){ return component.size() < 2; });
+    std::vector<std::vector<RelationSuggestion>> groups (components.size());
+    // Big components are taken first, so the threads end at about the same time.
+    std::vector<size_t> order (components.size());
+    for(size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&components](size_t a, size_t b){ return components[a].size() > components[b].size(); });
+    auto process = [&](size_t index){
+        std::vector<RelationSuggestion>& group = groups[index];
+        for(size_t person : components[index]){
+            for(const Kinship& relative : kinship.getRelatives(person)){
+                // Each relation is in the rows of both persons, it is taken from the person with the smaller id.
+                if(relative.person <= person || !persons.contains(relative.person)) continue;
+                suggestRelative(kinship, person, relative, group);
+            }
+        }
+        std::erase_if(group, [&persons](const RelationSuggestion& suggestion){ return !persons.contains(suggestion.suggestedPerson); });
+        std::stable_sort(group.begin(), group.end(), [](const RelationSuggestion& a, const RelationSuggestion& b){ return key(a) < key(b); });
+        group.erase(std::unique(group.begin(), group.end(), [](const RelationSuggestion& a, const RelationSuggestion& b){ return key(a) == key(b); }),
+                    group.end());
+    };
+    size_t threads = std::min<size_t>(order.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<size_t> next = 0;
+    std::vector<std::future<void>> workers;
+    for(size_t i = 0; i < threads; ++i){
+        workers.push_back(std::async(std::launch::async, [&](){
+            for(size_t index = next++; index < order.size(); index = next++)
+                process(order[index]);
+        }));
+    }
+    for(auto&& worker : workers)
+        worker.get();
+    std::erase_if(groups, [](auto&& group){ return group.empty(); });
+    return groups;
+}
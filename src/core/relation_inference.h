@@ -0,0 +1,34 @@
+/// @file relation_inference.h Header file for the inference of missing relations from the existing ones.
+#ifndef relation_inference_h_
+#define relation_inference_h_
+
+#include <cstddef>
+#include <vector>
+#include "family_tree_items.h"
+#include "kinship_graph.h"
+#include "person.h"
+#include "record_map.h"
+
+/// Namespace for everything with inference of missing relations.
+/// A relation implies others, partners of a parent are parents too and children of the same parent are siblings.
+/// Only persons which are not related yet are suggested, which is told by scanning the relatives in the kinship graph.
+namespace inference{
+    /// Split groups of suggestions into pages, a group is kept on one page if it fits in it.
+    /// @param groups Groups of suggestions.
+    /// @param pageSize Maximum number of suggestions on one page.
+    /// @return Pages of suggestions in the order of the groups.
+    std::vector<std::vector<RelationSuggestion>> paginate(const std::vector<std::vector<RelationSuggestion>>& groups, size_t pageSize);
+    /// Suggest relations implied by one relation.
+    /// @param kinship Graph of relatives of all persons, it has to be built.
+    /// @param person Id of a person in the relation.
+    /// @param relation Id of the relation.
+    /// @return Suggestions, the same one may be made more times.
+    std::vector<RelationSuggestion> suggest(const KinshipGraph& kinship, size_t person, size_t relation);
+    /// Suggest relations implied by all relations. Each relation is visited once and connected components are processed on several threads.
+    /// @param persons Container of all persons, relations of missing persons are left out.
+    /// @param kinship Graph of relatives of all persons, it has to be built.
+    /// @return Groups of suggestions for each connected component ordered by the smallest id in it, each suggestion made once.
+    std::vector<std::vector<RelationSuggestion>> suggestAll(const RecordMap<Person>& persons, const KinshipGraph& kinship);
+}
+
+#endif
@@ -0,0 +1,235 @@
+/// @file relationship_calculator.cpp Source file for the calculator of blood relationships between persons.
+#include "relationship_calculator.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include "strings.h"
+
+namespace{
+    /// Maximum number of ancestors in the kept closures, all of them are dropped when it is exceeded.
+    constexpr size_t MAX_CACHED = 1 << 22;
+
+    /// Prefix of great- for each generation.
+    /// @param count Number of generations.
+    /// @return Repeated prefix.
+    std::string greats(int count){
+        std::string result;
+        for(int i = 0; i < count; ++i)
+            result += relationship::GREAT;
+        return result;
+    }
+
+    /// Ordinal number of the cousins.
+    /// @param number Degree of the cousins, at least 1.
+    /// @return Word or number with its suffix.
+    std::string ordinal(int number){
+        if(number <= static_cast<int>(std::size(relationship::ORDINALS)))
+            return relationship::ORDINALS[number - 1];
+        if(number % 100 >= 11 && number % 100 <= 13) return std::to_string(number) + "th";
+        switch(number % 10){
+            case 1: return std::to_string(number) + "st";
+            case 2: return std::to_string(number) + "nd";
+            case 3: return std::to_string(number) + "rd";
+            default: return std::to_string(number) + "th";
+        }
+    }
+
+    /// Fill the degree and removal of the relationship.
+    /// @param up Generations from the first person up to the ancestor.
+    /// @param down Generations from the ancestor down to the second person.
+    /// @param ancestor Id of the ancestor.
+    /// @return Relationship without the path.
+    Relationship makeRelationship(int up, int down, size_t ancestor){
+        return Relationship{ancestor, up, down, std::min(up, down) - 1, std::abs(up - down), {}};
+    }
+}
+
+// =====================================================================
+// Relationship
+// =====================================================================
+
+std::string relationship::name(const Relationship& rel, Gender gender){
+    if(rel.ancestor == 0) return NOT_RELATED;
+    if(rel.up == 0 && rel.down == 0) return SELF;
+    if(rel.up == 0 || rel.down == 0){
+        int generations = rel.up + rel.down;
+        const std::string& word = rel.up == 0 ? CHILD[gender] : PARENT[gender];
+        if(generations == 1) return word;
+        return greats(generations - 2) + GRAND + word;
+    }
+    if(rel.up == 1 && rel.down == 1) return SIBLING[gender];
+    if(rel.up == 1 || rel.down == 1){
+        // The second person is a sibling of an ancestor or a descendant of a sibling.
+        bool older = rel.down == 1;
+        auto gendered = [&rel, older](Gender g){
+            const std::string& word = older ? (g == Female ? AUNT : UNCLE) : (g == Female ? NIECE : NEPHEW);
+            return greats(std::max(rel.up, rel.down) - 2) + word;
+        };
+        if(gender == Other) return gendered(Male) + OR + gendered(Female);
+        return gendered(gender);
+    }
+    std::string result = ordinal(rel.degree) + " " + COUSIN;
+    if(rel.removal == 1) result += " " + ONCE_REMOVED;
+    else if(rel.removal == 2) result += " " + TWICE_REMOVED;
+    else if(rel.removal > 2) result += " " + std::to_string(rel.removal) + " " + TIMES_REMOVED;
+    return result;
+}
+
+// =====================================================================
+// RelationshipCalculator
+// =====================================================================
+
+RelationshipCalculator::RelationshipCalculator() : cached_(0), mark_(0), valid_(false){}
+
+const RelationshipCalculator::Ancestors& RelationshipCalculator::ancestors(size_t person){
+    auto [it, inserted] = ancestors_.try_emplace(person);
+    Ancestors& closure = it->second;
+    if(!inserted) return closure;
+    // Parents may skip generations, so the closest ancestors are found by Dijkstra's algorithm.
+    using Item = std::tuple<int, size_t, size_t>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    queue.push({0, person, 0});
+    if(++mark_ == 0){
+        std::fill(marks_.begin(), marks_.end(), 0);
+        mark_ = 1;
+    }
+    while(!queue.empty()){
+        auto [generations, current, child] = queue.top();
+        queue.pop();
+        size_t position = positions_.find(current);
+        if(position == positions_.size()){
+            closure.push_back(Ancestor{current, generations, child});
+            continue;
+        }
+        if(marks_[position] == mark_) continue;
+        marks_[position] = mark_;
+        closure.push_back(Ancestor{current, generations, child});
+        for(const Step& parent : parents_[position])
+            if(parent.person != 0 && marks_[positions_.find(parent.person)] != mark_)
+                queue.push({generations + parent.generations, parent.person, current});
+    }
+    std::sort(closure.begin(), closure.end(), [](const Ancestor& a, const Ancestor& b){ return a.person < b.person; });
+    closure.shrink_to_fit();
+    cached_ += closure.size();
+    return closure;
+}
+
+void RelationshipCalculator::build(const RecordMap<Person>& persons, const KinshipGraph& kinship){
+    ancestors_.clear();
+    cached_ = 0;
+    positions_ = RecordPositions(persons);
+    size_t size = positions_.size();
+    parents_.assign(size, {Step{0, 0}, Step{0, 0}});
+    childOffsets_.assign(size + 1, 0);
+    marks_.assign(size, 0);
+    mark_ = 0;
+    for(auto&& [id, person] : persons){
+        std::array<Step, 2>& parents = parents_[positions_.find(id)];
+        size_t promoted[] = {person->getFather(), person->getMother()};
+        Trait traits[] = {Fatherhood, Motherhood};
+        for(size_t i = 0; i < 2; ++i){
+            std::optional<const Kinship*> optParent;
+            if(promoted[i] != 0){
+                auto optRelative = kinship.getRelative(id, promoted[i]);
+                if(optRelative && kin::kind((*optRelative)->trait, (*optRelative)->generations) == KIN_PARENT)
+                    optParent = optRelative;
+            }
+            // Parents are ordered by the relation ids, so the first one of the trait is the oldest relation.
+            for(auto&& relative : kinship.getRelatives(id, KIN_PARENT)){
+                if(optParent) break;
+                if(relative.trait == traits[i]) optParent = &relative;
+            }
+            if(optParent && persons.contains((*optParent)->person) && (*optParent)->person != id){
+                parents[i] = Step{(*optParent)->person, (*optParent)->generations};
+                ++childOffsets_[positions_.find((*optParent)->person) + 1];
+            }
+        }
+    }
+    for(size_t i = 1; i < childOffsets_.size(); ++i)
+        childOffsets_[i] += childOffsets_[i - 1];
+    std::vector<size_t> next (childOffsets_.begin(), childOffsets_.end() - 1);
+    children_.resize(childOffsets_.back());
+    for(auto&& [id, person] : persons)
+        for(const Step& parent : parents_[positions_.find(id)])
+            if(parent.person != 0)
+                children_[next[positions_.find(parent.person)]++] = Step{id, parent.generations};
+    valid_ = true;
+}
+
+std::span<const RelationshipCalculator::Step> RelationshipCalculator::children(size_t person) const{
+    size_t position = positions_.find(person);
+    if(position + 1 >= childOffsets_.size()) return {};
+    return std::span<const Step>(children_.data() + childOffsets_[position], children_.data() + childOffsets_[position + 1]);
+}
+
+Relationship RelationshipCalculator::find(size_t first, size_t second){
+    // Closures are dropped before the queried ones are taken, so the references stay valid.
+    if(cached_ > MAX_CACHED){
+        ancestors_.clear();
+        cached_ = 0;
+    }
+    const Ancestors& firstAncestors = ancestors(first);
+    const Ancestors& secondAncestors = ancestors(second);
+    // Ancestors of the smaller closure are searched in the rest of the larger one, the closest common ancestor has the least generations in total.
+    bool firstSmaller = firstAncestors.size() <= secondAncestors.size();
+    const Ancestors& smaller = firstSmaller ? firstAncestors : secondAncestors;
+    const Ancestors& larger = firstSmaller ? secondAncestors : firstAncestors;
+    Relationship best = Relationship{0, -1, -1, -1, 0, {}};
+    auto from = larger.begin();
+    for(const Ancestor& ancestor : smaller){
+        from = std::lower_bound(from, larger.end(), ancestor.person, [](const Ancestor& a, size_t id){ return a.person < id; });
+        if(from == larger.end()) break;
+        if(from->person != ancestor.person) continue;
+        int up = firstSmaller ? ancestor.generations : from->generations;
+        int down = firstSmaller ? from->generations : ancestor.generations;
+        if(best.ancestor == 0 || std::make_tuple(up + down, up, ancestor.person) < std::make_tuple(best.up + best.down, best.up, best.ancestor))
+            best = makeRelationship(up, down, ancestor.person);
+    }
+    if(best.ancestor == 0) return best;
+    auto childOf = [](const Ancestors& closure, size_t id){
+        return std::lower_bound(closure.begin(), closure.end(), id, [](const Ancestor& a, size_t id){ return a.person < id; })->child;
+    };
+    for(size_t current = best.ancestor; current != 0; current = childOf(firstAncestors, current))
+        best.path.push_back(current);
+    std::reverse(best.path.begin(), best.path.end());
+    for(size_t current = childOf(secondAncestors, best.ancestor); current != 0; current = childOf(secondAncestors, current))
+        best.path.push_back(current);
+    return best;
+}
+
+std::map<size_t, Relationship> RelationshipCalculator::findAll(size_t proband){
+    // Every ancestor of the proband is a source at its distance, descendants are reached in the order of the total generations.
+    using Item = std::tuple<int, int, size_t, size_t>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    for(const Ancestor& ancestor : ancestors(proband))
+        queue.push({ancestor.generations, ancestor.generations, ancestor.person, ancestor.person});
+    std::map<size_t, Relationship> result;
+    while(!queue.empty()){
+        auto [total, up, ancestor, current] = queue.top();
+        queue.pop();
+        if(!result.try_emplace(current, makeRelationship(up, total - up, ancestor)).second) continue;
+        for(const Step& child : children(current))
+            if(!result.contains(child.person))
+                queue.push({total + child.generations, up, ancestor, child.person});
+    }
+    return result;
+}
+
+std::array<RelationshipCalculator::Step, 2> RelationshipCalculator::getParents(size_t person) const{
+    size_t position = positions_.find(person);
+    if(position >= parents_.size()) return {Step{0, 0}, Step{0, 0}};
+    return parents_[position];
+}
+
+void RelationshipCalculator::invalidate(){
+    if(!valid_) return;
+    ancestors_ = {};
+    cached_ = 0;
+    valid_ = false;
+}
+
+bool RelationshipCalculator::isValid() const{
+    return valid_;
+}
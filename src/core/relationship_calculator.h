@@ -0,0 +1,119 @@
+/// @file relationship_calculator.h Header file for the calculator of blood relationships between persons.
+#ifndef relationship_calculator_h_
+#define relationship_calculator_h_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "kinship_graph.h"
+#include "person.h"
+#include "record_map.h"
+
+/// How two persons are related by blood through their closest common ancestor.
+struct Relationship{
+    /// Id of the closest common ancestor, 0 if the persons have none.
+    size_t ancestor;
+    /// Generations from the first person up to the ancestor, -1 if the persons are not related.
+    int up;
+    /// Generations from the ancestor down to the second person, -1 if the persons are not related.
+    int down;
+    /// Degree of the cousins, the lower of both generation counts minus one. It is 0 for siblings and -1 for direct lines.
+    int degree;
+    /// How many generations are the persons apart.
+    int removal;
+    /// Ids of the persons from the first one up to the ancestor and down to the second one, both included.
+    std::vector<size_t> path;
+};
+
+/// Namespace for everything with relationships.
+namespace relationship{
+    /// Name what the second person is to the first one, for example second cousin twice removed.
+    /// @param rel Relationship of the persons.
+    /// @param gender Gender of the second person.
+    /// @return Name of the relationship.
+    std::string name(const Relationship& rel, Gender gender);
+}
+
+/// Calculator of relationships through the lowest common ancestors.
+/// Each person has at most one father and one mother, the promoted ones or the parents with the lowest relation ids.
+/// Ancestors of the queried persons are kept in sorted closures, so repeated queries of the same persons only intersect them.
+/// The calculator is only a cache, it has to be invalidated when persons, relations or templates change and built again before it is used.
+class RelationshipCalculator{
+    public:
+        /// One step between a parent and a child.
+        struct Step{
+            /// Id of the parent or the child, 0 for none.
+            size_t person;
+            /// How many generations the step takes.
+            int generations;
+        };
+        /// Default constructor of an invalid calculator.
+        RelationshipCalculator();
+        /// Resolve parents of all persons.
+        /// @param persons Container of all persons.
+        /// @param kinship Graph of relatives of all persons.
+        void build(const RecordMap<Person>& persons, const KinshipGraph& kinship);
+        /// Find how the second person is related to the first one.
+        /// @param first Id of the first person.
+        /// @param second Id of the second person.
+        /// @return Relationship through the closest common ancestor.
+        Relationship find(size_t first, size_t second);
+        /// Find how all persons are related to the proband, in one pass down from the ancestors of the proband.
+        /// @param proband Id of the proband.
+        /// @return Relationships without paths by ids of the related persons, the proband included.
+        std::map<size_t, Relationship> findAll(size_t proband);
+        /// Get the resolved parents of the person.
+        /// @param person Id of the person.
+        /// @return Father and mother with the generations to them, person 0 for an unknown parent.
+        std::array<Step, 2> getParents(size_t person) const;
+        /// Mark the calculator to be built again.
+        void invalidate();
+        /// If the calculator reflects the current persons and relations.
+        /// @return True if it was built after the last change.
+        bool isValid() const;
+    private:
+        /// Ancestor in the closure of a person.
+        struct Ancestor{
+            /// Id of the ancestor.
+            size_t person;
+            /// Generations from the person up to the ancestor.
+            int generations;
+            /// Child of the ancestor on the way to the person, 0 for the person itself.
+            size_t child;
+        };
+        /// Ancestors of a person ordered by their ids, including the person itself.
+        using Ancestors = std::vector<Ancestor>;
+        /// Closures of the queried persons.
+        std::unordered_map<size_t, Ancestors> ancestors_;
+        /// Number of ancestors in all kept closures.
+        size_t cached_;
+        /// Children of all persons.
+        std::vector<Step> children_;
+        /// Beginning of the children of each person by its position, the last item is the number of children.
+        std::vector<size_t> childOffsets_;
+        /// Mark of the last search of ancestors.
+        uint32_t mark_;
+        /// Marks of the persons visited by the searches of ancestors by their positions.
+        std::vector<uint32_t> marks_;
+        /// Father and mother of each person by the position of the person.
+        std::vector<std::array<Step, 2>> parents_;
+        /// Positions of the persons, which index the vectors.
+        RecordPositions positions_;
+        /// If the calculator was built after the last change.
+        bool valid_;
+        /// Get the closure of ancestors of the person, it is computed if it is not known yet.
+        /// @param person Id of the person.
+        /// @return Ancestors with their distances.
+        const Ancestors& ancestors(size_t person);
+        /// Get the children of the person.
+        /// @param person Id of the person.
+        /// @return Children with the generations between them.
+        std::span<const Step> children(size_t person) const;
+};
+
+#endif
@@ -149,6 +149,124 @@ namespace relation{
     const std::string DESC_SIBLINGS = "Relation between brother and sister.";
 }
 
+// =====================================================================
+// Names of relationships.
+// =====================================================================
+
+/// Namespace for strings naming how two persons are related. Arrays are indexed by the gender.
+namespace relationship{
+    /// String for the same person.
+    const std::string SELF = "same person";
+    /// String for persons without a common ancestor.
+    const std::string NOT_RELATED = "not related";
+    /// Strings for parents.
+    const std::string PARENT[] = {"parent", "father", "mother"};
+    /// Strings for children.
+    const std::string CHILD[] = {"child", "son", "daughter"};
+    /// Strings for siblings.
+    const std::string SIBLING[] = {"sibling", "brother", "sister"};
+    /// String for uncle.
+    const std::string UNCLE = "uncle";
+    /// String for aunt.
+    const std::string AUNT = "aunt";
+    /// String for nephew.
+    const std::string NEPHEW = "nephew";
+    /// String for niece.
+    const std::string NIECE = "niece";
+    /// String for cousin.
+    const std::string COUSIN = "cousin";
+    /// Prefix for the second generation.
+    const std::string GRAND = "grand";
+    /// Prefix for each further generation.
+    const std::string GREAT = "great-";
+    /// String joining names of both genders.
+    const std::string OR = " or ";
+    /// Ordinal numbers of cousins.
+    const std::string ORDINALS[] = {"first", "second", "third", "fourth", "fifth", "sixth", "seventh", "eighth", "ninth", "tenth"};
+    /// String for cousins one generation apart.
+    const std::string ONCE_REMOVED = "once removed";
+    /// String for cousins two generations apart.
+    const std::string TWICE_REMOVED = "twice removed";
+    /// String for cousins more generations apart.
+    const std::string TIMES_REMOVED = "times removed";
+    /// String for persons without any chain of relations between them.
+    const std::string NOT_CONNECTED = "The persons are not connected by any relations.";
+    /// String between the steps of a chain of relations.
+    const std::string ARROW = " \u2192 ";
+}
+
+// =====================================================================
+// Validation of the database.
+// =====================================================================
+
+/// Namespace for strings describing inconsistencies of the database. Each # is replaced by the id of the record and then of the reference.
+namespace validation{
+    /// Descriptions of the inconsistencies indexed by their kind.
+    const std::string ISSUES[] = {
+        "Relation # refers to the missing person #.",
+        "Relation # uses the missing template #.",
+        "Relation # is not listed by its person #.",
+        "Person # lists the relation #, which does not exist or does not include the person.",
+        "Father, mother or partner of the person # is the relation #, which is not a fitting relation of the person.",
+        "Event # refers to the missing person #.",
+        "Event # uses the missing template #.",
+        "Event # is not listed by its person #.",
+        "Person # lists the event #, which does not exist or does not include the person.",
+    };
+    /// Short names of the inconsistencies indexed by their kind, the number of them follows.
+    const std::string KINDS[] = {
+        "Relations of missing persons: ",
+        "Relations with missing templates: ",
+        "Relations not listed by their persons: ",
+        "Missing relations listed by persons: ",
+        "Unfitting fathers, mothers or partners: ",
+        "Events of missing persons: ",
+        "Events with missing templates: ",
+        "Events not listed by their persons: ",
+        "Missing events listed by persons: ",
+    };
+    /// String for persons in a cycle of ancestry, ids of the persons follow.
+    const std::string CYCLE = "Persons are their own ancestors: ";
+    /// String for the number of cycles of ancestry.
+    const std::string CYCLES = "Cycles of ancestry: ";
+    /// String introducing the numbers of inconsistencies.
+    const std::string SUMMARY = "The database is inconsistent, each inconsistency is written in the log.";
+    /// String for a consistent database.
+    const std::string CONSISTENT = "Database is consistent.";
+    /// String appended to repaired inconsistencies.
+    const std::string REPAIRED = " Repaired.";
+    /// String asking to repair the found inconsistencies.
+    const std::string REPAIR_QUESTION = "Do you want to repair the inconsistencies, which can be repaired?";
+}
+
+// =====================================================================
+// Inference of relations.
+// =====================================================================
+
+/// Namespace for strings of relations inferred in the whole tree.
+namespace inference{
+    /// String for a tree without any missing relations.
+    const std::string NO_SUGGESTIONS = "No missing relations were found.";
+    /// Title of a page of the suggestions, the number of the page and the number of pages follow.
+    const std::string PAGE = "Suggested relations, page ";
+    /// String between the number of the page and the number of pages.
+    const std::string OF = " of ";
+}
+
+// =====================================================================
+// Duplicate persons.
+// =====================================================================
+
+/// Namespace for strings of persons recorded more times.
+namespace duplicates{
+    /// String for a tree without duplicate persons.
+    const std::string NO_DUPLICATES = "No duplicate persons were found.";
+    /// String asking to merge two persons, the persons follow on their own lines.
+    const std::string QUESTION = "Are these persons the same? The second one will be merged into the first one.";
+    /// String before the similarity of the persons in percents.
+    const std::string SIMILARITY = "Similarity: ";
+}
+
 // =====================================================================
 // Default events.
 // =====================================================================
@@ -411,6 +529,18 @@ namespace jsonlabel{
     const std::string LINE_WIDTH = "line width";
     /// JSON Label border radius.
     const std::string BORDER_RADIUS = "radius";
+    /// JSON Label for configuration.
+    const std::string CONFIG = "config";
+    /// JSON Label for the database file of a journal record.
+    const std::string JOURNAL_FILE = "file";
+    /// JSON Label for the stored record in the journal.
+    const std::string RECORD = "record";
+    /// JSON Label for a removed record in the journal.
+    const std::string REMOVED = "removed";
+    /// JSON Label for the shared stored file with the same content.
+    const std::string BLOB = "blob";
+    /// JSON Label for storing files with the same content only once.
+    const std::string DEDUPLICATE_FILES = "deduplicate files";
 }
 
 #endif
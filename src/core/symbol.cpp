@@ -0,0 +1,60 @@
+/// @file symbol.cpp Source file for strings interned in a table shared by the whole application.
+#include "symbol.h"
+#include <mutex>
+#include <unordered_set>
+
+namespace{
+    /// Entry of the empty string, which does not need the table.
+    const std::string& emptySymbol(){
+        static const std::string empty;
+        return empty;
+    }
+
+    /// Intern the string in the table shared by the whole application.
+    /// @param text Interned string.
+    /// @return Pointer to the entry, which is never freed.
+    const std::string* intern(const std::string& text){
+        if(text.empty()) return &emptySymbol();
+        // Nodes of the set are never moved, so pointers to the entries survive rehashing.
+        static std::unordered_set<std::string> table;
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock (mutex);
+        return &*table.insert(text).first;
+    }
+}
+
+// =====================================================================
+// Symbol
+// =====================================================================
+
+Symbol::Symbol() : text_(&emptySymbol()){}
+
+Symbol::Symbol(const std::string& text) : text_(intern(text)){}
+
+size_t Symbol::hash() const{
+    return std::hash<const std::string*>()(text_);
+}
+
+Symbol::operator const std::string&() const{
+    return *text_;
+}
+
+bool Symbol::operator==(const Symbol& other) const{
+    return text_ == other.text_;
+}
+
+bool Symbol::operator==(const std::string& text) const{
+    return *text_ == text;
+}
+
+const std::string& Symbol::str() const{
+    return *text_;
+}
+
+// =====================================================================
+// functions for Symbol
+// =====================================================================
+
+std::ostream& operator<<(std::ostream& os, const Symbol& symbol){
+    return os << symbol.str();
+}
@@ -0,0 +1,59 @@
+/// @file symbol.h Header file for strings interned in a table shared by the whole application.
+#ifndef symbol_h_
+#define symbol_h_
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+
+/// String stored only once in a table shared by the whole application, meant for values repeated across many records like places, roles and names of tags.
+/// A symbol is as small as a pointer and two symbols are equal exactly if they point to the same entry, so comparing them does not compare the text.
+/// Entries of the table are never freed, thus references to the text stay valid.
+class Symbol{
+    public:
+        /// Default constructor of an empty string.
+        Symbol();
+        /// Intern the string. It can be called from any thread.
+        /// @param text Interned string.
+        Symbol(const std::string& text);
+        /// Hash of the symbol.
+        /// @return Hash of the entry in the table.
+        size_t hash() const;
+        /// Get the text.
+        /// @return Constant reference to the interned string.
+        operator const std::string&() const;
+        /// Compare two symbols.
+        /// @param other The other symbol.
+        /// @return True if they have the same text.
+        bool operator==(const Symbol& other) const;
+        /// Compare the symbol with a string.
+        /// @param text Given string.
+        /// @return True if the symbol has the same text.
+        bool operator==(const std::string& text) const;
+        /// Get the text.
+        /// @return Constant reference to the interned string.
+        const std::string& str() const;
+    private:
+        /// Entry in the table.
+        const std::string* text_;
+};
+
+/// Write the text of the symbol to given stream.
+/// @param os Given stream.
+/// @param symbol Given symbol.
+/// @return Reference to the changed stream.
+std::ostream& operator<<(std::ostream& os, const Symbol& symbol);
+
+/// Hash of symbols for unordered containers.
+template<>
+struct std::hash<Symbol>{
+    /// Get the hash.
+    /// @param symbol Given symbol.
+    /// @return Hash of the symbol.
+    size_t operator()(const Symbol& symbol) const noexcept{
+        return symbol.hash();
+    }
+};
+
+#endif
@@ -0,0 +1,50 @@
+/// @file tag_index.cpp Source file for the index of tags of persons.
+#include "tag_index.h"
+#include <iterator>
+
+void TagIndex::add(const Person& person){
+    for(auto&& [tag, value] : person.getTags())
+        tags_[tag.str()][person.getId()] = value;
+}
+
+void TagIndex::build(const RecordMap<Person>& persons){
+    tags_.clear();
+    for(auto&& [id, person] : persons)
+        add(*person);
+}
+
+void TagIndex::clear(){
+    tags_.clear();
+}
+
+std::vector<size_t> TagIndex::find(const std::string& tag) const{
+    std::vector<size_t> result;
+    auto found = tags_.find(tag);
+    if(found == tags_.end()) return result;
+    result.reserve(found->second.size());
+    for(auto&& [person, value] : found->second)
+        result.push_back(person);
+    return result;
+}
+
+std::vector<size_t> TagIndex::find(const std::string& tag, const std::string& value) const{
+    std::vector<size_t> result;
+    auto found = tags_.find(tag);
+    if(found == tags_.end()) return result;
+    for(auto&& [person, personValue] : found->second)
+        if(personValue == value) result.push_back(person);
+    return result;
+}
+
+void TagIndex::remove(size_t person){
+    // Persons have only a few tags and the database a few dozens of them, so all tags are checked.
+    for(auto it = tags_.begin(); it != tags_.end();){
+        it->second.erase(person);
+        it = it->second.empty() ? tags_.erase(it) : std::next(it);
+    }
+}
+
+void TagIndex::update(const Person& person){
+    remove(person.getId());
+    add(person);
+}
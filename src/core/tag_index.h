@@ -0,0 +1,44 @@
+/// @file tag_index.h Header file for the index of tags of persons.
+#ifndef tag_index_h_
+#define tag_index_h_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "person.h"
+#include "record_map.h"
+
+/// Values of each tag by the persons with the tag.
+/// Unlike the full-text index of persons, it is kept up to date on every change of a person, so tags are found, renamed or removed without building any other index.
+class TagIndex{
+    public:
+        /// Index all persons, the old content is dropped.
+        /// @param persons Container of all persons.
+        void build(const RecordMap<Person>& persons);
+        /// Remove all persons from the index.
+        void clear();
+        /// Find persons with the tag.
+        /// @param tag Name of the tag.
+        /// @return Ids of the persons in ascending order.
+        std::vector<size_t> find(const std::string& tag) const;
+        /// Find persons with the tag of given value.
+        /// @param tag Name of the tag.
+        /// @param value Exact value of the tag.
+        /// @return Ids of the persons in ascending order.
+        std::vector<size_t> find(const std::string& tag, const std::string& value) const;
+        /// Remove the person from the index.
+        /// @param person Id of the removed person.
+        void remove(size_t person);
+        /// Index the current tags of the person instead of the old ones.
+        /// @param person Added or changed person.
+        void update(const Person& person);
+    private:
+        /// Values of each tag by the persons with the tag.
+        std::map<std::string, std::map<size_t, std::string>> tags_;
+        /// Add tags of the person, which is not in the index.
+        /// @param person Indexed person.
+        void add(const Person& person);
+};
+
+#endif
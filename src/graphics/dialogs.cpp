@@ -5,8 +5,8 @@
 // DateDialog
 // =====================================================================
 
-DateDialog::DateDialog(FamilyTree* FT, WrappedDate* date, QWidget* parent)
-  : QDialog(parent), date_(date), FT_(FT), ui(new Ui::DateDialog){
+DateDialog::DateDialog(FamilyTree* FT, WrappedDate* date, DatabaseFile file, size_t id, QWidget* parent)
+  : QDialog(parent), date_(date), file_(file), FT_(FT), id_(id), ui(new Ui::DateDialog){
 	ui->setupUi(this);
 	if(date_ == nullptr){
         reject();
@@ -52,7 +52,7 @@ void DateDialog::saveDate(){
         date_->setText() = ui->note->toPlainText().toStdString();
     }
 	date_->updateDate();
-	FT_->setUnsaved();
+	FT_->setUnsaved(file_, id_);
 	accept();
 }
 
@@ -148,7 +148,7 @@ void TagChooserDialog::saveTag(){
                     }
 				}
 				FT_->getMainPerson()->addTag(tag, value);
-				FT_->setUnsaved();
+				FT_->setUnsaved(DB_PERSONS, FT_->getMainPerson()->getId());
 				accept();
 			}
 		}
@@ -221,7 +221,7 @@ void AddFileDialog::createOrChooseFile(){
         QTreeWidgetItem* item = ui->fileList->currentItem();
         size_t id = item->data(0, Qt::DisplayRole).toULongLong();
         drive_->addFile(id);
-        FT_->setUnsaved();
+        FT_->setUnsaved(DB_PERSONS, FT_->getMainPerson() ? FT_->getMainPerson()->getId() : 0);
         accept();
     }
     else if (ui->tabWidget->currentIndex() == 1){ // copy file
@@ -233,7 +233,7 @@ void AddFileDialog::createOrChooseFile(){
         }
         else{
             drive_->addFile(id);
-            FT_->setUnsaved();
+            FT_->setUnsaved(DB_PERSONS, FT_->getMainPerson() ? FT_->getMainPerson()->getId() : 0);
             accept();
         }
     }
@@ -251,7 +251,7 @@ void AddFileDialog::createOrChooseFile(){
         }
         size_t id = FT_->createEmptyFile(name, type_);
         drive_->addFile(id);
-        FT_->setUnsaved();
+        FT_->setUnsaved(DB_PERSONS, FT_->getMainPerson() ? FT_->getMainPerson()->getId() : 0);
         accept();
     }
 }
@@ -297,7 +297,7 @@ RelationTemplateDialog::~RelationTemplateDialog(){
 void RelationTemplateDialog::addDefaults(){
     FT_->getSettings()->addDefaultRelations();
     refreshListWidget();
-    FT_->setUnsaved();
+    FT_->setUnsaved(DB_CONFIG);
 }
 
 void RelationTemplateDialog::addNewTemplate(){
@@ -357,7 +357,7 @@ void RelationTemplateDialog::removeTemplate(){
         clear();
         setEnabledWidgets(false);
     }
-    FT_->setUnsaved();
+    FT_->setUnsaved(DB_CONFIG);
 }
 
 void RelationTemplateDialog::saveTemplate(){
@@ -407,7 +407,7 @@ void RelationTemplateDialog::saveTemplate(RelationTemplate* rel){
     rel->setFirstName() = ui->firstNameEdit->text().toStdString();
     rel->setSecondName() = ui->secondNameEdit->text().toStdString();
     rel->setGenerationDifference(ui->generationDifference->value());
-    FT_->setUnsaved();
+    FT_->setUnsaved(DB_CONFIG);
 }
 
 void RelationTemplateDialog::setEnabledWidgets(bool enabled){
@@ -475,7 +475,7 @@ EventTamplatesDialog::~EventTamplatesDialog(){
 
 void EventTamplatesDialog::addDefaults(){
     FT_->getSettings()->addDefaultEvents();
-    FT_->setUnsaved();
+    FT_->setUnsaved(DB_CONFIG);
     refreshListWidget();
 }
 
@@ -554,7 +554,7 @@ void EventTamplatesDialog::removeTemplate(){
         clear();
         setEnabledWidgets(false);
     }
-    FT_->setUnsaved();
+    FT_->setUnsaved(DB_CONFIG);
 }
 
 void EventTamplatesDialog::saveTemplate(){
@@ -603,7 +603,7 @@ void EventTamplatesDialog::saveTemplate(EventTemplate* event){
         roles.push_back(item->text().toStdString());
     }
     event->setRoles(roles);
-    FT_->setUnsaved();
+    FT_->setUnsaved(DB_CONFIG);
     FT_->updateEventsWithTemplate(event->getId());
 }
 
@@ -691,12 +691,14 @@ RelationDialog::~RelationDialog(){
 
 void RelationDialog::chooseFirstPerson(){
     ChoosePersonDialog* chpd = new ChoosePersonDialog(FT_, person1_, this);
+    connect(chpd, SIGNAL(savePerson(Person*)), this, SLOT(savePerson(Person*)));
     saveFirstPerson_ = true;
     chpd->show();
 }
 
 void RelationDialog::chooseSecondPerson(){
     ChoosePersonDialog* chpd = new ChoosePersonDialog(FT_, person1_, this);
+    connect(chpd, SIGNAL(savePerson(Person*)), this, SLOT(savePerson(Person*)));
     saveFirstPerson_ = false;
     chpd->show();
 }
@@ -733,7 +735,7 @@ void RelationDialog::saveRelation(){
         newOne = true;
     }
     FT_->setRelation(rel_->getId(), person1_->getId(), person2_->getId(), tempId);
-    FT_->setUnsaved();
+    FT_->setUnsaved(DB_RELATIONS, rel_->getId());
     auto suggestions = FT_->getRelationSuggestions(rel_->getId());
     if(newOne && suggestions.size() > 0){
         SuggestionsDialog* sd = new SuggestionsDialog(FT_, suggestions);
@@ -813,16 +815,18 @@ void EventDialog::choosePerson(){
     auto optPerson = FT_->getPerson(eventItem->getId());
     if(!optPerson){
         ChoosePersonDialog* cpd = new ChoosePersonDialog(FT_, nullptr, this);
+        connect(cpd, SIGNAL(savePerson(Person*)), this, SLOT(savePerson(Person*)));
         cpd->show();
     }
     else{
         ChoosePersonDialog* cpd = new ChoosePersonDialog(FT_, *optPerson, this);
+        connect(cpd, SIGNAL(savePerson(Person*)), this, SLOT(savePerson(Person*)));
         cpd->show();
     }
 }
 
 void EventDialog::openCustomDate(){
-    DateDialog* dd = new DateDialog(FT_, &date_, this);
+    DateDialog* dd = new DateDialog(FT_, &date_, DB_EVENTS, event_ != nullptr ? event_->getId() : 0, this);
     dd->show();
 }
 
@@ -865,6 +869,8 @@ void EventDialog::saveEvent(){
         QMessageBox::critical(this, "Error", QString::fromStdString(error::FORBIDDEN_CHARS));
         return;
     }
+    std::vector<std::pair<Symbol, size_t>> originalPersons;
+    if(event_ != nullptr) originalPersons = event_->getPersons();
     if(event_ == nullptr){
         event_ = FT_->addEvent();
         if(!templ->hasRoles() && !templ->hasMorePeopleInvolved()){
@@ -876,7 +882,7 @@ void EventDialog::saveEvent(){
     if(templ->containsDate()){
         event_->setDate() = date_;
     }
-    event_->setTemplate(templId);
+    FT_->setEventTemplate(event_->getId(), templId);
 
     event_->setText(ui->textEdit->toPlainText().toStdString());
     if(templ->containsPlace())
@@ -919,7 +925,13 @@ void EventDialog::saveEvent(){
             return;
         }
     }
-    FT_->setUnsaved();
+    FT_->setUnsaved(DB_EVENTS, event_->getId());
+    if(originalPersons != event_->getPersons()){
+        for(auto&& [role, id] : originalPersons)
+            FT_->setUnsaved(DB_PERSONS, id);
+        for(auto&& [role, id] : event_->getPersons())
+            FT_->setUnsaved(DB_PERSONS, id);
+    }
     accept();
 }
 
@@ -1060,7 +1072,6 @@ ChoosePersonDialog::ChoosePersonDialog(FamilyTree* FT, Person* person, QWidget*
     connect(ui->findClear, SIGNAL(clicked()), this, SLOT(clearFilter()));
     connect(ui->buttonBox, SIGNAL(accepted()), this, SLOT(saveSelectedPerson()));
     connect(ui->treeWidget, SIGNAL(itemDoubleClicked(QTreeWidgetItem*, int)), this, SLOT(saveSelectedPerson()));
-    connect(this, SIGNAL(savePerson(Person*)), parent, SLOT(savePerson(Person*)));
 }
 
 ChoosePersonDialog::~ChoosePersonDialog(){
@@ -1074,11 +1085,25 @@ void ChoosePersonDialog::clearFilter(){
 }
 
 void ChoosePersonDialog::filterPersons(){
-    auto widgetList = ui->treeWidget->findItems(ui->findText->text(), Qt::MatchContains, 1);
-    for(int i = 0; i < ui->treeWidget->topLevelItemCount(); ++i)
-        ui->treeWidget->topLevelItem(i)->setHidden(true);
-    for(auto&& widget : widgetList)
-        widget->setHidden(false);
+    std::string query = ui->findText->text().toStdString();
+    std::vector<size_t> found = FT_->findPersons(query);
+    std::unordered_map<size_t, size_t> rank;
+    for(size_t i = 0; i < found.size(); ++i)
+        rank[found[i]] = i;
+    bool all = search::normalize(query).find_first_not_of(' ') == std::string::npos;
+    QTreeWidgetItem* best = nullptr;
+    size_t bestRank = found.size();
+    for(int i = 0; i < ui->treeWidget->topLevelItemCount(); ++i){
+        QTreeWidgetItem* item = ui->treeWidget->topLevelItem(i);
+        auto it = rank.find(item->data(0, Qt::DisplayRole).toULongLong());
+        item->setHidden(!all && it == rank.end());
+        if(it != rank.end() && it->second < bestRank){
+            best = item;
+            bestRank = it->second;
+        }
+    }
+    // The best match is selected, so it can be chosen right away.
+    if(best != nullptr) ui->treeWidget->setCurrentItem(best);
 }
 
 void ChoosePersonDialog::saveSelectedPerson(){
@@ -72,8 +72,10 @@ class DateDialog : public QDialog {
         /// Default constructor.
         /// @param FT Pointer to the family tree.
         /// @param date Pointer to the used date.
+        /// @param file Which file of the database holds the date.
+        /// @param id Id of the record holding the date.
         /// @param parent The Qt Widget parent.
-        explicit DateDialog(FamilyTree* FT, WrappedDate* date = nullptr, QWidget* parent = nullptr);
+        explicit DateDialog(FamilyTree* FT, WrappedDate* date = nullptr, DatabaseFile file = DB_PERSONS, size_t id = 0, QWidget* parent = nullptr);
         /// Default destructor.
         ~DateDialog();
     public slots:
@@ -85,8 +87,12 @@ class DateDialog : public QDialog {
     private:
         /// Pointer to the used date.
         WrappedDate* date_;
+        /// File of the database which holds the date.
+        DatabaseFile file_;
         /// Pointer to the family tree.
         FamilyTree* FT_;
+        /// Id of the record holding the date.
+        size_t id_;
         /// User interface of the Qt framework.
         Ui::DateDialog *ui;
 };
@@ -240,7 +246,7 @@ class EventTamplatesDialog : public QDialog{
         Ui::EventTamplatesDialog* ui;
 };
 
-/// Dialog for choosing person with find window. Parent have to have slot `savePerson()`.
+/// Dialog for choosing person with find window. The one who opens it connects signal `savePerson()` to its slot.
 class ChoosePersonDialog : public QDialog{
     Q_OBJECT
     public:
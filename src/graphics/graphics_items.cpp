@@ -66,7 +66,7 @@ void FileTreeItem::addSubDrive(const QString& folder){
             break;
     }
     addChild(new FileTreeItem(subdrive, FT_, icon, type_));
-    FT_->setUnsaved();
+    FT_->setUnsaved(DB_PERSONS, FT_->getMainPerson() ? FT_->getMainPerson()->getId() : 0);
 }
 
 VirtualDrive* FileTreeItem::getDrive(){
@@ -124,10 +124,33 @@ size_t ProjectItem::getId() const{
     return id_;
 }
 
+void ProjectItem::setDates(const Person& person){
+    setText(2, QString::fromStdString(person.getBirthDate().str()));
+    setData(2, Qt::UserRole, QVariant::fromValue(person.getBirthDate().key()));
+    if(person.isAlive()){
+        setText(3, "");
+        setData(3, Qt::UserRole, QVariant::fromValue(0u));
+    }
+    else{
+        setText(3, QString::fromStdString(person.getDeathDate().str()));
+        setData(3, Qt::UserRole, QVariant::fromValue(person.getDeathDate().key()));
+    }
+}
+
 ProjectItemType ProjectItem::type() const{
     return type_;
 }
 
+bool ProjectItem::operator<(const QTreeWidgetItem& other) const{
+    // Dates are shown as day, month and year, so their texts do not sort chronologically.
+    int column = treeWidget() != nullptr ? treeWidget()->sortColumn() : 0;
+    QVariant key = data(column, Qt::UserRole);
+    QVariant otherKey = other.data(column, Qt::UserRole);
+    if(key.isValid() && otherKey.isValid())
+        return key.toUInt() < otherKey.toUInt();
+    return QTreeWidgetItem::operator<(other);
+}
+
 // =====================================================================
 // EventRoleItem
 // =====================================================================
@@ -151,8 +174,8 @@ void EventRoleItem::setPerson(const QString& name, size_t id){
 
 PersonsGraphicsItem::PersonsGraphicsItem(const QStringList& lines, int sizex, int sizey, Person* p, qreal x, qreal y,
                                          QColor color, QColor highlighted, QFont font, QWidget* parent, QPen* pen, QPen* textPen, int borderRadius)
-  : borderRadius_(borderRadius), color_(color), font_(font), highlighted_(highlighted), hovered_(false), pen_(pen),
-  person_(p), sizex_(sizex), sizey_(sizey), textLines_(lines), textPen_(textPen), x_(x), y_(y){
+  : borderRadius_(borderRadius), color_(color), font_(font), highlighted_(highlighted), hovered_(false), marked_(false),
+  pen_(pen), person_(p), sizex_(sizex), sizey_(sizey), textLines_(lines), textPen_(textPen), x_(x), y_(y){
     setPos(x_, y_);
     setAcceptHoverEvents(true);
     bold_text_ = lines.length();
@@ -171,6 +194,10 @@ QRectF PersonsGraphicsItem::boundingRect() const{
     return QRectF(0, 0, sizex_, sizey_);
 }
 
+size_t PersonsGraphicsItem::getPersonId() const{
+    return person_ != nullptr ? person_->getId() : 0;
+}
+
 void PersonsGraphicsItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget){
     Q_UNUSED(option);
     Q_UNUSED(widget);
@@ -178,7 +205,7 @@ void PersonsGraphicsItem::paint(QPainter* painter, const QStyleOptionGraphicsIte
     QRectF rect = boundingRect();
     painter->setPen(*pen_);
     QBrush brush;
-    if (hovered_) brush = QBrush(highlighted_);
+    if (hovered_ || marked_) brush = QBrush(highlighted_);
     else brush = QBrush(color_);
     painter->setBrush(brush);
     painter->drawRoundedRect(rect, borderRadius_, borderRadius_);
@@ -208,6 +235,11 @@ void PersonsGraphicsItem::mousePressEvent(QGraphicsSceneMouseEvent* event){
     QCoreApplication::processEvents();
 }
 
+void PersonsGraphicsItem::setMarked(bool marked){
+    marked_ = marked;
+    update(boundingRect());
+}
+
 QPainterPath PersonsGraphicsItem::shape() const{
     QPainterPath path;
     path.addRoundedRect(boundingRect(), 10, 10);
@@ -82,9 +82,16 @@ class ProjectItem : public QTreeWidgetItem{
         /// Get the id of the object.
         /// @return Id of the object.
         size_t getId() const;
+        /// Show the birth and death date of the person and keep their keys for sorting.
+        /// @param person Shown person.
+        void setDates(const Person& person);
         /// Get the type of the item.
         /// @return Type of the project.
         ProjectItemType type() const;
+        /// Compare the items by the sorted column, dates chronologically by their keys.
+        /// @param other Compared item.
+        /// @return True if this item goes before the other one.
+        bool operator<(const QTreeWidgetItem& other) const override;
     private:
         /// Id of the stored object.
         size_t id_;
@@ -136,11 +143,17 @@ class PersonsGraphicsItem : public QObject, public QGraphicsItem{
         /// Get the bounding rectangle of the object.
         /// @return Rectangle that is bounding the item.
         QRectF boundingRect() const override;
+        /// Get the id of the represented person.
+        /// @return Id of the person, 0 if the box represents nobody.
+        size_t getPersonId() const;
         /// Paint the object to its painter.
         /// @param painter Which painter to use to paint the object.
         /// @param option Option for the Qt framework (not used).
         /// @param widget Widget for the Qt framework (not used).
         void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+        /// Mark the box, it is then highlighted as when it is hovered.
+        /// @param marked If the box is marked.
+        void setMarked(bool marked);
         /// Get the shape of the item.
         /// @return Get the shape to paint.
         QPainterPath shape() const override;
@@ -170,6 +183,8 @@ class PersonsGraphicsItem : public QObject, public QGraphicsItem{
         QColor highlighted_;
         /// If the box is hovered.
         bool hovered_;
+        /// If the box is marked, for example on a found connection.
+        bool marked_;
         /// Pointer to the used pen.
         QPen* pen_;
         /// Given person represented in this box.
@@ -2,7 +2,7 @@
 #include "mainwindow.h"
 
 MainWindow::MainWindow(QWidget *parent)
-  : QMainWindow(parent), scene(new QGraphicsScene()), treeScene(new QGraphicsScene()), treeView(new GraphicsView(treeScene, this)), ui(new Ui::MainWindow){
+  : QMainWindow(parent), scene(new QGraphicsScene()), suggestionPage_(0), treeScene(new QGraphicsScene()), treeView(new GraphicsView(treeScene, this)), ui(new Ui::MainWindow){
 	ui->setupUi(this);
     for(auto&& root : FT.getProjectPaths()){
         QAction* action = ui->menuRecent_trees->addAction(QString::fromStdString(root));
@@ -18,9 +18,13 @@ MainWindow::MainWindow(QWidget *parent)
     ui->treeViewLayout->addWidget(treeView);
     refreshUi();
     connectAllSlots();
+    autosaveTimer_ = new QTimer(this);
+    connect(autosaveTimer_, SIGNAL(timeout()), this, SLOT(autosave()));
+    autosaveTimer_->start(AUTOSAVE_INTERVAL);
 }
 
 MainWindow::~MainWindow(){
+    FT.finishSave();
 	delete ui;
 	delete scene;
 	delete treeScene;
@@ -82,13 +86,14 @@ void MainWindow::addGeneralFolder(FileType type){
 }
 
 void MainWindow::closeEvent(QCloseEvent *event){
+    finishSaving();
     if(!FT.isSaved()){
         QMessageBox::StandardButton result;
         std::stringstream ss;
         ss << "There are some changes that are not saved. Do you want to save them?";
         result = QMessageBox::warning(this, "Warning", QString::fromStdString(ss.str()), QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
         if (result == QMessageBox::Save){
-            bool saved = saveDatabase();
+            bool saved = saveDatabase() && finishSaving();
             if(!saved){
                 event->ignore();
                 return;
@@ -103,6 +108,8 @@ void MainWindow::closeEvent(QCloseEvent *event){
 }
 
 void MainWindow::clearUi(){
+    connection_.clear();
+    suggestionPages_.clear();
     ui->projectView->clear();
     ui->eventWidget->clear();
     scene->clear();
@@ -145,6 +152,7 @@ void MainWindow::connectAllSlots(){
 	connect(ui->actionEast, SIGNAL(triggered()), this, SLOT(setTabEast()));
 	connect(ui->actionWest, SIGNAL(triggered()), this, SLOT(setTabWest()));
 	connect(ui->actionGraphics_settings, SIGNAL(triggered()), this, SLOT(openGraphicSettings()));
+	connect(ui->actionDeduplicate_files, SIGNAL(triggered()), this, SLOT(setFileDeduplication()));
 	// Menu
     connect(ui->actionOpen, SIGNAL(triggered()), this, SLOT(openNewFamilyTreeProject()));
     connect(ui->actionNew, SIGNAL(triggered()), this, SLOT(switchNewTreeProject()));
@@ -193,6 +201,10 @@ void MainWindow::connectAllSlots(){
 	connect(ui->okFolderNoteRename, SIGNAL(clicked()), this, SLOT(renameNote()));
 	// Project view
 	connect(ui->actionFind, SIGNAL(triggered()), this, SLOT(findPerson()));
+	connect(ui->actionFind_connection, SIGNAL(triggered()), this, SLOT(findConnection()));
+	connect(ui->actionFind_duplicates, SIGNAL(triggered()), this, SLOT(findDuplicates()));
+	connect(ui->actionSuggest_relations, SIGNAL(triggered()), this, SLOT(suggestRelations()));
+	connect(ui->actionValidate_database, SIGNAL(triggered()), this, SLOT(checkDatabase()));
 	connect(ui->findEdit, SIGNAL(returnPressed()), this, SLOT(filterProjectItems()));
 	connect(ui->findProjectView, SIGNAL(clicked()), this, SLOT(filterProjectItems()));
 	connect(ui->clearProjectFilter, SIGNAL(clicked()), this, SLOT(clearProjectFilter()));
@@ -261,7 +273,7 @@ void MainWindow::connectAllSlots(){
 }
 
 
-void MainWindow::drawCloseContainer(const std::vector<Relation*>& container,
+void MainWindow::drawCloseContainer(const std::vector<Kinship>& container,
                                     qreal sizeX, qreal sizeY, qreal topLeftX, qreal topLeftY,
                                     qreal lineX1, qreal lineY1, qreal lineX2, qreal lineY2,
                                     size_t partner, size_t mother, size_t father, int gap,
@@ -275,16 +287,16 @@ void MainWindow::drawCloseContainer(const std::vector<Relation*>& container,
         scene->addItem(sameRels);
         int index = 0;
         QColor color;
-        for(auto&& rel : container){
-            if(rel->getId() == partner || rel->getId() == father || rel->getId() == mother) color = promotedColor_;
+        for(auto&& relative : container){
+            if(relative.relation == partner || relative.relation == father || relative.relation == mother) color = promotedColor_;
             else color = standardColor_;
             QStringList lines;
-            auto optPerson = FT.getPerson(rel->getTheOtherPerson(FT.getMainPerson()->getId()));
+            auto optPerson = FT.getPerson(relative.person);
             if(!optPerson){
                 continue;
             }
             Person* current = *optPerson;
-            lines << QString::fromStdString(rel->getTheOtherPersonName(FT.getMainPerson()->getId()));
+            lines << QString::fromStdString(*relative.name);
             qreal itemTopLeftX = topLeftX + ((sizeX_ + gap) * index * movex) + gap;
             qreal itemTopLeftY = topLeftY + ((sizeY_ + gap) * index * movey) + gap;
             PersonsGraphicsItem* person = new PersonsGraphicsItem(lines, sizeX_, sizeY_, current, itemTopLeftX, itemTopLeftY, color, highlightedColor_, font_,
@@ -300,25 +312,21 @@ void MainWindow::drawCloseFamily(){
     if(FT.getMainPerson() == nullptr) return;
     Person* main = FT.getMainPerson();
     QStringList textLines;
-    std::vector<Relation*> same;
-    std::vector<Relation*> younger;
-    std::vector<Relation*> older;
+    std::vector<Kinship> same;
+    std::vector<Kinship> younger;
+    std::vector<Kinship> older;
     size_t father = main->getFather();
     size_t mother = main->getMother();
     size_t partner = main->getPartner();
-    for(auto&& relId : main->getRelations()){
-        auto optRel = FT.getRelation(relId);
-        if(optRel){
-            Relation* rel = *optRel;
-            if(rel->isSameGenration()){
-                same.push_back(rel);
-            }
-            else if(rel->isYoungerGeneration(main->getId())){
-                older.push_back(rel);
-            }
-            else{
-                younger.push_back(rel);
-            }
+    for(auto&& relative : FT.getKinship().getRelatives(main->getId())){
+        if(relative.generations == 0){
+            same.push_back(relative);
+        }
+        else if(relative.generations > 0){
+            older.push_back(relative);
+        }
+        else{
+            younger.push_back(relative);
         }
     }
     int gap = 10;
@@ -368,68 +376,57 @@ void MainWindow::drawCloseFamily(){
         drawCloseContainer(younger, sizeX, sizeY, topLeftX, topLeftY, lineX1, lineY1, lineX2, lineY2, partner, mother, father, gap, true, false);
     }
     scene->addItem(person);
+    markConnection(scene);
     auto rect = scene->itemsBoundingRect();
     rect.adjust(-gap, -gap, gap, gap);
     scene->setSceneRect(rect);
 }
 
 void MainWindow::drawGeneralGenerations(Person* p, qreal size, qreal midx, qreal midy, int horizontalGap, int verticalGap, size_t barrier,
-                                        const std::vector<size_t>& container, bool up,
+                                        std::span<const Kinship> relatives, bool up,
                                         std::function<std::pair<size_t, size_t>(Person*, size_t, size_t)> numberFunc,
                                         std::function<void(Person*, qreal, qreal, qreal, int, int, size_t)> drawFunc){
+    if(barrier == 0) return;
     std::vector<size_t> widths;
     size_t total = 0;
-    for(auto&& relId : container){
-        auto optRel = FT.getRelation(relId);
-        if(!optRel || barrier == 0) continue;
-        Relation* r = (*optRel);
-        if(r->isParent(p->getId()) || up){
-            auto optPerson = FT.getPerson(r->getTheOtherPerson(p->getId()));
-            if(optPerson){
-                auto [width, depth] = numberFunc(*optPerson, 0, barrier - 1);
-                widths.push_back(width);
-                total += width;
-            }
+    for(auto&& relative : relatives){
+        auto optPerson = FT.getPerson(relative.person);
+        if(optPerson){
+            auto [width, depth] = numberFunc(*optPerson, 0, barrier - 1);
+            widths.push_back(width);
+            total += width;
         }
     }
     size_t index = 0;
     qreal posx = midx - size / 2;
-    for(auto&& relId : container){
-        auto optRel = FT.getRelation(relId);
-        if(!optRel || barrier == 0) continue;
-        Relation* r = (*optRel);
-        if(r->isParent(p->getId()) || up){
-            auto optPerson = FT.getPerson(r->getTheOtherPerson(p->getId()));
-            if(optPerson){
-                double div = (double) widths[index]/total;
-                qreal currentSize = div * size;
-                qreal currentMidX = posx + currentSize / 2;
-                qreal currentTopX = currentMidX - sizeX_ / 2;
-                qreal currentTopY = up ? midy - sizeY_ - verticalGap : midy + sizeY_ + verticalGap;
-                drawFunc(*optPerson, currentSize, currentMidX, currentTopY, horizontalGap, verticalGap, barrier - 1);
-                QGraphicsLineItem* lineItem = new QGraphicsLineItem();
-                lineItem->setPen(linePen_);
-                qreal lineY1 = up ? midy - verticalGap : currentTopY;
-                qreal lineY2 = up ? midy : midy + sizeY_;
-                lineItem->setLine(currentTopX + sizeX_ / 2, lineY1, midx, lineY2);
-                treeScene->addItem(lineItem);
-                QStringList lines;
-                lines << QString::fromStdString(r->getTheOtherPersonName(p->getId()));
-                PersonsGraphicsItem* item = new PersonsGraphicsItem(lines, sizeX_, sizeY_, (*optPerson), currentTopX, currentTopY, standardColor_, highlightedColor_, font_, this,
-                                                                    &linePen_, & textPen_, borderRadius_);
-                ++index;
-                posx += currentSize;
-                treeScene->addItem(item);
-            }
+    for(auto&& relative : relatives){
+        auto optPerson = FT.getPerson(relative.person);
+        if(optPerson){
+            double div = (double) widths[index]/total;
+            qreal currentSize = div * size;
+            qreal currentMidX = posx + currentSize / 2;
+            qreal currentTopX = currentMidX - sizeX_ / 2;
+            qreal currentTopY = up ? midy - sizeY_ - verticalGap : midy + sizeY_ + verticalGap;
+            drawFunc(*optPerson, currentSize, currentMidX, currentTopY, horizontalGap, verticalGap, barrier - 1);
+            QGraphicsLineItem* lineItem = new QGraphicsLineItem();
+            lineItem->setPen(linePen_);
+            qreal lineY1 = up ? midy - verticalGap : currentTopY;
+            qreal lineY2 = up ? midy : midy + sizeY_;
+            lineItem->setLine(currentTopX + sizeX_ / 2, lineY1, midx, lineY2);
+            treeScene->addItem(lineItem);
+            QStringList lines;
+            lines << QString::fromStdString(*relative.name);
+            PersonsGraphicsItem* item = new PersonsGraphicsItem(lines, sizeX_, sizeY_, (*optPerson), currentTopX, currentTopY, standardColor_, highlightedColor_, font_, this,
+                                                                &linePen_, & textPen_, borderRadius_);
+            ++index;
+            posx += currentSize;
+            treeScene->addItem(item);
         }
     }
 }
 
 void MainWindow::drawOlderGenerations(Person* p, qreal size, qreal midx, qreal midy, int horizontalGap, int verticalGap, size_t barrier){
-    std::vector<size_t> cont;
-    if(p->getFather() != 0) cont.push_back(p->getFather());
-    if(p->getMother() != 0) cont.push_back(p->getMother());
-    drawGeneralGenerations(p, size, midx, midy, horizontalGap, verticalGap, barrier, cont, true,
+    drawGeneralGenerations(p, size, midx, midy, horizontalGap, verticalGap, barrier, drawnParents(p), true,
         [this](Person* p, size_t soFar, size_t barrier){
                            return this->olderGenerationNumber(p, soFar, barrier);
                            },
@@ -439,7 +436,7 @@ void MainWindow::drawOlderGenerations(Person* p, qreal size, qreal midx, qreal m
 }
 
 void MainWindow::drawYoungerGenerations(Person* p, qreal size, qreal midx, qreal midy, int horizontalGap, int verticalGap, size_t barrier){
-    drawGeneralGenerations(p, size, midx, midy, horizontalGap, verticalGap, barrier, p->getRelations(), false,
+    drawGeneralGenerations(p, size, midx, midy, horizontalGap, verticalGap, barrier, FT.getKinship().getRelatives(p->getId(), KIN_CHILD), false,
         [this](Person* p, size_t soFar, size_t barrier){
                            return this->youngerGenerationNumber(p, soFar, barrier);
                            },
@@ -448,6 +445,17 @@ void MainWindow::drawYoungerGenerations(Person* p, qreal size, qreal midx, qreal
             });
 }
 
+std::vector<Kinship> MainWindow::drawnParents(Person* p){
+    std::vector<Kinship> parents;
+    const KinshipGraph& kinship = FT.getKinship();
+    for(size_t relId : {p->getFather(), p->getMother()}){
+        if(relId == 0) continue;
+        auto optRelative = kinship.getRelative(p->getId(), relId);
+        if(optRelative) parents.push_back(**optRelative);
+    }
+    return parents;
+}
+
 void MainWindow::drawPartner(qreal canvasMidX, qreal canvasMidY, int horizontalGap){
     if(FT.getMainPerson()->getPartner() != 0){
         auto optRel = FT.getRelation(FT.getMainPerson()->getPartner());
@@ -499,6 +507,7 @@ void MainWindow::drawFamilyTree(){
     PersonsGraphicsItem* item = new PersonsGraphicsItem(lines, sizeX_, sizeY_, FT.getMainPerson(), canvasMidX - sizeX_ / 2, canvasMidY, probandColor_, highlightedColor_, font_,
                                                         this, &linePen_, &textPen_, borderRadius_);
     treeScene->addItem(item);
+    markConnection(treeScene);
 
     QRectF rect = treeScene->itemsBoundingRect();
     rect.adjust(- 2*horizontalGap, - 2*verticalGap, 2*horizontalGap, 2*verticalGap);
@@ -613,22 +622,26 @@ bool MainWindow::exportTreeDiagram(double scale, const std::string& filename){
     return exportGeneralDiagram(filepath, treeScene, scale);
 }
 
+bool MainWindow::finishSaving(){
+    if(!FT.isSaving()) return true;
+    bool success = FT.finishSave();
+    if(!success)
+        QMessageBox::critical(this, "Error", "The database could not be saved. The changes are kept and will be stored by the next save.");
+    return success;
+}
+
 std::pair<size_t, size_t> MainWindow::generalGenerationNumber(Person* p, size_t soFar, size_t barrier,
-                                                              const std::vector<size_t>& container, bool up,
+                                                              std::span<const Kinship> relatives,
                                                               std::function<std::pair<size_t, size_t>(Person*, size_t, size_t)> func){
     size_t totalWidth = 0;
     size_t totalDepth = soFar;
-    for(auto&& relId : container){
-        auto optRel = FT.getRelation(relId);
-        if(!optRel || barrier == 0) continue;
-        Relation* r = (*optRel);
-        if(r->isParent(p->getId()) || up){
-            auto optPerson = FT.getPerson(r->getTheOtherPerson(p->getId()));
-            if(optPerson){
-                auto [width, depth] = func(*optPerson, soFar + 1, barrier - 1);
-                totalWidth += width;
-                totalDepth = depth > totalDepth ? depth : totalDepth;
-            }
+    for(auto&& relative : relatives){
+        if(barrier == 0) break;
+        auto optPerson = FT.getPerson(relative.person);
+        if(optPerson){
+            auto [width, depth] = func(*optPerson, soFar + 1, barrier - 1);
+            totalWidth += width;
+            totalDepth = depth > totalDepth ? depth : totalDepth;
         }
     }
     if(totalWidth == 0) totalWidth = 1;
@@ -653,8 +666,7 @@ void MainWindow::initializeProjectView(){
                 item->setIcon(0, QIcon(":/resources/other.svg"));
                 break;
         }
-        item->setText(2, QString::fromStdString(person->birthDate()->str()));
-        if(!person->isAlive()) item->setText(3, QString::fromStdString(person->deathDate()->str()));
+        item->setDates(*person);
         ui->projectView->addTopLevelItem(item);
         initializeProjectSubView(item, person.get());
     }
@@ -706,6 +718,7 @@ void MainWindow::loadSettings(){
     ui->actionShow_Notes->setChecked(FT.getSettings()->getAppSettings().showNoteTab);
     ui->actionShow_Media->setChecked(FT.getSettings()->getAppSettings().showMediaTab);
     ui->actionShow_Files->setChecked(FT.getSettings()->getAppSettings().showFileTab);
+    ui->actionDeduplicate_files->setChecked(FT.getSettings()->getAppSettings().deduplicateFiles);
     setGeneralTabVisible();
     setRelationTabVisible();
     setEventTabVisible();
@@ -748,16 +761,22 @@ void MainWindow::loadSettings(){
 }
 
 std::pair<size_t, size_t> MainWindow::olderGenerationNumber(Person* p, int soFar, size_t barrier){
-    std::vector<size_t> cont;
-    if(p->getFather() != 0) cont.push_back(p->getFather());
-    if(p->getMother() != 0) cont.push_back(p->getMother());
-    return generalGenerationNumber(p, soFar, barrier, cont, true, [this](Person* p, size_t soFar, size_t barrier){
+    return generalGenerationNumber(p, soFar, barrier, drawnParents(p), [this](Person* p, size_t soFar, size_t barrier){
                                    return this->olderGenerationNumber(p, soFar, barrier);
                                    });
 }
 
+void MainWindow::markConnection(QGraphicsScene* gscene){
+    if(connection_.empty()) return;
+    for(QGraphicsItem* item : gscene->items()){
+        auto personItem = dynamic_cast<PersonsGraphicsItem*>(item);
+        if(personItem != nullptr && connection_.contains(personItem->getPersonId()))
+            personItem->setMarked(true);
+    }
+}
+
 void MainWindow::openCustomDateDialog(WrappedDate* date){
-	DateDialog* dateDialog = new DateDialog(&FT, date, this);
+	DateDialog* dateDialog = new DateDialog(&FT, date, DB_PERSONS, FT.getMainPerson() != nullptr ? FT.getMainPerson()->getId() : 0, this);
 	dateDialog->show();
 }
 
@@ -783,13 +802,14 @@ void MainWindow::openGeneralFile(QTreeWidgetItem* item, FileType type){
 }
 
 void MainWindow::openGeneralProject(const std::string& dirPath){
+    finishSaving();
     if(!FT.isSaved()){
         QMessageBox::StandardButton result;
         std::stringstream ss;
         ss << "There are some changes that are not saved. Do you want to save them?";
         result = QMessageBox::warning(this, "Warning", QString::fromStdString(ss.str()), QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
         if (result == QMessageBox::Save){
-            bool saved = saveDatabase();
+            bool saved = saveDatabase() && finishSaving();
             if(!saved) return;
         }
         else if (result == QMessageBox::Cancel)
@@ -1008,7 +1028,7 @@ void MainWindow::removeGeneralFolder(FileType type){
         bool removeCurrent = fileItem->removeFolder();
         if(removeCurrent) delete fileItem;
     }
-    FT.setUnsaved();
+    FT.setUnsaved(DB_PERSONS, FT.getMainPerson()->getId());
     refreshProjectView();
 }
 
@@ -1053,7 +1073,7 @@ void MainWindow::renameGeneralFileItem(FileType type){
     }
     enableGeneralFolderPrompt(false, type);
     refreshTabsWithFiles();
-    FT.setUnsaved();
+    FT.setUnsaved(DB_PERSONS, FT.getMainPerson()->getId());
 }
 
 std::pair<int, int> MainWindow::setNumberOfGenerations(int up, int down){
@@ -1070,39 +1090,39 @@ void MainWindow::savePersonsInfo(){
     Person* main = FT.getMainPerson();
     if(main->getFrontTitle() != ui->titleEditF->text().toStdString()){
         main->setFrontTitle(ui->titleEditF->text().toStdString());
-        FT.setUnsaved();
+        FT.setUnsaved(DB_PERSONS, main->getId());
     }
     if(main->getAfterTitle() != ui->titleEditA->text().toStdString()){
         main->setAfterTitle(ui->titleEditA->text().toStdString());
-        FT.setUnsaved();
+        FT.setUnsaved(DB_PERSONS, main->getId());
     }
     if(main->getName() != ui->nameEdit->text().toStdString()){
         main->setName() = ui->nameEdit->text().toStdString();
-        FT.setUnsaved();
+        FT.setUnsaved(DB_PERSONS, main->getId());
     }
     if(main->getSurname() != ui->surnameEdit->text().toStdString()){
         main->setSurname() = ui->surnameEdit->text().toStdString();
-        FT.setUnsaved();
+        FT.setUnsaved(DB_PERSONS, main->getId());
     }
     if(main->getMaidenName() != ui->maidenNameEdit->text().toStdString()){
         main->setMaidenName() = ui->maidenNameEdit->text().toStdString();
-        FT.setUnsaved();
+        FT.setUnsaved(DB_PERSONS, main->getId());
     }
     if(main->getGender() != Gender(ui->genderEdit->currentIndex())){
         main->setGender(Gender(ui->genderEdit->currentIndex()));
-        FT.setUnsaved();
+        FT.setUnsaved(DB_PERSONS, main->getId());
     }
     if(main->getBirthPlace() != ui->placeOfBirthEdit->text().toStdString()){
-        main->setBirthPlace() = ui->placeOfBirthEdit->text().toStdString();
-        FT.setUnsaved();
+        main->setBirthPlace(ui->placeOfBirthEdit->text().toStdString());
+        FT.setUnsaved(DB_PERSONS, main->getId());
     }
     if(main->isAlive() != ui->isAlive->isChecked()){
         main->setLives(ui->isAlive->isChecked());
-        FT.setUnsaved();
+        FT.setUnsaved(DB_PERSONS, main->getId());
     }
     if(!main->isAlive() && main->getDeathPlace() != ui->placeOfDeathEdit->text().toStdString()){
-        main->setDeathPlace() = ui->placeOfDeathEdit->text().toStdString();
-        FT.setUnsaved();
+        main->setDeathPlace(ui->placeOfDeathEdit->text().toStdString());
+        FT.setUnsaved(DB_PERSONS, main->getId());
     }
 }
 
@@ -1116,6 +1136,8 @@ void MainWindow::setUiElements(){
     QStringList personHeader;
     personHeader << "ID" << "Name" << "Birth date" << "Death date";
     ui->projectView->setHeaderLabels(personHeader);
+    ui->projectView->sortByColumn(0, Qt::AscendingOrder);
+    ui->projectView->setSortingEnabled(true);
     QStringList relationHeader;
     relationHeader << "Relation" << "Other person";
     ui->olderGenerationWidget->setHeaderLabels(relationHeader);
@@ -1144,8 +1166,28 @@ void MainWindow::showGeneralFiles(QTreeWidget* widget, VirtualDrive* root, FileT
     widget->expandAll();
 }
 
+bool MainWindow::validateDatabase(){
+    ValidationReport report = FT.validateDatabase();
+    if(report.issues.empty() && report.cycles.empty()) return false;
+    // Damaged databases may have thousands of inconsistencies, so the dialog only counts them.
+    FT.log(validation::describe(report), LOG_WARNING);
+    std::string text = validation::summarize(report);
+    bool repairable = std::any_of(report.issues.begin(), report.issues.end(), [](const ValidationIssue& issue){
+        return issue.kind != INVALID_RELATION_TEMPLATE && issue.kind != INVALID_EVENT_TEMPLATE;
+    });
+    if(!repairable){
+        QMessageBox::warning(this, "Warning", QString::fromStdString(text), QMessageBox::Ok);
+        return true;
+    }
+    auto result = QMessageBox::warning(this, "Warning", QString::fromStdString(text + "\n" + validation::REPAIR_QUESTION), QMessageBox::Yes | QMessageBox::No);
+    if(result != QMessageBox::Yes) return true;
+    report = FT.validateDatabase(true);
+    FT.log(validation::describe(report), LOG_WARNING);
+    return true;
+}
+
 std::pair<size_t, size_t> MainWindow::youngerGenerationNumber(Person* p, size_t soFar, size_t barrier){
-    return generalGenerationNumber(p, soFar, barrier, p->getRelations(), false, [this](Person* p, size_t soFar, size_t barrier){
+    return generalGenerationNumber(p, soFar, barrier, FT.getKinship().getRelatives(p->getId(), KIN_CHILD), [this](Person* p, size_t soFar, size_t barrier){
                                    return this->youngerGenerationNumber(p, soFar, barrier);
                                    });
 }
@@ -6,6 +6,7 @@
 #include <QtWidgets>
 #include <string>
 #include <cstdlib>
+#include <unordered_set>
 
 #include "ui_mainwindow.h"
 
@@ -74,12 +75,16 @@ public slots:
     /// Set to show all generations below.
 	/// @param selected If all generations should be shown.
 	void allBelowGenerations(bool selected);
+	/// Store unsaved changes in the background. Nothing is saved if some files would be deleted, because it needs a confirmation.
+	void autosave();
 	/// Change the number of shown relations below.
 	/// @param value How many generations to show.
 	void changeGenerationsDown(int value);
 	/// Change the number of shown relations above.
 	/// @param value How many generations to show.
 	void changeGenerationsUp(int value);
+	/// Validate references in the database on demand and tell the user if there is no inconsistency.
+	void checkDatabase();
 	/// If any value in persons info tab was changed, check its value, store it and refresh ui elements.
 	void checkStoreRefreshPersonsInfo();
 	/// Clear the project filter.
@@ -121,6 +126,10 @@ public slots:
 	void exportTreeDiagramDialog();
 	/// Filter only matching items in project.
 	void filterProjectItems();
+	/// Choose a person to find the shortest chain of relations from the main person.
+	void findConnection();
+	/// Find persons recorded more times and merge the ones the user confirms.
+	void findDuplicates();
 	/// Focus find in project view.
 	void findPerson();
 	/// Fit the tree view inside.
@@ -195,8 +204,8 @@ public slots:
 	void renameMedia();
 	/// Rename note or folder with notes.
 	void renameNote();
-	/// Save the database.
-	/// @return If the database was stored.
+	/// Save the database. The data are written in the background, see finishSaving.
+	/// @return If the save was started.
 	bool saveDatabase();
 	/// Save graphics settings from its dialog.
     /// @param probandColor Color used for proband.
@@ -223,6 +232,8 @@ public slots:
 	void setEnabledDeathAtributes(bool disabled);
 	/// Hide or show the event tab.
 	void setEventTabVisible();
+	/// Turn on or off storing files with the same content only once.
+	void setFileDeduplication();
 	/// Hide or show the file tab.
 	void setFileTabVisible();
 	/// Hide or show the general tab.
@@ -244,6 +255,9 @@ public slots:
 	void setTabSouth();
 	/// Set the setting of the tab to west.
 	void setTabWest();
+	/// Find and highlight the connection between the main person and the chosen one.
+	/// @param person Person chosen in the dialog.
+	void showConnection(Person* person);
     /// Show generic help.
     void showHelp();
 	/// Show prompt for renaming file.
@@ -252,8 +266,12 @@ public slots:
 	void showRenameMedia();
 	/// Show prompt for renaming note.
 	void showRenameNote();
+	/// Show the next page of the relations inferred in the whole tree, the pages end once the user cancels one.
+	void showSuggestionPage();
 	/// When the splitter changed.
 	void splitterChanged();
+	/// Infer relations missing in the whole tree and let the user add them page by page.
+	void suggestRelations();
 	/// Save tree and create new empty tree to show.
 	void switchNewTreeProject();
 	/// Zoom in on the family tree view.
@@ -273,10 +291,16 @@ private:
 	/// Add folder to its type tree widget.
 	/// @param type What widget it should use.
 	void addGeneralFolder(FileType type);
+	/// Interval of the automatic save in milliseconds.
+	static constexpr int AUTOSAVE_INTERVAL = 5 * 60 * 1000;
+	/// Timer triggering the automatic save.
+	QTimer* autosaveTimer_;
 	/// Radius of the boxes.
     int borderRadius_;
 	/// Clear all UI elements.
 	void clearUi();
+	/// Ids of the persons on the last found connection.
+	std::unordered_set<size_t> connection_;
     /// Connect all slots to their signals.
 	void connectAllSlots();
 	/// Edit event by its id.
@@ -298,6 +322,9 @@ private:
 	/// @param scale That is set for this picture.
 	/// @return If the export was successful or not.
 	bool exportGeneralDiagram(const QString& filename, QGraphicsScene* gscene, double scale = 1);
+	/// Wait for the background save and tell the user if it failed.
+	/// @return False if the save failed.
+	bool finishSaving();
 	/// Used font for view.
     QFont font_;
 	/// Family tree.
@@ -328,7 +355,7 @@ private:
     /// @param gap Gap which is between boxes in cell.
     /// @param movex Whether to move boxes on the x line.
     /// @param movey Whether to move boxes on the y line.
-	void drawCloseContainer(const std::vector<Relation*>& container,
+	void drawCloseContainer(const std::vector<Kinship>& container,
                                     qreal sizeX, qreal sizeY, qreal topLeftX, qreal topLeftY,
                                     qreal lineX1, qreal lineY1, qreal lineX2, qreal lineY2,
                                     size_t partner, size_t mother, size_t father, int gap,
@@ -375,12 +402,12 @@ private:
     /// @param horizontalGap Min gap between boxes in the x axis.
     /// @param verticalGap Gap between generations.
 	/// @param barrier How more generations to show.
-	/// @param container Vector of relations to draw.
+	/// @param relatives Relatives to draw in the next generation.
 	/// @param up If we are drawing upwards or downwards.
 	/// @param numberFunc Function for computing the widths and depths of the trees.
 	/// @param drawFunc Function to recursively call for drawing.
     void drawGeneralGenerations(Person* p, qreal width, qreal midx, qreal midy, int horizontalGap, int verticalGap, size_t barrier,
-                                    const std::vector<size_t>& container, bool up,
+                                    std::span<const Kinship> relatives, bool up,
                                     std::function<std::pair<size_t, size_t>(Person*, size_t, size_t)> numberFunc,
                                     std::function<void(Person*, qreal, qreal, qreal, int, int, size_t)> drawFunc);
 	/// Draw one family tree box and recursively make other.<br>
@@ -399,6 +426,10 @@ private:
     /// @param verticalGap Gap between generations.
 	/// @param barrier How more generations to show.
 	void drawOlderGenerations(Person* p, qreal width, qreal midx, qreal midy, int horizontalGap, int verticalGap, size_t barrier);
+	/// Get the parents drawn in the family tree, which are the father and the mother only.
+	/// @param p Given person.
+	/// @return Father and mother if they are set.
+	std::vector<Kinship> drawnParents(Person* p);
 	/// Draw partner (to the left of the main person) to the family tree if there is one.
 	/// @param canvasMidX Centre-point of the canvas.
 	/// @param canvasMidY Centre-point of the canvas.
@@ -426,12 +457,11 @@ private:
     /// @param p Given person.
     /// @param soFar What is the depth so far.
     /// @param barrier How many more generations to show.
-    /// @param container Vector of relations in given direction.
-    /// @param up If the direction is up or not.
+    /// @param relatives Relatives in the next generation in given direction.
     /// @param func Which function to recursively call.
     /// @return First is what is the width and second is the depth of the tree.
 	std::pair<size_t, size_t> generalGenerationNumber(Person* p, size_t soFar, size_t barrier,
-                                                   const std::vector<size_t>& container, bool up,
+                                                   std::span<const Kinship> relatives,
                                                    std::function<std::pair<size_t, size_t>(Person*, size_t, size_t)> func);
     /// How many generations to show in tree view down.
     int genSizeDown_;
@@ -443,6 +473,9 @@ private:
     QPen linePen_;
 	/// Load the setting from configuration.
 	void loadSettings();
+	/// Highlight boxes of the persons on the last found connection.
+	/// @param gscene Scene with the boxes.
+	void markConnection(QGraphicsScene* gscene);
 	/// Get the number of upper generations for a person.
 	/// @param p Which person we are looking at.
 	/// @param soFar What is the number so far to the person p.
@@ -520,6 +553,12 @@ private:
 	int sizeX_;
 	/// Y size of the person box.
 	int sizeY_;
+	/// Maximum number of suggested relations on one page.
+	static constexpr size_t SUGGESTIONS_PAGE = 100;
+	/// Index of the next page of suggested relations.
+	size_t suggestionPage_;
+	/// Pages of relations inferred in the whole tree.
+	std::vector<std::vector<RelationSuggestion>> suggestionPages_;
 	/// Color for promoted father, mother and partner.
     QColor promotedColor_;
     /// Color for other relations.
@@ -532,6 +571,10 @@ private:
     GraphicsView* treeView;
 	/// Qt UI framework.
 	Ui::MainWindow* ui;
+	/// Validate references in the database, show the numbers of the found inconsistencies and repair them if the user wants to.
+	/// All the inconsistencies are written in the log.
+	/// @return True if an inconsistency was found.
+	bool validateDatabase();
 	/// Compute the maximum number of younger generations of the person.
 	/// @param p Given person.
 	/// @param soFar What is the depth so far.
@@ -57,11 +57,10 @@ void MainWindow::addNewPerson(){
             item->setIcon(0, QIcon(":/resources/other.svg"));
             break;
     }
-    item->setText(2, QString::fromStdString(p->getBirthDate().str()));
-    if(!p->isAlive()) item->setText(3, QString::fromStdString(p->getDeathDate().str()));
+    item->setDates(*p);
     refreshProjectView();
     filterProjectItems();
-    FT.setUnsaved();
+    FT.setUnsaved(DB_PERSONS, p->getId());
 }
 
 void MainWindow::addNewRelation(){
@@ -85,6 +84,13 @@ void MainWindow::allBelowGenerations(bool selected){
     drawFamilyTree();
 }
 
+void MainWindow::autosave(){
+    if(!FT.isDirectorySet() || FT.isSaving()) return;
+    savePersonsInfo();
+    if(FT.isSaved() || FT.getOrphanFiles().size() > 0) return;
+    FT.storeDatabaseAsync([this](){QMetaObject::invokeMethod(this, [this](){finishSaving();}, Qt::QueuedConnection);});
+}
+
 void MainWindow::changeGenerationsDown(int value){
     genSizeDown_ = value;
     FT.getSettings()->setAppSettings().genSizeDown = genSizeDown_;
@@ -97,6 +103,10 @@ void MainWindow::changeGenerationsUp(int value){
     drawFamilyTree();
 }
 
+void MainWindow::checkDatabase(){
+    if(!validateDatabase()) QMessageBox::information(this, "Information", QString::fromStdString(validation::CONSISTENT));
+}
+
 void MainWindow::checkStoreRefreshPersonsInfo(){
     if(FT.getMainPerson() == nullptr) return;
     bool forb = false;
@@ -217,12 +227,48 @@ void MainWindow::exportTreeDiagramDialog(){
 }
 
 void MainWindow::filterProjectItems(){
-    auto items = ui->projectView->findItems(ui->findEdit->text(), Qt::MatchContains, 1);
-    auto all_items = ui->projectView->findItems("", Qt::MatchContains);
-    for(int i = 0; i < ui->projectView->topLevelItemCount(); ++i)
-        ui->projectView->topLevelItem(i)->setHidden(true);
-    for(auto&& item : items)
-        item->setHidden(false);
+    std::string query = ui->findEdit->text().toStdString();
+    std::vector<size_t> found = FT.findPersons(query);
+    std::unordered_set<size_t> shown (found.begin(), found.end());
+    bool all = search::normalize(query).find_first_not_of(' ') == std::string::npos;
+    for(int i = 0; i < ui->projectView->topLevelItemCount(); ++i){
+        QTreeWidgetItem* item = ui->projectView->topLevelItem(i);
+        item->setHidden(!all && !shown.contains(item->data(0, Qt::DisplayRole).toULongLong()));
+    }
+}
+
+void MainWindow::findConnection(){
+    if(FT.getMainPerson() == nullptr) return;
+    ChoosePersonDialog* cpd = new ChoosePersonDialog(&FT, nullptr, this);
+    connect(cpd, SIGNAL(savePerson(Person*)), this, SLOT(showConnection(Person*)));
+    cpd->show();
+}
+
+void MainWindow::findDuplicates(){
+    std::vector<DuplicateCandidate> candidates = FT.findDuplicates();
+    if(candidates.empty()){
+        QMessageBox::information(this, "Information", QString::fromStdString(duplicates::NO_DUPLICATES));
+        return;
+    }
+    bool merged = false;
+    bool all = false;
+    for(const DuplicateCandidate& candidate : candidates){
+        auto optFirst = FT.getPerson(candidate.first);
+        auto optSecond = FT.getPerson(candidate.second);
+        // Persons merged into others on the way are skipped.
+        if(!optFirst || !optSecond) continue;
+        if(!all){
+            std::string question = duplicates::QUESTION + "\n" + (*optFirst)->str() + "\n" + (*optSecond)->str() + "\n"
+                + duplicates::SIMILARITY + std::to_string(static_cast<int>(candidate.score * 100)) + " %";
+            auto result = QMessageBox::question(this, "Duplicates", QString::fromStdString(question),
+                                                QMessageBox::Yes | QMessageBox::YesToAll | QMessageBox::No | QMessageBox::Cancel);
+            if(result == QMessageBox::Cancel) break;
+            if(result == QMessageBox::No) continue;
+            all = result == QMessageBox::YesToAll;
+        }
+        merged = FT.mergePersons(candidate.first, candidate.second) || merged;
+    }
+    if(merged) refreshUi();
 }
 
 void MainWindow::findPerson(){
@@ -241,6 +287,7 @@ void MainWindow::importProject(){
     if(!success){
         QMessageBox::critical(this, "Error", "Import was unsuccesful.");
     }
+    else validateDatabase();
     refreshUi();
     ui->projectView->clear();
     initializeProjectView();
@@ -257,6 +304,7 @@ void MainWindow::importRootDir(){
     if(!success){
         QMessageBox::critical(this, "Error", "Import was unsuccesful.");
     }
+    else validateDatabase();
     refreshUi();
     ui->projectView->clear();
     initializeProjectView();
@@ -378,7 +426,6 @@ void MainWindow::promoteRelation(){
     FT.promoteRelation(id);
     refreshRelationTab();
     refreshGraphics();
-    FT.setUnsaved();
 }
 
 void MainWindow::refreshDates(){
@@ -448,9 +495,7 @@ void MainWindow::refreshProjectView(){
                 item->setIcon(0, QIcon(":/resources/other.svg"));
                 break;
         }
-        item->setText(2, QString::fromStdString((*optPerson)->getBirthDate().str()));
-        if(!(*optPerson)->isAlive()) item->setText(3, QString::fromStdString((*optPerson)->getDeathDate().str()));
-        else item->setText(3, "");
+        item->setDates(**optPerson);
         for(int j = 0; j < item->childCount(); ++j){
             auto project_item = dynamic_cast<ProjectItem*>(item->child(j));
             if(project_item->text(1) == "Files")
@@ -538,7 +583,6 @@ void MainWindow::removeEvent(){
         FT.removeEvent(item->data(0, Qt::UserRole).toULongLong());
     refreshProjectView();
     refreshEventTab();
-    FT.setUnsaved();
 }
 
 void MainWindow::removeFileFolder(){
@@ -562,7 +606,6 @@ void MainWindow::removePerson(){
     result = QMessageBox::warning(this, "Warning", QString::fromStdString(ss.str()), QMessageBox::Yes | QMessageBox::No);
     if (result == QMessageBox::Yes) {
         FT.removePerson();
-        FT.setUnsaved();
         ui->infoTab->setEnabled(false);
         for(int i = 0; i < ui->projectView->topLevelItemCount(); ++i){
             QTreeWidgetItem* item = ui->projectView->topLevelItem(i);
@@ -591,7 +634,6 @@ void MainWindow::removeRelation(){
         refreshRelationTab();
         refreshProjectView();
         refreshGraphics();
-        FT.setUnsaved();
     }
 }
 
@@ -610,7 +652,7 @@ void MainWindow::removeTag(){
     if (result == QMessageBox::Yes) {
         FT.getMainPerson()->removeTag(item->text(0).toStdString());
         refreshTagsList();
-        FT.setUnsaved();
+        FT.setUnsaved(DB_PERSONS, FT.getMainPerson()->getId());
     }
 }
 
@@ -642,8 +684,10 @@ bool MainWindow::saveDatabase(){
         auto result = QMessageBox::warning(this, "Warning", QString::fromStdString(ss.str()), QMessageBox::Yes | QMessageBox::No);
         if (result == QMessageBox::No) return false;
 	}
-	bool success = FT.storeDatabase();
-	if(!success){
+	// Only one save can run at once.
+	finishSaving();
+	bool started = FT.storeDatabaseAsync([this](){QMetaObject::invokeMethod(this, [this](){finishSaving();}, Qt::QueuedConnection);});
+	if(!started){
         QString dirPath = QFileDialog::getExistingDirectory(this,tr("Choose root directory for your project"), QDir::currentPath());
         std::string dir = dirPath.toStdString();
         if(dir != ""){
@@ -695,7 +739,7 @@ void MainWindow::saveGraphicsSetting(QColor probandColor, QColor specialColor, Q
     FT.getSettings()->setAppSettings().lineColor.green = lineColor.green();
     FT.getSettings()->setAppSettings().lineWidth = lineWidth;
     FT.getSettings()->setAppSettings().radius = rounding;
-    FT.setUnsaved();
+    FT.setUnsaved(DB_CONFIG);
 }
 
 void MainWindow::selectOlderGenerationOnly(){
@@ -730,6 +774,11 @@ void MainWindow::setEventTabVisible(){
     FT.getSettings()->setAppSettings().showEventTab = ui->actionShow_Events->isChecked();
 }
 
+void MainWindow::setFileDeduplication(){
+    FT.getSettings()->setAppSettings().deduplicateFiles = ui->actionDeduplicate_files->isChecked();
+    FT.setUnsaved(DB_CONFIG);
+}
+
 void MainWindow::setFileTabVisible(){
      for(auto it = 0; it < ui->infoTab->count(); ++it){
         if(ui->infoTab->tabText(it) == "Files"){
@@ -821,6 +870,27 @@ void MainWindow::setTabWest(){
 	FT.getSettings()->setAppSettings().tabPosition = West;
 }
 
+void MainWindow::showConnection(Person* person){
+    Person* main = FT.getMainPerson();
+    if(main == nullptr || person == nullptr) return;
+    auto optPath = FT.findConnection(main->getId(), person->getId());
+    connection_.clear();
+    if(!optPath){
+        refreshGraphics();
+        QMessageBox::information(this, "Information", QString::fromStdString(relationship::NOT_CONNECTED));
+        return;
+    }
+    connection_.insert(main->getId());
+    std::string chain = main->str();
+    for(auto&& kinship : *optPath){
+        connection_.insert(kinship.person);
+        auto optRelative = FT.getPerson(kinship.person);
+        chain += relationship::ARROW + *kinship.name + ": " + (optRelative ? (*optRelative)->str() : std::to_string(kinship.person));
+    }
+    refreshGraphics();
+    QMessageBox::information(this, "Information", QString::fromStdString(chain));
+}
+
 void MainWindow::showHelp(){
     HelpDialog* td = new HelpDialog(&FT, this);
     td->show();
@@ -838,21 +908,46 @@ void MainWindow::showRenameNote(){
     enableGeneralFolderRenamePrompt(NOTE);
 }
 
+void MainWindow::showSuggestionPage(){
+    // Relations saved on the previous page are shown before the next one.
+    if(suggestionPage_ > 0) refreshUi();
+    if(suggestionPage_ >= suggestionPages_.size()){
+        suggestionPages_.clear();
+        return;
+    }
+    SuggestionsDialog* sd = new SuggestionsDialog(&FT, suggestionPages_[suggestionPage_], this);
+    ++suggestionPage_;
+    sd->setWindowTitle(QString::fromStdString(inference::PAGE + std::to_string(suggestionPage_) + inference::OF + std::to_string(suggestionPages_.size())));
+    connect(sd, SIGNAL(accepted()), this, SLOT(showSuggestionPage()));
+    sd->show();
+}
+
 void MainWindow::splitterChanged(){
     auto sizes = ui->splitter->sizes();
     FT.getSettings()->setAppSettings().splitterPositionOne = sizes[0];
     FT.getSettings()->setAppSettings().splitterPositionTwo = sizes[1];
-    FT.setUnsaved();
+    FT.setUnsaved(DB_CONFIG);
+}
+
+void MainWindow::suggestRelations(){
+    suggestionPages_ = FT.inferRelations(SUGGESTIONS_PAGE);
+    suggestionPage_ = 0;
+    if(suggestionPages_.empty()){
+        QMessageBox::information(this, "Information", QString::fromStdString(inference::NO_SUGGESTIONS));
+        return;
+    }
+    showSuggestionPage();
 }
 
 void MainWindow::switchNewTreeProject(){
+    finishSaving();
     if(!FT.isSaved()){
         QMessageBox::StandardButton result;
         std::stringstream ss;
         ss << "There are some changes that are not saved. Do you want to save them?";
         result = QMessageBox::warning(this, "Warning", QString::fromStdString(ss.str()), QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
         if (result == QMessageBox::Save){
-            bool saved = saveDatabase();
+            bool saved = saveDatabase() && finishSaving();
             if(!saved) return;
         }
         else if (result == QMessageBox::Cancel)